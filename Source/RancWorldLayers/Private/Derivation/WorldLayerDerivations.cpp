@@ -0,0 +1,66 @@
+#include "WorldLayerDerivations.h"
+
+const FName FWorldLayerBuiltInDerivations::DistanceField(TEXT("DistanceField"));
+const FName FWorldLayerBuiltInDerivations::NearestFeature(TEXT("NearestFeature"));
+const FName FWorldLayerImageOpDerivations::BoxBlur(TEXT("BoxBlur"));
+const FName FWorldLayerImageOpDerivations::GaussianBlur(TEXT("GaussianBlur"));
+const FName FWorldLayerImageOpDerivations::Dilate(TEXT("Dilate"));
+const FName FWorldLayerImageOpDerivations::Erode(TEXT("Erode"));
+const FName FWorldLayerImageOpDerivations::Threshold(TEXT("Threshold"));
+const FName FWorldLayerImageOpDerivations::RemapCurve(TEXT("RemapCurve"));
+const FName FWorldLayerImageOpDerivations::WeightedSum(TEXT("WeightedSum"));
+const FName FWorldLayerImageOpDerivations::Minimum(TEXT("Minimum"));
+const FName FWorldLayerImageOpDerivations::Maximum(TEXT("Maximum"));
+const FName FWorldLayerImageOpDerivations::GradientMagnitude(TEXT("GradientMagnitude"));
+const FName FWorldLayerImageOpDerivations::Dominant3(TEXT("Dominant3"));
+
+FWorldLayerDerivationOutput::FWorldLayerDerivationOutput(EDataFormat InDataFormat, const FIntRect& InRect, uint8* InData, int32 InStride)
+	: DataFormat(InDataFormat)
+	, Rect(InRect)
+	, BytesPerPixel(GetBytesPerPixel(InDataFormat))
+	, Stride(InStride)
+	, Data(InData)
+{
+}
+
+int32 FWorldLayerDerivationOutput::GetBytesPerPixel(EDataFormat DataFormat)
+{
+	switch (DataFormat)
+	{
+		case EDataFormat::R8:
+			return TWorldLayerFormatTraits<EDataFormat::R8>::BytesPerPixel;
+		case EDataFormat::R16F:
+			return TWorldLayerFormatTraits<EDataFormat::R16F>::BytesPerPixel;
+		case EDataFormat::RGBA8:
+			return TWorldLayerFormatTraits<EDataFormat::RGBA8>::BytesPerPixel;
+		case EDataFormat::RGBA16F:
+			return TWorldLayerFormatTraits<EDataFormat::RGBA16F>::BytesPerPixel;
+		default:
+			return 0; // Should not happen
+	}
+}
+
+FWorldLayerDerivationOutput FWorldLayerDerivationOutput::Slice(const FIntRect& SubRect) const
+{
+	check(SubRect.Min.X >= Rect.Min.X && SubRect.Min.Y >= Rect.Min.Y && SubRect.Max.X <= Rect.Max.X && SubRect.Max.Y <= Rect.Max.Y);
+	return FWorldLayerDerivationOutput(DataFormat, SubRect, GetPixel(SubRect.Min.X, SubRect.Min.Y), Stride);
+}
+
+void FWorldLayerDerivationOutput::SetValue(int32 X, int32 Y, const FLinearColor& Value) const
+{
+	switch (DataFormat)
+	{
+		case EDataFormat::R8:
+			Set<EDataFormat::R8>(X, Y, Value);
+			break;
+		case EDataFormat::R16F:
+			Set<EDataFormat::R16F>(X, Y, Value);
+			break;
+		case EDataFormat::RGBA8:
+			Set<EDataFormat::RGBA8>(X, Y, Value);
+			break;
+		case EDataFormat::RGBA16F:
+			Set<EDataFormat::RGBA16F>(X, Y, Value);
+			break;
+	}
+}
@@ -0,0 +1,163 @@
+#include "Derivation/WorldLayerDistanceField.h"
+#include "Async/ParallelFor.h"
+
+FWorldLayerDistanceField::FWorldLayerDistanceField(const FIntPoint& InResolution)
+	: Resolution(InResolution.ComponentMax(FIntPoint::ZeroValue))
+{
+	ColumnNearestRow.Init(INDEX_NONE, Resolution.X * Resolution.Y);
+	NearestFeature.Init(FIntPoint(INDEX_NONE, INDEX_NONE), Resolution.X * Resolution.Y);
+}
+
+FIntRect FWorldLayerDistanceField::Update(const FIntRect& DirtyRect, FColumnReader ReadColumn)
+{
+	const int32 Width = Resolution.X;
+	const int32 Height = Resolution.Y;
+	const int32 MinX = FMath::Max(DirtyRect.Min.X, 0);
+	const int32 MaxX = FMath::Min(DirtyRect.Max.X, Width);
+	if (MinX >= MaxX || Height <= 0)
+	{
+		return FIntRect();
+	}
+
+	// Column pass. A column depends on all of its cells, so touched columns are redone in full.
+	struct FColumnContext
+	{
+		TArray<uint8> IsFeature;
+		TArray<int32> Above;
+	};
+	TArray<FColumnContext> ColumnContexts;
+	TArray<FIntPoint> ChangedRowsPerColumn;
+	ChangedRowsPerColumn.Init(FIntPoint(MAX_int32, MIN_int32), MaxX - MinX);
+
+	ParallelForWithTaskContext(ColumnContexts, MaxX - MinX, [&](FColumnContext& Context, int32 ColumnOffset)
+	{
+		const int32 X = MinX + ColumnOffset;
+		Context.IsFeature.SetNumUninitialized(Height, EAllowShrinking::No);
+		Context.Above.SetNumUninitialized(Height, EAllowShrinking::No);
+		ReadColumn(X, Context.IsFeature);
+
+		// Sweep down for the nearest feature at or above each cell, then up for the nearest at or below
+		int32 Last = INDEX_NONE;
+		for (int32 Y = 0; Y < Height; ++Y)
+		{
+			Last = Context.IsFeature[Y] ? Y : Last;
+			Context.Above[Y] = Last;
+		}
+
+		int32* Column = ColumnNearestRow.GetData() + (int64)X * Height;
+		FIntPoint& ChangedRows = ChangedRowsPerColumn[ColumnOffset];
+		int32 Below = INDEX_NONE;
+		for (int32 Y = Height - 1; Y >= 0; --Y)
+		{
+			Below = Context.IsFeature[Y] ? Y : Below;
+			const int32 Above = Context.Above[Y];
+			const int32 Nearest = Above == INDEX_NONE ? Below : (Below == INDEX_NONE || Y - Above <= Below - Y ? Above : Below);
+			if (Column[Y] != Nearest)
+			{
+				Column[Y] = Nearest;
+				ChangedRows.X = FMath::Min(ChangedRows.X, Y);
+				ChangedRows.Y = FMath::Max(ChangedRows.Y, Y);
+			}
+		}
+	});
+
+	int32 MinRow = MAX_int32;
+	int32 MaxRow = MIN_int32;
+	for (const FIntPoint& ChangedRows : ChangedRowsPerColumn)
+	{
+		MinRow = FMath::Min(MinRow, ChangedRows.X);
+		MaxRow = FMath::Max(MaxRow, ChangedRows.Y);
+	}
+	if (MinRow > MaxRow)
+	{
+		return FIntRect();
+	}
+
+	// Row pass over the rows whose column results changed. Each column with a feature is a parabola
+	// (X - Q)^2 + DY(Q)^2; the lower envelope of those parabolas gives the nearest feature for every cell of the row.
+	struct FRowContext
+	{
+		TArray<int32> Sites;
+		TArray<double> Bounds;
+	};
+	TArray<FRowContext> RowContexts;
+	TArray<FIntPoint> ChangedColumnsPerRow;
+	ChangedColumnsPerRow.Init(FIntPoint(MAX_int32, MIN_int32), MaxRow - MinRow + 1);
+
+	ParallelForWithTaskContext(RowContexts, MaxRow - MinRow + 1, [&](FRowContext& Context, int32 RowOffset)
+	{
+		const int32 Y = MinRow + RowOffset;
+		Context.Sites.SetNumUninitialized(Width, EAllowShrinking::No);
+		Context.Bounds.SetNumUninitialized(Width + 1, EAllowShrinking::No);
+		int32* Sites = Context.Sites.GetData();
+		double* Bounds = Context.Bounds.GetData();
+
+		// Parabola height at X = 0 plus Q^2, which is what the envelope intersection needs
+		auto SiteCost = [this, Y, Height](int32 Q)
+		{
+			const int64 DY = (int64)Y - ColumnNearestRow[(int64)Q * Height + Y];
+			return (double)(DY * DY + (int64)Q * Q);
+		};
+
+		int32 NumSites = 0;
+		for (int32 Q = 0; Q < Width; ++Q)
+		{
+			if (ColumnNearestRow[(int64)Q * Height + Y] == INDEX_NONE)
+			{
+				continue;
+			}
+
+			const double Cost = SiteCost(Q);
+			double Start = -UE_DOUBLE_BIG_NUMBER;
+			while (NumSites > 0)
+			{
+				const int32 Previous = Sites[NumSites - 1];
+				Start = (Cost - SiteCost(Previous)) / (2.0 * (Q - Previous));
+				if (Start > Bounds[NumSites - 1])
+				{
+					break;
+				}
+				--NumSites;
+				Start = -UE_DOUBLE_BIG_NUMBER;
+			}
+			Sites[NumSites] = Q;
+			Bounds[NumSites] = Start;
+			++NumSites;
+		}
+
+		FIntPoint* Row = NearestFeature.GetData() + (int64)Y * Width;
+		FIntPoint& ChangedColumns = ChangedColumnsPerRow[RowOffset];
+		int32 Site = 0;
+		for (int32 X = 0; X < Width; ++X)
+		{
+			FIntPoint Nearest(INDEX_NONE, INDEX_NONE);
+			if (NumSites > 0)
+			{
+				while (Site + 1 < NumSites && Bounds[Site + 1] < X)
+				{
+					++Site;
+				}
+				Nearest = FIntPoint(Sites[Site], ColumnNearestRow[(int64)Sites[Site] * Height + Y]);
+			}
+
+			if (Row[X] != Nearest)
+			{
+				Row[X] = Nearest;
+				ChangedColumns.X = FMath::Min(ChangedColumns.X, X);
+				ChangedColumns.Y = FMath::Max(ChangedColumns.Y, X);
+			}
+		}
+	});
+
+	FIntRect Changed(MAX_int32, MAX_int32, MIN_int32, MIN_int32);
+	for (int32 RowOffset = 0; RowOffset < ChangedColumnsPerRow.Num(); ++RowOffset)
+	{
+		const FIntPoint& ChangedColumns = ChangedColumnsPerRow[RowOffset];
+		if (ChangedColumns.X <= ChangedColumns.Y)
+		{
+			Changed.Include(FIntPoint(ChangedColumns.X, MinRow + RowOffset));
+			Changed.Include(FIntPoint(ChangedColumns.Y, MinRow + RowOffset));
+		}
+	}
+	return Changed.Min.X <= Changed.Max.X ? FIntRect(Changed.Min, Changed.Max + FIntPoint(1, 1)) : FIntRect();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Exact Euclidean distance transform of a feature mask, with the nearest feature cell kept per cell.
+ * Uses the separable Felzenszwalb-Huttenlocher algorithm: a pass per column finds the nearest feature in the same
+ * column, then a pass per row takes the lower envelope of the parabolas those column results describe. Both passes
+ * run in parallel. The column results are kept, so an update only repeats the column pass for the columns that were
+ * touched, and the row pass only for the rows in which a column result changed.
+ */
+class FWorldLayerDistanceField
+{
+public:
+	/** Fills OutIsFeature, one entry per row, with non-zero for every feature cell of column X. Called concurrently. */
+	using FColumnReader = TFunctionRef<void(int32 X, TArrayView<uint8> OutIsFeature)>;
+
+	explicit FWorldLayerDistanceField(const FIntPoint& InResolution);
+
+	/**
+	 * Recomputes the field after features inside DirtyRect may have changed. The first update must cover every cell.
+	 * Returns the bounds of the cells whose nearest feature changed, or an empty rect if none did.
+	 */
+	FIntRect Update(const FIntRect& DirtyRect, FColumnReader ReadColumn);
+
+	/** Nearest feature cell of (X, Y), or (INDEX_NONE, INDEX_NONE) while there is no feature at all. */
+	FORCEINLINE const FIntPoint& GetNearestFeature(int32 X, int32 Y) const
+	{
+		return NearestFeature[Y * Resolution.X + X];
+	}
+
+	FIntPoint GetResolution() const { return Resolution; }
+
+private:
+	FIntPoint Resolution;
+
+	/** Column pass result: row of the nearest feature in the same column, or INDEX_NONE. Column-major. */
+	TArray<int32> ColumnNearestRow;
+
+	/** Row pass result, row-major. */
+	TArray<FIntPoint> NearestFeature;
+};
@@ -0,0 +1,602 @@
+#include "Derivation/WorldLayerImageOps.h"
+#include "WorldLayersSubsystem.h"
+
+namespace WorldLayerImageOps
+{
+	static constexpr int32 MaxRadius = 64;
+
+	static int32 GetNumChannels(EDataFormat Format)
+	{
+		return (Format == EDataFormat::RGBA8 || Format == EDataFormat::RGBA16F) ? 4 : 1;
+	}
+
+	static int32 GetRadius(const FWorldDataLayerImageOpSettings& Settings)
+	{
+		return FMath::Clamp(Settings.Radius, 0, MaxRadius);
+	}
+
+	/**
+	 * Decodes Count cells of row Y starting at X0 into planes ChannelStride floats apart. With bClampToEdge, coordinates
+	 * outside the layer read the nearest border cell; otherwise they read the layer's default value.
+	 * Cells inside the layer are decoded one tile run at a time, so the tile lookup happens once per run, not per cell.
+	 */
+	static void DecodeRow(const FWorldLayerSnapshot& Source, int32 Y, int32 X0, int32 Count, int32 NumChannels, float* Dst, int32 ChannelStride, bool bClampToEdge)
+	{
+		VisitWorldLayerAccessor(Source, [&](const auto& Accessor)
+		{
+			using FormatTraits = typename std::decay_t<decltype(Accessor)>::FormatTraits;
+			constexpr int32 TileSize = FWorldDataLayerTileStore::TileSize;
+			constexpr int32 TileMask = FWorldDataLayerTileStore::TileMask;
+
+			const FIntPoint Resolution = Accessor.GetResolution();
+			const int32 RowY = bClampToEdge ? FMath::Clamp(Y, 0, Resolution.Y - 1) : Y;
+			const bool bRowInside = (uint32)RowY < (uint32)Resolution.Y;
+
+			auto FillValue = [&](int32 Begin, int32 End, const FLinearColor& Value)
+			{
+				for (int32 Index = Begin; Index < End; ++Index)
+				{
+					Dst[Index] = Value.R;
+					if (NumChannels > 1)
+					{
+						Dst[ChannelStride + Index] = Value.G;
+						Dst[ChannelStride * 2 + Index] = Value.B;
+						Dst[ChannelStride * 3 + Index] = Value.A;
+					}
+				}
+			};
+
+			if (!bRowInside)
+			{
+				FillValue(0, Count, Accessor.GetDefaultValue());
+				return;
+			}
+
+			// Indices into Dst of the cells that lie inside the layer
+			const int32 SpanBegin = FMath::Clamp(-X0, 0, Count);
+			const int32 SpanEnd = FMath::Clamp(Resolution.X - X0, SpanBegin, Count);
+			if (bClampToEdge)
+			{
+				FillValue(0, SpanBegin, FormatTraits::Decode(Accessor.GetPixelUnchecked(0, RowY)));
+				FillValue(SpanEnd, Count, FormatTraits::Decode(Accessor.GetPixelUnchecked(Resolution.X - 1, RowY)));
+			}
+			else
+			{
+				FillValue(0, SpanBegin, Accessor.GetDefaultValue());
+				FillValue(SpanEnd, Count, Accessor.GetDefaultValue());
+			}
+
+			for (int32 Index = SpanBegin; Index < SpanEnd;)
+			{
+				const int32 X = X0 + Index;
+				const int32 RunEnd = FMath::Min(Index + TileSize - (X & TileMask), SpanEnd);
+				const uint8* Pixel = Accessor.GetPixelUnchecked(X, RowY);
+				if (NumChannels == 1)
+				{
+					for (; Index < RunEnd; ++Index, Pixel += FormatTraits::BytesPerPixel)
+					{
+						Dst[Index] = FormatTraits::DecodeR(Pixel);
+					}
+				}
+				else
+				{
+					for (; Index < RunEnd; ++Index, Pixel += FormatTraits::BytesPerPixel)
+					{
+						const FLinearColor Value = FormatTraits::Decode(Pixel);
+						Dst[Index] = Value.R;
+						Dst[ChannelStride + Index] = Value.G;
+						Dst[ChannelStride * 2 + Index] = Value.B;
+						Dst[ChannelStride * 3 + Index] = Value.A;
+					}
+				}
+			}
+		});
+	}
+
+	template<EDataFormat Format>
+	static void EncodeRowAs(const FWorldLayerDerivationOutput& Output, int32 Y, const float* Src, int32 ChannelStride)
+	{
+		constexpr bool bSingleChannel = TWorldLayerFormatTraits<Format>::NumChannels == 1;
+		const FIntRect& Rect = Output.GetRect();
+		for (int32 Index = 0; Index < Rect.Width(); ++Index)
+		{
+			const FLinearColor Value = bSingleChannel
+				? FLinearColor(Src[Index], 0.0f, 0.0f, 0.0f)
+				: FLinearColor(Src[Index], Src[ChannelStride + Index], Src[ChannelStride * 2 + Index], Src[ChannelStride * 3 + Index]);
+			Output.Set<Format>(Rect.Min.X + Index, Y, Value);
+		}
+	}
+
+	/** Encodes one row of the output rect from planes ChannelStride floats apart. */
+	static void EncodeRow(const FWorldLayerDerivationOutput& Output, int32 Y, const float* Src, int32 ChannelStride)
+	{
+		switch (Output.GetDataFormat())
+		{
+			case EDataFormat::R8:
+				EncodeRowAs<EDataFormat::R8>(Output, Y, Src, ChannelStride);
+				break;
+			case EDataFormat::R16F:
+				EncodeRowAs<EDataFormat::R16F>(Output, Y, Src, ChannelStride);
+				break;
+			case EDataFormat::RGBA8:
+				EncodeRowAs<EDataFormat::RGBA8>(Output, Y, Src, ChannelStride);
+				break;
+			case EDataFormat::RGBA16F:
+				EncodeRowAs<EDataFormat::RGBA16F>(Output, Y, Src, ChannelStride);
+				break;
+		}
+	}
+
+	// Row primitives. Each handles four floats per vector instruction and finishes the remainder one by one.
+
+	/** Out = In * Weight */
+	static void ScaleRow(const float* In, float Weight, float* Out, int32 Count)
+	{
+		const VectorRegister4Float WeightV = VectorSetFloat1(Weight);
+		int32 Index = 0;
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			VectorStore(VectorMultiply(VectorLoad(In + Index), WeightV), Out + Index);
+		}
+		for (; Index < Count; ++Index)
+		{
+			Out[Index] = In[Index] * Weight;
+		}
+	}
+
+	/** Out += In * Weight */
+	static void AddScaledRow(const float* In, float Weight, float* Out, int32 Count)
+	{
+		const VectorRegister4Float WeightV = VectorSetFloat1(Weight);
+		int32 Index = 0;
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			VectorStore(VectorMultiplyAdd(VectorLoad(In + Index), WeightV, VectorLoad(Out + Index)), Out + Index);
+		}
+		for (; Index < Count; ++Index)
+		{
+			Out[Index] += In[Index] * Weight;
+		}
+	}
+
+	/** Out = max(Out, In), or min with bMax false */
+	template<bool bMax>
+	static void ExtremeRow(const float* In, float* Out, int32 Count)
+	{
+		int32 Index = 0;
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			const VectorRegister4Float A = VectorLoad(Out + Index);
+			const VectorRegister4Float B = VectorLoad(In + Index);
+			VectorStore(bMax ? VectorMax(A, B) : VectorMin(A, B), Out + Index);
+		}
+		for (; Index < Count; ++Index)
+		{
+			Out[Index] = bMax ? FMath::Max(Out[Index], In[Index]) : FMath::Min(Out[Index], In[Index]);
+		}
+	}
+
+	/**
+	 * Runs a separable window op with 2 * Radius + 1 taps over the first source. ApplyTap(In, Out, Count, Tap) folds one
+	 * tap into Out and must initialize Out for tap 0. It serves both passes: horizontally the taps are shifted views of
+	 * one decoded row, vertically they are the rows of the horizontal result.
+	 */
+	template<typename TapFuncType>
+	static void RunSeparable(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output, int32 Radius, TapFuncType&& ApplyTap)
+	{
+		const FIntRect& Rect = Output.GetRect();
+		const int32 Width = Rect.Width();
+		const int32 Taps = Radius * 2 + 1;
+		const int32 NumChannels = GetNumChannels(Output.GetDataFormat());
+		const int32 NumRows = Rect.Height() + Radius * 2;
+		const int32 SourceWidth = Width + Radius * 2;
+
+		// Horizontal pass over every row the vertical pass reads; row R holds NumChannels planes of Width floats
+		TArray<float> Horizontal;
+		Horizontal.SetNumUninitialized(NumRows * NumChannels * Width);
+		TArray<float> SourceRow;
+		SourceRow.SetNumUninitialized(NumChannels * SourceWidth);
+		for (int32 Row = 0; Row < NumRows; ++Row)
+		{
+			DecodeRow(*Inputs.Sources[0], Rect.Min.Y - Radius + Row, Rect.Min.X - Radius, SourceWidth, NumChannels, SourceRow.GetData(), SourceWidth, true);
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				const float* In = SourceRow.GetData() + Channel * SourceWidth;
+				float* Out = Horizontal.GetData() + (Row * NumChannels + Channel) * Width;
+				for (int32 Tap = 0; Tap < Taps; ++Tap)
+				{
+					ApplyTap(In + Tap, Out, Width, Tap);
+				}
+			}
+		}
+
+		TArray<float> Result;
+		Result.SetNumUninitialized(NumChannels * Width);
+		for (int32 Y = 0; Y < Rect.Height(); ++Y)
+		{
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				float* Out = Result.GetData() + Channel * Width;
+				for (int32 Tap = 0; Tap < Taps; ++Tap)
+				{
+					ApplyTap(Horizontal.GetData() + ((Y + Tap) * NumChannels + Channel) * Width, Out, Width, Tap);
+				}
+			}
+			EncodeRow(Output, Rect.Min.Y + Y, Result.GetData(), Width);
+		}
+	}
+
+	/**
+	 * Box filter over the first source with a sliding window: each pass keeps a running sum, adds the cell entering the
+	 * window and subtracts the one leaving it, so the cost per cell does not depend on Radius.
+	 */
+	static void RunBoxFilter(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output, int32 Radius)
+	{
+		const FIntRect& Rect = Output.GetRect();
+		const int32 Width = Rect.Width();
+		const int32 Taps = Radius * 2 + 1;
+		const float InvTaps = 1.0f / Taps;
+		const int32 NumChannels = GetNumChannels(Output.GetDataFormat());
+		const int32 NumRows = Rect.Height() + Radius * 2;
+		const int32 SourceWidth = Width + Radius * 2;
+
+		// Horizontal window sums of every row the vertical pass reads, laid out as in RunSeparable
+		TArray<float> Horizontal;
+		Horizontal.SetNumUninitialized(NumRows * NumChannels * Width);
+		TArray<float> SourceRow;
+		SourceRow.SetNumUninitialized(NumChannels * SourceWidth);
+		for (int32 Row = 0; Row < NumRows; ++Row)
+		{
+			DecodeRow(*Inputs.Sources[0], Rect.Min.Y - Radius + Row, Rect.Min.X - Radius, SourceWidth, NumChannels, SourceRow.GetData(), SourceWidth, true);
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				const float* In = SourceRow.GetData() + Channel * SourceWidth;
+				float* Out = Horizontal.GetData() + (Row * NumChannels + Channel) * Width;
+				float Sum = 0.0f;
+				for (int32 Tap = 0; Tap < Taps; ++Tap)
+				{
+					Sum += In[Tap];
+				}
+				Out[0] = Sum;
+				for (int32 Index = 1; Index < Width; ++Index)
+				{
+					Sum += In[Index + Taps - 1] - In[Index - 1];
+					Out[Index] = Sum;
+				}
+			}
+		}
+
+		// Vertical running sum over whole rows, normalized once on the way out
+		const int32 PlaneFloats = NumChannels * Width;
+		TArray<float> Sum;
+		Sum.SetNumZeroed(PlaneFloats);
+		for (int32 Tap = 0; Tap < Taps; ++Tap)
+		{
+			AddScaledRow(Horizontal.GetData() + Tap * PlaneFloats, 1.0f, Sum.GetData(), PlaneFloats);
+		}
+
+		TArray<float> Result;
+		Result.SetNumUninitialized(PlaneFloats);
+		for (int32 Y = 0; Y < Rect.Height(); ++Y)
+		{
+			if (Y > 0)
+			{
+				AddScaledRow(Horizontal.GetData() + (Y + Taps - 1) * PlaneFloats, 1.0f, Sum.GetData(), PlaneFloats);
+				AddScaledRow(Horizontal.GetData() + (Y - 1) * PlaneFloats, -1.0f, Sum.GetData(), PlaneFloats);
+			}
+			ScaleRow(Sum.GetData(), InvTaps, Result.GetData(), PlaneFloats);
+			EncodeRow(Output, Rect.Min.Y + Y, Result.GetData(), Width);
+		}
+	}
+
+	static void RunConvolution(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output, int32 Radius, const TArray<float>& Weights)
+	{
+		RunSeparable(Inputs, Output, Radius, [&Weights](const float* In, float* Out, int32 Count, int32 Tap)
+		{
+			if (Tap == 0)
+			{
+				ScaleRow(In, Weights[0], Out, Count);
+			}
+			else
+			{
+				AddScaledRow(In, Weights[Tap], Out, Count);
+			}
+		});
+	}
+
+	template<bool bMax>
+	static void RunMorphology(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+	{
+		RunSeparable(Inputs, Output, GetRadius(Inputs.ImageOp), [](const float* In, float* Out, int32 Count, int32 Tap)
+		{
+			if (Tap == 0)
+			{
+				FMemory::Memcpy(Out, In, Count * sizeof(float));
+			}
+			else
+			{
+				ExtremeRow<bMax>(In, Out, Count);
+			}
+		});
+	}
+
+	/** Decodes each row of the output rect from every source, at the same cells, and lets Combine fill the result planes. */
+	template<typename CombineFuncType>
+	static void RunPerRow(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output, CombineFuncType&& Combine)
+	{
+		const FIntRect& Rect = Output.GetRect();
+		const int32 Width = Rect.Width();
+		const int32 NumChannels = GetNumChannels(Output.GetDataFormat());
+		const int32 PlaneFloats = NumChannels * Width;
+
+		TArray<float> SourceRows;
+		SourceRows.SetNumUninitialized(Inputs.Sources.Num() * PlaneFloats);
+		TArray<float> Result;
+		Result.SetNumUninitialized(PlaneFloats);
+		for (int32 Y = Rect.Min.Y; Y < Rect.Max.Y; ++Y)
+		{
+			for (int32 SourceIndex = 0; SourceIndex < Inputs.Sources.Num(); ++SourceIndex)
+			{
+				DecodeRow(*Inputs.Sources[SourceIndex], Y, Rect.Min.X, Width, NumChannels, SourceRows.GetData() + SourceIndex * PlaneFloats, Width, false);
+			}
+			Combine(SourceRows.GetData(), PlaneFloats, Result.GetData(), PlaneFloats);
+			EncodeRow(Output, Y, Result.GetData(), Width);
+		}
+	}
+
+	template<bool bMax>
+	static void RunExtremeOfSources(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+	{
+		RunPerRow(Inputs, Output, [&Inputs](const float* Sources, int32 SourceStride, float* Out, int32 Count)
+		{
+			FMemory::Memcpy(Out, Sources, Count * sizeof(float));
+			for (int32 SourceIndex = 1; SourceIndex < Inputs.Sources.Num(); ++SourceIndex)
+			{
+				ExtremeRow<bMax>(Sources + SourceIndex * SourceStride, Out, Count);
+			}
+		});
+	}
+}
+
+using namespace WorldLayerImageOps;
+
+void FWorldLayerImageOps::RegisterAll(UWorldLayersSubsystem& Subsystem)
+{
+	const FWorldLayerDerivationHalo RadiusHalo = [](const UWorldDataLayerAsset& Config) { return GetRadius(Config.ImageOp); };
+
+	Subsystem.RegisterDerivationKernel(FWorldLayerImageOpDerivations::BoxBlur, &FWorldLayerImageOps::BoxBlur, RadiusHalo);
+	Subsystem.RegisterDerivationKernel(FWorldLayerImageOpDerivations::GaussianBlur, &FWorldLayerImageOps::GaussianBlur, RadiusHalo);
+	Subsystem.RegisterDerivationKernel(FWorldLayerImageOpDerivations::Dilate, &FWorldLayerImageOps::Dilate, RadiusHalo);
+	Subsystem.RegisterDerivationKernel(FWorldLayerImageOpDerivations::Erode, &FWorldLayerImageOps::Erode, RadiusHalo);
+	Subsystem.RegisterDerivationKernel(FWorldLayerImageOpDerivations::Threshold, &FWorldLayerImageOps::Threshold);
+	Subsystem.RegisterDerivationKernel(FWorldLayerImageOpDerivations::RemapCurve, &FWorldLayerImageOps::RemapCurve);
+	Subsystem.RegisterDerivationKernel(FWorldLayerImageOpDerivations::WeightedSum, &FWorldLayerImageOps::WeightedSum);
+	Subsystem.RegisterDerivationKernel(FWorldLayerImageOpDerivations::Minimum, &FWorldLayerImageOps::Minimum);
+	Subsystem.RegisterDerivationKernel(FWorldLayerImageOpDerivations::Maximum, &FWorldLayerImageOps::Maximum);
+	Subsystem.RegisterDerivationKernel(FWorldLayerImageOpDerivations::GradientMagnitude, &FWorldLayerImageOps::GradientMagnitude, 1);
+	Subsystem.RegisterDerivationKernel(FWorldLayerImageOpDerivations::Dominant3, &FWorldLayerImageOps::Dominant3);
+}
+
+TArray<float> FWorldLayerImageOps::MakeGaussianWeights(int32 Radius, float Sigma)
+{
+	const float EffectiveSigma = Sigma > 0.0f ? Sigma : FMath::Max(Radius * 0.5f, UE_KINDA_SMALL_NUMBER);
+	TArray<float> Weights;
+	Weights.SetNumUninitialized(Radius * 2 + 1);
+	float Sum = 0.0f;
+	for (int32 Tap = 0; Tap < Weights.Num(); ++Tap)
+	{
+		const float Offset = (float)(Tap - Radius);
+		Weights[Tap] = FMath::Exp(-Offset * Offset / (2.0f * EffectiveSigma * EffectiveSigma));
+		Sum += Weights[Tap];
+	}
+	for (float& Weight : Weights)
+	{
+		Weight /= Sum;
+	}
+	return Weights;
+}
+
+void FWorldLayerImageOps::BoxBlur(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+{
+	RunBoxFilter(Inputs, Output, GetRadius(Inputs.ImageOp));
+}
+
+void FWorldLayerImageOps::GaussianBlur(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+{
+	const int32 Radius = GetRadius(Inputs.ImageOp);
+	RunConvolution(Inputs, Output, Radius, MakeGaussianWeights(Radius, Inputs.ImageOp.Sigma));
+}
+
+void FWorldLayerImageOps::Dilate(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+{
+	RunMorphology<true>(Inputs, Output);
+}
+
+void FWorldLayerImageOps::Erode(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+{
+	RunMorphology<false>(Inputs, Output);
+}
+
+void FWorldLayerImageOps::Threshold(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+{
+	const VectorRegister4Float ThresholdV = VectorSetFloat1(Inputs.ImageOp.Threshold);
+	const float ThresholdValue = Inputs.ImageOp.Threshold;
+	RunPerRow(Inputs, Output, [&](const float* Sources, int32 SourceStride, float* Out, int32 Count)
+	{
+		int32 Index = 0;
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			const VectorRegister4Float Mask = VectorCompareGE(VectorLoad(Sources + Index), ThresholdV);
+			VectorStore(VectorSelect(Mask, VectorOneFloat(), VectorZeroFloat()), Out + Index);
+		}
+		for (; Index < Count; ++Index)
+		{
+			Out[Index] = Sources[Index] >= ThresholdValue ? 1.0f : 0.0f;
+		}
+	});
+}
+
+void FWorldLayerImageOps::RemapCurve(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+{
+	const TArray<float>& Table = Inputs.RemapTable;
+	const float InputMin = Inputs.ImageOp.RemapInputMin;
+	const float InputRange = Inputs.ImageOp.RemapInputMax - InputMin;
+	RunPerRow(Inputs, Output, [&](const float* Sources, int32 SourceStride, float* Out, int32 Count)
+	{
+		// Without a curve the source passes through unchanged
+		if (Table.Num() < 2 || FMath::IsNearlyZero(InputRange))
+		{
+			FMemory::Memcpy(Out, Sources, Count * sizeof(float));
+			return;
+		}
+
+		const float Scale = (Table.Num() - 1) / InputRange;
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const float Position = FMath::Clamp((Sources[Index] - InputMin) * Scale, 0.0f, (float)(Table.Num() - 1));
+			const int32 Lower = FMath::Min((int32)Position, Table.Num() - 2);
+			Out[Index] = FMath::Lerp(Table[Lower], Table[Lower + 1], Position - Lower);
+		}
+	});
+}
+
+void FWorldLayerImageOps::WeightedSum(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+{
+	const TArray<float>& Weights = Inputs.ImageOp.Weights;
+	RunPerRow(Inputs, Output, [&](const float* Sources, int32 SourceStride, float* Out, int32 Count)
+	{
+		FMemory::Memzero(Out, Count * sizeof(float));
+		for (int32 SourceIndex = 0; SourceIndex < Inputs.Sources.Num(); ++SourceIndex)
+		{
+			const float Weight = Weights.IsValidIndex(SourceIndex) ? Weights[SourceIndex] : 1.0f;
+			AddScaledRow(Sources + SourceIndex * SourceStride, Weight, Out, Count);
+		}
+	});
+}
+
+void FWorldLayerImageOps::Minimum(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+{
+	RunExtremeOfSources<false>(Inputs, Output);
+}
+
+void FWorldLayerImageOps::Maximum(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+{
+	RunExtremeOfSources<true>(Inputs, Output);
+}
+
+void FWorldLayerImageOps::GradientMagnitude(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+{
+	const FWorldLayerSnapshot& Source = *Inputs.Sources[0];
+	const FIntRect& Rect = Output.GetRect();
+	const int32 Width = Rect.Width();
+	const int32 NumChannels = GetNumChannels(Output.GetDataFormat());
+	const int32 SourceWidth = Width + 2;
+
+	// Central differences in value per world unit
+	const FVector2D CellSize = Source.GetPixelTransform().CellSize;
+	const VectorRegister4Float ScaleX = VectorSetFloat1(0.5f / (float)CellSize.X);
+	const VectorRegister4Float ScaleY = VectorSetFloat1(0.5f / (float)CellSize.Y);
+
+	// Three rolling rows: above, center and below the output row, each one cell wider on both sides
+	TArray<float> Rows;
+	Rows.SetNumUninitialized(3 * NumChannels * SourceWidth);
+	float* RowPtrs[3] = {Rows.GetData(), Rows.GetData() + NumChannels * SourceWidth, Rows.GetData() + 2 * NumChannels * SourceWidth};
+	DecodeRow(Source, Rect.Min.Y - 1, Rect.Min.X - 1, SourceWidth, NumChannels, RowPtrs[0], SourceWidth, true);
+	DecodeRow(Source, Rect.Min.Y, Rect.Min.X - 1, SourceWidth, NumChannels, RowPtrs[1], SourceWidth, true);
+
+	TArray<float> Result;
+	Result.SetNumUninitialized(NumChannels * Width);
+	for (int32 Y = Rect.Min.Y; Y < Rect.Max.Y; ++Y)
+	{
+		DecodeRow(Source, Y + 1, Rect.Min.X - 1, SourceWidth, NumChannels, RowPtrs[2], SourceWidth, true);
+		for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+		{
+			const float* Above = RowPtrs[0] + Channel * SourceWidth + 1;
+			const float* Center = RowPtrs[1] + Channel * SourceWidth;
+			const float* Below = RowPtrs[2] + Channel * SourceWidth + 1;
+			float* Out = Result.GetData() + Channel * Width;
+
+			int32 Index = 0;
+			for (; Index + 4 <= Width; Index += 4)
+			{
+				const VectorRegister4Float GX = VectorMultiply(VectorSubtract(VectorLoad(Center + Index + 2), VectorLoad(Center + Index)), ScaleX);
+				const VectorRegister4Float GY = VectorMultiply(VectorSubtract(VectorLoad(Below + Index), VectorLoad(Above + Index)), ScaleY);
+				VectorStore(VectorSqrt(VectorMultiplyAdd(GX, GX, VectorMultiply(GY, GY))), Out + Index);
+			}
+			for (; Index < Width; ++Index)
+			{
+				const float GX = (Center[Index + 2] - Center[Index]) * 0.5f / (float)CellSize.X;
+				const float GY = (Below[Index] - Above[Index]) * 0.5f / (float)CellSize.Y;
+				Out[Index] = FMath::Sqrt(GX * GX + GY * GY);
+			}
+		}
+		EncodeRow(Output, Y, Result.GetData(), Width);
+
+		// Roll the rows down by one
+		float* Oldest = RowPtrs[0];
+		RowPtrs[0] = RowPtrs[1];
+		RowPtrs[1] = RowPtrs[2];
+		RowPtrs[2] = Oldest;
+	}
+}
+
+void FWorldLayerImageOps::Dominant3(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+{
+	if (!ensureMsgf(Output.GetDataFormat() == EDataFormat::RGBA8, TEXT("Dominant3 layer %s must be RGBA8."), *Inputs.TargetLayerName.ToString()))
+	{
+		return;
+	}
+
+	const FIntRect& Rect = Output.GetRect();
+	const int32 Width = Rect.Width();
+	const int32 NumBiomes = FMath::Min(Inputs.Sources.Num(), 256);
+
+	// One plane of weights per biome
+	TArray<float> WeightRows;
+	WeightRows.SetNumUninitialized(NumBiomes * Width);
+	for (int32 Y = Rect.Min.Y; Y < Rect.Max.Y; ++Y)
+	{
+		for (int32 Biome = 0; Biome < NumBiomes; ++Biome)
+		{
+			DecodeRow(*Inputs.Sources[Biome], Y, Rect.Min.X, Width, 1, WeightRows.GetData() + Biome * Width, Width, false);
+		}
+
+		for (int32 Index = 0; Index < Width; ++Index)
+		{
+			// Three heaviest biomes, heaviest first; ties keep the lower ID first
+			uint8 Biomes[3] = {0, 0, 0};
+			float Weights[3] = {0.0f, 0.0f, 0.0f};
+			for (int32 Biome = 0; Biome < NumBiomes; ++Biome)
+			{
+				const float Weight = WeightRows[Biome * Width + Index];
+				if (Weight <= Weights[2])
+				{
+					continue;
+				}
+
+				int32 Slot = 2;
+				for (; Slot > 0 && Weight > Weights[Slot - 1]; --Slot)
+				{
+					Biomes[Slot] = Biomes[Slot - 1];
+					Weights[Slot] = Weights[Slot - 1];
+				}
+				Biomes[Slot] = (uint8)Biome;
+				Weights[Slot] = Weight;
+			}
+
+			const float Sum = Weights[0] + Weights[1] + Weights[2];
+			if (Sum > 0.0f)
+			{
+				Weights[0] /= Sum;
+				Weights[1] /= Sum;
+				Weights[2] /= Sum;
+			}
+			else
+			{
+				// No biome has weight: all of the first
+				Weights[0] = 1.0f;
+			}
+			FWorldLayerDominant3Codec::Encode(Biomes, Weights, Output.GetPixel(Rect.Min.X + Index, Y));
+		}
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldLayerDerivations.h"
+
+class UWorldLayersSubsystem;
+
+/**
+ * Kernels of the built-in image-processing derivations (see FWorldLayerBuiltInDerivations).
+ * Each kernel works row by row on planar float rows, one plane per channel of the output format: every source row is
+ * decoded once, the arithmetic runs four cells per vector instruction, and the result is encoded once. Windowed ops
+ * are separable and run as a horizontal then a vertical row pass. The subsystem runs the kernels per tile in parallel.
+ */
+struct FWorldLayerImageOps
+{
+	/** Registers every op with the subsystem under its FWorldLayerBuiltInDerivations name. */
+	static void RegisterAll(UWorldLayersSubsystem& Subsystem);
+
+	static void BoxBlur(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output);
+	static void GaussianBlur(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output);
+	static void Dilate(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output);
+	static void Erode(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output);
+	static void Threshold(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output);
+	static void RemapCurve(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output);
+	static void WeightedSum(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output);
+	static void Minimum(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output);
+	static void Maximum(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output);
+	static void GradientMagnitude(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output);
+
+	/** Reads the first channel of up to 256 sources and writes raw RGBA8 cells through FWorldLayerDominant3Codec. */
+	static void Dominant3(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output);
+
+	/** Normalized weights of a Gaussian with 2 * Radius + 1 taps. Sigma <= 0 uses half the Radius. */
+	static TArray<float> MakeGaussianWeights(int32 Radius, float Sigma);
+};
@@ -0,0 +1,95 @@
+#include "Gpu/WorldLayerGpuReadback.h"
+#include "Engine/Texture.h"
+#include "RHIGPUReadback.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+#include <atomic>
+
+struct FWorldLayerGpuReadbackTransfer::FState
+{
+	FState()
+		: Readback(TEXT("WorldLayerReadback"))
+	{
+	}
+
+	FRHIGPUTextureReadback Readback;
+	FIntPoint Size = FIntPoint::ZeroValue;
+	int32 BytesPerTexel = 0;
+
+	/** Written on the render thread before Status turns Ready, read on the game thread after. */
+	FWorldLayerReadbackTexels Texels;
+	std::atomic<EWorldLayerReadbackPoll> Status{EWorldLayerReadbackPoll::Pending};
+	std::atomic<bool> bPollQueued{false};
+};
+
+FWorldLayerGpuReadbackTransfer::FWorldLayerGpuReadbackTransfer(const TSharedRef<FState, ESPMode::ThreadSafe>& InState)
+	: State(InState)
+{
+}
+
+TUniquePtr<IWorldLayerReadbackTransfer> FWorldLayerGpuReadbackTransfer::Create(UTexture* Texture, EDataFormat DataFormat, const FIntRect& Rect, int32 Slice)
+{
+	FTextureResource* TextureResource = Texture ? Texture->GetResource() : nullptr;
+	if (!TextureResource || Rect.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	TSharedRef<FState, ESPMode::ThreadSafe> State = MakeShared<FState, ESPMode::ThreadSafe>();
+	State->Size = Rect.Size();
+	State->BytesPerTexel = FWorldLayerGpuFormat::GetBytesPerTexel(DataFormat);
+
+	ENQUEUE_RENDER_COMMAND(EnqueueWorldLayerReadback)(
+	[State, TextureResource, Rect, Slice](FRHICommandListImmediate& RHICmdList)
+	{
+		FRHITexture* TextureRHI = TextureResource->GetTextureRHI();
+		if (!TextureRHI)
+		{
+			State->Status = EWorldLayerReadbackPoll::Failed;
+			return;
+		}
+		State->Readback.EnqueueCopy(RHICmdList, TextureRHI, FIntVector(Rect.Min.X, Rect.Min.Y, 0), Slice, FIntVector(Rect.Width(), Rect.Height(), 1));
+	});
+
+	return TUniquePtr<IWorldLayerReadbackTransfer>(new FWorldLayerGpuReadbackTransfer(State));
+}
+
+EWorldLayerReadbackPoll FWorldLayerGpuReadbackTransfer::Poll(FWorldLayerReadbackTexels& OutTexels)
+{
+	const EWorldLayerReadbackPoll Status = State->Status;
+	if (Status == EWorldLayerReadbackPoll::Ready)
+	{
+		OutTexels = MoveTemp(State->Texels);
+		return Status;
+	}
+	if (Status == EWorldLayerReadbackPoll::Failed || State->bPollQueued.exchange(true))
+	{
+		return Status;
+	}
+
+	// The fence and the staging memory belong to the render thread
+	ENQUEUE_RENDER_COMMAND(PollWorldLayerReadback)(
+	[State = State](FRHICommandListImmediate& RHICmdList)
+	{
+		if (State->Status == EWorldLayerReadbackPoll::Pending && State->Readback.IsReady())
+		{
+			int32 RowPitchInPixels = 0;
+			const uint8* Locked = static_cast<const uint8*>(State->Readback.Lock(RowPitchInPixels));
+			if (Locked)
+			{
+				// Rows are copied tightly; staging rows may be padded and the last one may end early
+				const int64 RowBytes = (int64)State->Size.X * State->BytesPerTexel;
+				State->Texels.RowPitch = RowBytes;
+				State->Texels.Data.SetNumUninitialized(RowBytes * State->Size.Y);
+				for (int32 Y = 0; Y < State->Size.Y; ++Y)
+				{
+					FMemory::Memcpy(State->Texels.Data.GetData() + Y * RowBytes, Locked + (int64)Y * RowPitchInPixels * State->BytesPerTexel, RowBytes);
+				}
+				State->Readback.Unlock();
+			}
+			State->Status = Locked ? EWorldLayerReadbackPoll::Ready : EWorldLayerReadbackPoll::Failed;
+		}
+		State->bPollQueued = false;
+	});
+	return EWorldLayerReadbackPoll::Pending;
+}
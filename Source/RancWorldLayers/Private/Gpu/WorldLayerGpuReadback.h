@@ -0,0 +1,28 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldLayerReadback.h"
+
+class UTexture;
+
+/**
+ * Readback through FRHIGPUTextureReadback. The copy is enqueued on the render thread and each Poll queues at most one
+ * render command that checks the fence and, once the copy has landed, copies the rows out of the staging memory.
+ * Neither thread ever waits for the GPU.
+ */
+class FWorldLayerGpuReadbackTransfer : public IWorldLayerReadbackTransfer
+{
+public:
+	/** Reads Rect of one slice of the texture, which is 0 unless it is a texture array. Returns null if the texture has no render resource. */
+	static TUniquePtr<IWorldLayerReadbackTransfer> Create(UTexture* Texture, EDataFormat DataFormat, const FIntRect& Rect, int32 Slice = 0);
+
+	virtual EWorldLayerReadbackPoll Poll(FWorldLayerReadbackTexels& OutTexels) override;
+
+private:
+	struct FState;
+
+	explicit FWorldLayerGpuReadbackTransfer(const TSharedRef<FState, ESPMode::ThreadSafe>& InState);
+
+	/** Shared with the render commands, which may outlive the transfer. */
+	TSharedRef<FState, ESPMode::ThreadSafe> State;
+};
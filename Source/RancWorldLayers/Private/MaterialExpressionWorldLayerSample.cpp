@@ -4,6 +4,8 @@
 #include "WorldDataLayerAsset.h"
 #include "Materials/MaterialParameterCollection.h"
 #include "Engine/Texture2D.h"
+#include "Engine/Texture2DArray.h"
+#include "Engine/TextureRenderTarget2D.h"
 #include "WorldDataVolume.h"
 
 #define LOCTEXT_NAMESPACE "MaterialExpressionWorldLayerSample"
@@ -24,7 +26,27 @@ UMaterialExpressionWorldLayerSample::UMaterialExpressionWorldLayerSample(const F
 int32 UMaterialExpressionWorldLayerSample::Compile(class FMaterialCompiler* Compiler, int32 OutputIndex)
 {
 	FName TargetName = LayerAsset ? LayerAsset->LayerName : LayerName;
-	ParameterName = FName(*FString::Printf(TEXT("WL_Texture_%s"), *TargetName.ToString()));
+	UWorldLayersSubsystem* Subsystem = UWorldLayersSubsystem::Get(this);
+
+	// Layers packed into a texture array sample their slice of the shared texture. The registered layout wins over the asset's.
+	FName TextureArrayName = NAME_None;
+	int32 Slice = 0;
+	if (Subsystem && Subsystem->GetLayerGpuTexture(TargetName))
+	{
+		Subsystem->GetLayerTextureArraySlice(TargetName, TextureArrayName, Slice);
+	}
+	else
+	{
+		const FWorldDataLayerGPUConfiguration* GPUConfiguration = LayerAsset ? &LayerAsset->GPUConfiguration : nullptr;
+		if (GPUConfiguration && GPUConfiguration->bKeepUpdatedOnGPU && !GPUConfiguration->bIsGPUWritable)
+		{
+			TextureArrayName = GPUConfiguration->TextureArrayName;
+		}
+	}
+	const bool bTextureArray = !TextureArrayName.IsNone();
+	ParameterName = bTextureArray
+		? FName(*FString::Printf(TEXT("WL_TextureArray_%s"), *TextureArrayName.ToString()))
+		: FName(*FString::Printf(TEXT("WL_Texture_%s"), *TargetName.ToString()));
 
 	int32 PosIndex = WorldPosition.GetTracedInput().Expression ? WorldPosition.Compile(Compiler) : Compiler->WorldPosition(WPT_Default);
 	int32 PosXY = Compiler->ComponentMask(PosIndex, true, true, false, false);
@@ -83,10 +105,18 @@ int32 UMaterialExpressionWorldLayerSample::Compile(class FMaterialCompiler* Comp
 	int32 UV = Compiler->Div(Compiler->Sub(PosXY, OriginXY), SizeXY);
 
 	UTexture* ResolveTex = nullptr;
-	UWorldLayersSubsystem* Subsystem = UWorldLayersSubsystem::Get(this);
 	if (Subsystem) ResolveTex = Subsystem->GetLayerGpuTexture(TargetName);
-	if (!ResolveTex && LayerAsset) ResolveTex = LayerAsset->InitialDataTexture.LoadSynchronous();
-	if (!ResolveTex) ResolveTex = LoadObject<UTexture2D>(nullptr, TEXT("/Engine/EngineResources/WhiteSquareTexture.WhiteSquareTexture"));
+	if (ResolveTex && ResolveTex->IsA<UTexture2DArray>() != bTextureArray) ResolveTex = nullptr;
+	if (bTextureArray)
+	{
+		if (!ResolveTex) ResolveTex = LoadObject<UTexture2DArray>(nullptr, TEXT("/Engine/EngineResources/DefaultTexture2DArray.DefaultTexture2DArray"));
+		if (!ResolveTex) ResolveTex = UTexture2DArray::CreateTransient(1, 1, 1);
+	}
+	else
+	{
+		if (!ResolveTex && LayerAsset) ResolveTex = LayerAsset->InitialDataTexture.LoadSynchronous();
+		if (!ResolveTex) ResolveTex = LoadObject<UTexture2D>(nullptr, TEXT("/Engine/EngineResources/WhiteSquareTexture.WhiteSquareTexture"));
+	}
 
 	Texture = ResolveTex;
 
@@ -100,7 +130,15 @@ int32 UMaterialExpressionWorldLayerSample::Compile(class FMaterialCompiler* Comp
 	// 6 is the calculated UV
 	if (OutputIndex == 6) return UV;
 
-	return Compiler->TextureSample(TextureCode, UV, SamplerType, INDEX_NONE, INDEX_NONE, TMVM_None, SSM_FromTextureAsset, TGM_None, TextureReferenceIndex);
+	// The slice is a parameter so material instances can follow a layout that changed since the material compiled
+	int32 Coordinates = UV;
+	if (bTextureArray)
+	{
+		const int32 SliceCode = Compiler->ScalarParameter(FName(*FString::Printf(TEXT("WL_Slice_%s"), *TargetName.ToString())), (float)Slice);
+		Coordinates = Compiler->AppendVector(UV, SliceCode);
+	}
+
+	return Compiler->TextureSample(TextureCode, Coordinates, SamplerType, INDEX_NONE, INDEX_NONE, TMVM_None, SSM_FromTextureAsset, TGM_None, TextureReferenceIndex);
 }
 
 void UMaterialExpressionWorldLayerSample::GetCaption(TArray<FString>& OutCaptions) const
@@ -140,6 +178,27 @@ TArrayView<FExpressionInput*> UMaterialExpressionWorldLayerSample::GetInputsView
 	return CachedInputs;
 }
 
+bool UMaterialExpressionWorldLayerSample::TextureIsValid(UTexture* InTexture, FString& OutMessage)
+{
+	// Unpacked layers bind a Texture2D, or a render target when GPU-writable; packed layers the Texture2DArray they share
+	if (!InTexture)
+	{
+		OutMessage = TEXT("Found NULL, requires Texture2D, TextureRenderTarget2D or Texture2DArray");
+		return false;
+	}
+	if (!InTexture->IsA<UTexture2D>() && !InTexture->IsA<UTextureRenderTarget2D>() && !InTexture->IsA<UTexture2DArray>())
+	{
+		OutMessage = FString::Printf(TEXT("Found %s, requires Texture2D, TextureRenderTarget2D or Texture2DArray"), *InTexture->GetClass()->GetName());
+		return false;
+	}
+	return true;
+}
+
+void UMaterialExpressionWorldLayerSample::SetDefaultTexture()
+{
+	Texture = LoadObject<UTexture2D>(nullptr, TEXT("/Engine/EngineResources/WhiteSquareTexture.WhiteSquareTexture"));
+}
+
 #define IF_INPUT_RETURN_TYPE(Type) if(!InputIndex) return Type; --InputIndex
 EMaterialValueType UMaterialExpressionWorldLayerSample::GetInputValueType(int32 InputIndex)
 {
@@ -0,0 +1,410 @@
+#include "Spatial/OccupancyPyramid.h"
+
+FOccupancyPyramid::FOccupancyPyramid(const FIntPoint& InResolution)
+	: Resolution(InResolution.ComponentMax(FIntPoint(1, 1)))
+{
+	// Level 0 covers the cells; each level above has one bit per word below. Level 1 always exists, as it owns the pages.
+	FIntPoint NumBits = Resolution;
+	do
+	{
+		FLevel& Level = Levels.AddDefaulted_GetRef();
+		Level.NumWords = FIntPoint(FMath::DivideAndRoundUp(NumBits.X, WordSize), FMath::DivideAndRoundUp(NumBits.Y, WordSize));
+		if (Levels.Num() > 1)
+		{
+			Level.Words.SetNumZeroed(Level.NumWords.X * Level.NumWords.Y);
+		}
+		NumBits = Level.NumWords;
+	}
+	while (Levels.Num() < 2 || NumBits.X > 1 || NumBits.Y > 1);
+	check(Levels.Num() <= MaxLevels);
+
+	PageOffsets.Init(INDEX_NONE, Levels[1].NumWords.X * Levels[1].NumWords.Y);
+}
+
+uint64 FOccupancyPyramid::GetWord(int32 Level, int32 WordX, int32 WordY) const
+{
+	if (Level > 0)
+	{
+		const FLevel& LevelData = Levels[Level];
+		return LevelData.Words[WordY * LevelData.NumWords.X + WordX];
+	}
+
+	const int32 PageOffset = PageOffsets[GetPageIndex(WordX, WordY)];
+	return PageOffset == INDEX_NONE ? 0 : PagePool[PageOffset + ((WordY & WordMask) << WordLog2) + (WordX & WordMask)];
+}
+
+uint64& FOccupancyPyramid::GetMutableLevel0Word(int32 X, int32 Y)
+{
+	const int32 WordX = X >> WordLog2;
+	const int32 WordY = Y >> WordLog2;
+	int32& PageOffset = PageOffsets[GetPageIndex(WordX, WordY)];
+	if (PageOffset == INDEX_NONE)
+	{
+		if (FreePageOffsets.Num() > 0)
+		{
+			PageOffset = FreePageOffsets.Pop(EAllowShrinking::No);
+			FMemory::Memzero(PagePool.GetData() + PageOffset, WordsPerPage * sizeof(uint64));
+		}
+		else
+		{
+			PageOffset = PagePool.AddZeroed(WordsPerPage);
+		}
+	}
+	return PagePool[PageOffset + ((WordY & WordMask) << WordLog2) + (WordX & WordMask)];
+}
+
+void FOccupancyPyramid::ReleasePage(int32 PageIndex)
+{
+	FreePageOffsets.Add(PageOffsets[PageIndex]);
+	PageOffsets[PageIndex] = INDEX_NONE;
+}
+
+bool FOccupancyPyramid::Contains(const FIntPoint& Point) const
+{
+	return IsValidPoint(Point) && (GetWord(0, Point.X >> WordLog2, Point.Y >> WordLog2) & BitFor(Point.X, Point.Y)) != 0;
+}
+
+void FOccupancyPyramid::Insert(const FIntPoint& Point)
+{
+	if (!IsValidPoint(Point))
+	{
+		return;
+	}
+
+	uint64& Word = GetMutableLevel0Word(Point.X, Point.Y);
+	const uint64 Bit = BitFor(Point.X, Point.Y);
+	if (Word & Bit)
+	{
+		return;
+	}
+
+	const bool bWasEmpty = Word == 0;
+	Word |= Bit;
+	++NumPoints;
+	if (bWasEmpty)
+	{
+		PropagateSet(1, Point.X >> WordLog2, Point.Y >> WordLog2);
+	}
+}
+
+bool FOccupancyPyramid::Remove(const FIntPoint& Point)
+{
+	if (!Contains(Point))
+	{
+		return false;
+	}
+
+	uint64& Word = GetMutableLevel0Word(Point.X, Point.Y);
+	Word &= ~BitFor(Point.X, Point.Y);
+	--NumPoints;
+	if (Word == 0)
+	{
+		PropagateClear(1, Point.X >> WordLog2, Point.Y >> WordLog2);
+	}
+	return true;
+}
+
+void FOccupancyPyramid::PropagateSet(int32 Level, int32 X, int32 Y)
+{
+	for (; Level < Levels.Num(); ++Level)
+	{
+		FLevel& LevelData = Levels[Level];
+		uint64& Word = LevelData.Words[(Y >> WordLog2) * LevelData.NumWords.X + (X >> WordLog2)];
+		const bool bWasEmpty = Word == 0;
+		Word |= BitFor(X, Y);
+		if (!bWasEmpty)
+		{
+			return;
+		}
+		X >>= WordLog2;
+		Y >>= WordLog2;
+	}
+}
+
+void FOccupancyPyramid::PropagateClear(int32 Level, int32 X, int32 Y)
+{
+	for (; Level < Levels.Num(); ++Level)
+	{
+		FLevel& LevelData = Levels[Level];
+		const int32 WordIndex = (Y >> WordLog2) * LevelData.NumWords.X + (X >> WordLog2);
+		uint64& Word = LevelData.Words[WordIndex];
+		Word &= ~BitFor(X, Y);
+		if (Word != 0)
+		{
+			return;
+		}
+
+		// A level 1 word covers exactly one page, so an empty level 1 word means an empty page
+		if (Level == 1)
+		{
+			ReleasePage(WordIndex);
+		}
+		X >>= WordLog2;
+		Y >>= WordLog2;
+	}
+}
+
+void FOccupancyPyramid::Build(TConstArrayView<FIntPoint> Points)
+{
+	PageOffsets.Init(INDEX_NONE, PageOffsets.Num());
+	PagePool.Reset();
+	FreePageOffsets.Reset();
+	NumPoints = 0;
+	for (int32 Level = 1; Level < Levels.Num(); ++Level)
+	{
+		FMemory::Memzero(Levels[Level].Words.GetData(), Levels[Level].Words.Num() * sizeof(uint64));
+	}
+
+	for (const FIntPoint& Point : Points)
+	{
+		if (IsValidPoint(Point))
+		{
+			uint64& Word = GetMutableLevel0Word(Point.X, Point.Y);
+			const uint64 Bit = BitFor(Point.X, Point.Y);
+			NumPoints += (Word & Bit) ? 0 : 1;
+			Word |= Bit;
+		}
+	}
+
+	// OR-reduce bottom-up: each non-empty word sets its bit one level up
+	for (int32 Level = 1; Level < Levels.Num(); ++Level)
+	{
+		const FIntPoint Below = Levels[Level - 1].NumWords;
+		FLevel& LevelData = Levels[Level];
+		for (int32 WordY = 0; WordY < Below.Y; ++WordY)
+		{
+			for (int32 WordX = 0; WordX < Below.X; ++WordX)
+			{
+				if (GetWord(Level - 1, WordX, WordY) != 0)
+				{
+					LevelData.Words[(WordY >> WordLog2) * LevelData.NumWords.X + (WordX >> WordLog2)] |= BitFor(WordX, WordY);
+				}
+			}
+		}
+	}
+}
+
+double FOccupancyPyramid::DistSqToBlock(const FIntPoint& Point, int32 Level, int32 BlockX, int32 BlockY)
+{
+	// A bit at Level covers a square of 8^Level cells
+	const int32 Shift = Level * WordLog2;
+	const int64 MinX = (int64)BlockX << Shift;
+	const int64 MinY = (int64)BlockY << Shift;
+	const int64 MaxX = MinX + (1ll << Shift) - 1;
+	const int64 MaxY = MinY + (1ll << Shift) - 1;
+	const int64 DX = FMath::Clamp<int64>(Point.X, MinX, MaxX) - Point.X;
+	const int64 DY = FMath::Clamp<int64>(Point.Y, MinY, MaxY) - Point.Y;
+	return (double)(DX * DX + DY * DY);
+}
+
+double FOccupancyPyramid::MaxDistSqToBlock(const FIntPoint& Point, int32 Level, int32 BlockX, int32 BlockY)
+{
+	const int32 Shift = Level * WordLog2;
+	const int64 MinX = (int64)BlockX << Shift;
+	const int64 MinY = (int64)BlockY << Shift;
+	const int64 MaxX = MinX + (1ll << Shift) - 1;
+	const int64 MaxY = MinY + (1ll << Shift) - 1;
+	const int64 DX = FMath::Max(FMath::Abs(Point.X - MinX), FMath::Abs(MaxX - Point.X));
+	const int64 DY = FMath::Max(FMath::Abs(Point.Y - MinY), FMath::Abs(MaxY - Point.Y));
+	return (double)(DX * DX + DY * DY);
+}
+
+template<typename BoundFuncType, typename CellFuncType>
+void FOccupancyPyramid::VisitNearestFirst(const FIntPoint& SearchPoint, BoundFuncType&& GetBoundDistSq, CellFuncType&& VisitCell) const
+{
+	// Each entry is a set bit (block) at some level whose word one level down still has to be visited
+	struct FBlock
+	{
+		int32 Level;
+		int32 X;
+		int32 Y;
+		double DistSq;
+	};
+	FBlock Stack[MaxLevels * 64];
+	int32 StackSize = 0;
+
+	// The single top word is the child word of a virtual block one level above it
+	Stack[StackSize++] = {Levels.Num(), 0, 0, 0.0};
+
+	while (StackSize > 0)
+	{
+		const FBlock Block = Stack[--StackSize];
+		if (Block.DistSq >= GetBoundDistSq())
+		{
+			continue;
+		}
+
+		const int32 ChildLevel = Block.Level - 1;
+		uint64 Word = GetWord(ChildLevel, Block.X, Block.Y);
+
+		// Gather the set bits of the word with their distances, then push farthest first so the nearest pops first
+		FBlock Children[64];
+		int32 NumChildren = 0;
+		while (Word != 0)
+		{
+			const int32 Bit = FMath::CountTrailingZeros64(Word);
+			Word &= Word - 1;
+
+			const int32 ChildX = (Block.X << WordLog2) | (Bit & WordMask);
+			const int32 ChildY = (Block.Y << WordLog2) | (Bit >> WordLog2);
+			const double DistSq = DistSqToBlock(SearchPoint, ChildLevel, ChildX, ChildY);
+			if (DistSq >= GetBoundDistSq())
+			{
+				continue;
+			}
+
+			if (ChildLevel == 0)
+			{
+				VisitCell(FIntPoint(ChildX, ChildY), DistSq);
+				continue;
+			}
+
+			int32 Insert = NumChildren++;
+			while (Insert > 0 && Children[Insert - 1].DistSq < DistSq)
+			{
+				Children[Insert] = Children[Insert - 1];
+				--Insert;
+			}
+			Children[Insert] = {ChildLevel, ChildX, ChildY, DistSq};
+		}
+
+		check(StackSize + NumChildren <= UE_ARRAY_COUNT(Stack));
+		for (int32 Index = 0; Index < NumChildren; ++Index)
+		{
+			Stack[StackSize++] = Children[Index];
+		}
+	}
+}
+
+template<typename WordFuncType>
+void FOccupancyPyramid::VisitInRadius(const FIntPoint& Center, double RadiusSq, WordFuncType&& VisitWord) const
+{
+	// Entries are set bits at Level >= 1, i.e. non-empty words one level down. Order does not matter here.
+	struct FBlock
+	{
+		int32 Level;
+		int32 X;
+		int32 Y;
+	};
+	FBlock Stack[MaxLevels * 64];
+	int32 StackSize = 0;
+	Stack[StackSize++] = {Levels.Num(), 0, 0};
+
+	while (StackSize > 0)
+	{
+		const FBlock Block = Stack[--StackSize];
+		const int32 ChildLevel = Block.Level - 1;
+		uint64 Word = GetWord(ChildLevel, Block.X, Block.Y);
+
+		if (ChildLevel == 0)
+		{
+			VisitWord(Block.X, Block.Y, Word, MaxDistSqToBlock(Center, Block.Level, Block.X, Block.Y) < RadiusSq);
+			continue;
+		}
+
+		while (Word != 0)
+		{
+			const int32 Bit = FMath::CountTrailingZeros64(Word);
+			Word &= Word - 1;
+
+			const int32 ChildX = (Block.X << WordLog2) | (Bit & WordMask);
+			const int32 ChildY = (Block.Y << WordLog2) | (Bit >> WordLog2);
+			if (DistSqToBlock(Center, ChildLevel, ChildX, ChildY) < RadiusSq)
+			{
+				check(StackSize < UE_ARRAY_COUNT(Stack));
+				Stack[StackSize++] = {ChildLevel, ChildX, ChildY};
+			}
+		}
+	}
+}
+
+bool FOccupancyPyramid::FindNearest(const FIntPoint& SearchPoint, float MaxSearchRadius, FIntPoint& OutNearestPoint) const
+{
+	const double MaxDistanceSq = (double)MaxSearchRadius * MaxSearchRadius;
+	double MinDistanceSq = MaxDistanceSq;
+
+	VisitNearestFirst(SearchPoint, [&MinDistanceSq]() { return MinDistanceSq; }, [&](const FIntPoint& Cell, double DistSq)
+	{
+		MinDistanceSq = DistSq;
+		OutNearestPoint = Cell;
+	});
+
+	return MinDistanceSq < MaxDistanceSq;
+}
+
+int32 FOccupancyPyramid::FindKNearest(const FIntPoint& SearchPoint, float MaxSearchRadius, TArrayView<FIntPoint> OutPoints) const
+{
+	FWorldLayerKNearestHeap Heap(SearchPoint, OutPoints, MaxSearchRadius);
+	VisitNearestFirst(SearchPoint, [&Heap]() { return Heap.GetBoundDistSq(); }, [&Heap](const FIntPoint& Cell, double DistSq)
+	{
+		Heap.Offer(Cell);
+	});
+	return Heap.Finish();
+}
+
+int32 FOccupancyPyramid::ForEachInRadius(const FIntPoint& Center, float Radius, TFunctionRef<void(const FIntPoint&)> Visitor) const
+{
+	const double RadiusSq = (double)Radius * Radius;
+	int32 Count = 0;
+	VisitInRadius(Center, RadiusSq, [&](int32 WordX, int32 WordY, uint64 Word, bool bFullyInside)
+	{
+		while (Word != 0)
+		{
+			const int32 Bit = FMath::CountTrailingZeros64(Word);
+			Word &= Word - 1;
+
+			const FIntPoint Cell((WordX << WordLog2) | (Bit & WordMask), (WordY << WordLog2) | (Bit >> WordLog2));
+			if (bFullyInside || WorldLayerCellDistSq(Cell, Center) < RadiusSq)
+			{
+				Visitor(Cell);
+				++Count;
+			}
+		}
+	});
+	return Count;
+}
+
+int32 FOccupancyPyramid::CountInRadius(const FIntPoint& Center, float Radius) const
+{
+	const double RadiusSq = (double)Radius * Radius;
+	int32 Count = 0;
+	VisitInRadius(Center, RadiusSq, [&](int32 WordX, int32 WordY, uint64 Word, bool bFullyInside)
+	{
+		// A whole 8x8 block inside the circle counts in one instruction
+		if (bFullyInside)
+		{
+			Count += FMath::CountBits(Word);
+			return;
+		}
+
+		while (Word != 0)
+		{
+			const int32 Bit = FMath::CountTrailingZeros64(Word);
+			Word &= Word - 1;
+
+			const FIntPoint Cell((WordX << WordLog2) | (Bit & WordMask), (WordY << WordLog2) | (Bit >> WordLog2));
+			Count += WorldLayerCellDistSq(Cell, Center) < RadiusSq ? 1 : 0;
+		}
+	});
+	return Count;
+}
+
+SIZE_T FOccupancyPyramid::GetAllocatedSize() const
+{
+	SIZE_T Size = PageOffsets.GetAllocatedSize() + PagePool.GetAllocatedSize() + FreePageOffsets.GetAllocatedSize() + Levels.GetAllocatedSize();
+	for (const FLevel& Level : Levels)
+	{
+		Size += Level.Words.GetAllocatedSize();
+	}
+	return Size;
+}
+
+FWorldLayerSpatialIndexStats FOccupancyPyramid::GetStats() const
+{
+	FWorldLayerSpatialIndexStats Stats;
+	Stats.NumPoints = NumPoints;
+	Stats.NumFreeNodes = FreePageOffsets.Num();
+	Stats.NumNodes = PagePool.Num() / WordsPerPage - Stats.NumFreeNodes;
+	Stats.AllocatedBytes = GetAllocatedSize();
+	return Stats;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Spatial/SpatialIndex.h"
+
+/**
+ * Hierarchical occupancy bitmask. Level 0 has one bit per cell, packed into 64-bit words that each cover an 8x8 block.
+ * Every level above has one bit per word of the level below, set while that word is non-zero, again in 8x8 words,
+ * up to a single top word. Updates flip one bit and propagate only while a word changes between zero and non-zero,
+ * and searches skip every empty block at the coarsest level that shows it.
+ * Level 0 words are stored in pages of 8x8 words (64x64 cells) that exist only while they hold a set bit, so memory
+ * follows the occupied area rather than the layer size or the number of cells.
+ */
+class FOccupancyPyramid : public FWorldLayerSpatialIndex
+{
+public:
+	explicit FOccupancyPyramid(const FIntPoint& InResolution);
+
+	virtual void Build(TConstArrayView<FIntPoint> Points) override;
+	virtual void Insert(const FIntPoint& Point) override;
+	virtual bool Remove(const FIntPoint& Point) override;
+	virtual bool FindNearest(const FIntPoint& SearchPoint, float MaxSearchRadius, FIntPoint& OutNearestPoint) const override;
+	virtual int32 FindKNearest(const FIntPoint& SearchPoint, float MaxSearchRadius, TArrayView<FIntPoint> OutPoints) const override;
+	virtual int32 ForEachInRadius(const FIntPoint& Center, float Radius, TFunctionRef<void(const FIntPoint&)> Visitor) const override;
+	virtual int32 CountInRadius(const FIntPoint& Center, float Radius) const override;
+	virtual int32 GetNumPoints() const override { return NumPoints; }
+	virtual SIZE_T GetAllocatedSize() const override;
+
+	/** Nodes are allocated pages; free nodes are released pages waiting for reuse. */
+	virtual FWorldLayerSpatialIndexStats GetStats() const override;
+
+	bool Contains(const FIntPoint& Point) const;
+
+private:
+	static constexpr int32 WordLog2 = 3;
+	static constexpr int32 WordSize = 1 << WordLog2;
+	static constexpr int32 WordMask = WordSize - 1;
+	static constexpr int32 WordsPerPage = WordSize * WordSize;
+
+	/** Levels above 8^10 cells cannot occur for int32 resolutions. */
+	static constexpr int32 MaxLevels = 11;
+
+	struct FLevel
+	{
+		FIntPoint NumWords = FIntPoint::ZeroValue;
+		TArray<uint64> Words;
+	};
+
+	FORCEINLINE static uint64 BitFor(int32 X, int32 Y)
+	{
+		return 1ull << (((Y & WordMask) << WordLog2) | (X & WordMask));
+	}
+
+	FORCEINLINE bool IsValidPoint(const FIntPoint& Point) const
+	{
+		return (uint32)Point.X < (uint32)Resolution.X && (uint32)Point.Y < (uint32)Resolution.Y;
+	}
+
+	/** Returns the word at (WordX, WordY) of a level, or 0 for a level 0 word whose page does not exist. */
+	uint64 GetWord(int32 Level, int32 WordX, int32 WordY) const;
+
+	/** Returns the level 0 word containing the cell, allocating its page if needed. */
+	uint64& GetMutableLevel0Word(int32 X, int32 Y);
+
+	/** Sets or clears the bit for (X, Y) at Level >= 1 and propagates upwards while words change between zero and non-zero. */
+	void PropagateSet(int32 Level, int32 X, int32 Y);
+	void PropagateClear(int32 Level, int32 X, int32 Y);
+
+	int32 GetPageIndex(int32 Level0WordX, int32 Level0WordY) const
+	{
+		return (Level0WordY >> WordLog2) * Levels[1].NumWords.X + (Level0WordX >> WordLog2);
+	}
+
+	void ReleasePage(int32 PageIndex);
+
+	/** Squared distances from Point to the closest and farthest cell of the block that a bit at Level covers. */
+	static double DistSqToBlock(const FIntPoint& Point, int32 Level, int32 BlockX, int32 BlockY);
+	static double MaxDistSqToBlock(const FIntPoint& Point, int32 Level, int32 BlockX, int32 BlockY);
+
+	/**
+	 * Visits set cells nearest block first, skipping blocks that are not closer than GetBoundDistSq(), and calls
+	 * VisitCell(Cell, DistSq) for every set cell closer than the bound. The bound is re-read as the walk progresses.
+	 */
+	template<typename BoundFuncType, typename CellFuncType>
+	void VisitNearestFirst(const FIntPoint& SearchPoint, BoundFuncType&& GetBoundDistSq, CellFuncType&& VisitCell) const;
+
+	/** Calls VisitWord(WordX, WordY, Word, bFullyInside) for every non-empty level 0 word that overlaps the circle. */
+	template<typename WordFuncType>
+	void VisitInRadius(const FIntPoint& Center, double RadiusSq, WordFuncType&& VisitWord) const;
+
+	FIntPoint Resolution;
+
+	/** Levels[0] only records the word grid size; its words live in pages. Levels[1] has one bit per level 0 word. */
+	TArray<FLevel> Levels;
+
+	/** Offset of each page in PagePool, indexed like the words of level 1, or INDEX_NONE while the page is empty. */
+	TArray<int32> PageOffsets;
+	TArray<uint64> PagePool;
+	TArray<int32> FreePageOffsets;
+
+	int32 NumPoints = 0;
+};
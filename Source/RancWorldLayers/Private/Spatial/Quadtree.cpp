@@ -1,128 +1,506 @@
 #include "Spatial/Quadtree.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "Algo/Unique.h"
+
+namespace QuadtreeMorton
+{
+	/** Spreads the 32 bits of Value so there is a zero bit between each of them. */
+	FORCEINLINE uint64 SpreadBits(uint32 Value)
+	{
+		uint64 Bits = Value;
+		Bits = (Bits | (Bits << 16)) & 0x0000FFFF0000FFFFull;
+		Bits = (Bits | (Bits << 8)) & 0x00FF00FF00FF00FFull;
+		Bits = (Bits | (Bits << 4)) & 0x0F0F0F0F0F0F0F0Full;
+		Bits = (Bits | (Bits << 2)) & 0x3333333333333333ull;
+		Bits = (Bits | (Bits << 1)) & 0x5555555555555555ull;
+		return Bits;
+	}
+
+	FORCEINLINE uint32 CompactBits(uint64 Bits)
+	{
+		Bits &= 0x5555555555555555ull;
+		Bits = (Bits | (Bits >> 1)) & 0x3333333333333333ull;
+		Bits = (Bits | (Bits >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+		Bits = (Bits | (Bits >> 4)) & 0x00FF00FF00FF00FFull;
+		Bits = (Bits | (Bits >> 8)) & 0x0000FFFF0000FFFFull;
+		Bits = (Bits | (Bits >> 16)) & 0x00000000FFFFFFFFull;
+		return (uint32)Bits;
+	}
+
+	/** X goes to the even bits and Y to the odd bits, so the two bits per level equal the child index of that level. */
+	FORCEINLINE uint64 Encode(uint32 X, uint32 Y)
+	{
+		return SpreadBits(X) | (SpreadBits(Y) << 1);
+	}
+
+	FORCEINLINE FIntPoint Decode(uint64 Code)
+	{
+		return FIntPoint((int32)CompactBits(Code), (int32)CompactBits(Code >> 1));
+	}
+}
 
 FQuadtree::FQuadtree(const FBox2D& InBounds, int32 InMaxPointsPerNode)
-	: MaxPointsPerNode(InMaxPointsPerNode)
+	: MaxPointsPerNode(FMath::Max(InMaxPointsPerNode, 1))
 {
-	Root = MakeUnique<FQuadtreeNode>(InBounds);
+	// Round the bounds out to a power-of-two square so every split lands on a whole cell
+	const FIntPoint Min(FMath::FloorToInt(InBounds.Min.X), FMath::FloorToInt(InBounds.Min.Y));
+	const int32 Extent = FMath::Max(FMath::CeilToInt(InBounds.Max.X) - Min.X, FMath::CeilToInt(InBounds.Max.Y) - Min.Y);
+
+	FQuadtreeNode& Root = Nodes.AddDefaulted_GetRef();
+	Root.Min = Min;
+	Root.Size = (int32)FMath::RoundUpToPowerOfTwo(FMath::Max(Extent, 1));
 }
 
-void FQuadtree::Insert(const FIntPoint& Point)
+int32 FQuadtree::FindLeaf(const FIntPoint& Point) const
 {
-	FQuadtreeNode* Node = Root.Get();
-	while (Node->Children[0])
+	int32 NodeIndex = 0;
+	while (!Nodes[NodeIndex].IsLeaf())
 	{
-		Node = Node->Children[GetChildIndexForPoint(Node, Point)].Get();
+		NodeIndex = Nodes[NodeIndex].FirstChild + GetChildIndexForPoint(Nodes[NodeIndex], Point);
 	}
+	return NodeIndex;
+}
 
-	Node->Points.Add(Point);
+void FQuadtree::Insert(const FIntPoint& Point)
+{
+	if (!ContainsPoint(Nodes[0], Point))
+	{
+		return;
+	}
 
-	if (Node->Points.Num() > MaxPointsPerNode)
+	int32 NodeIndex = FindLeaf(Point);
+	for (;;)
 	{
-		Subdivide(Node);
+		FQuadtreeNode& Leaf = Nodes[NodeIndex];
+		for (int32 Index = 0; Index < Leaf.NumPoints; ++Index)
+		{
+			if (PointPool[Leaf.Bucket + Index] == Point)
+			{
+				return;
+			}
+		}
+
+		// A single-cell leaf can only ever hold this one point, so it never needs to split
+		if (Leaf.NumPoints < MaxPointsPerNode || Leaf.Size == 1)
+		{
+			if (Leaf.Bucket == INDEX_NONE)
+			{
+				const int32 Bucket = AllocateBucket();
+				Nodes[NodeIndex].Bucket = Bucket;
+			}
+			FQuadtreeNode& Target = Nodes[NodeIndex];
+			PointPool[Target.Bucket + Target.NumPoints++] = Point;
+			for (int32 Ancestor = Target.Parent; Ancestor != INDEX_NONE; Ancestor = Nodes[Ancestor].Parent)
+			{
+				++Nodes[Ancestor].NumPoints;
+			}
+			return;
+		}
+
+		// The points of a full leaf may all land in the same child, so keep splitting until one has room
+		Subdivide(NodeIndex);
+		NodeIndex = Nodes[NodeIndex].FirstChild + GetChildIndexForPoint(Nodes[NodeIndex], Point);
 	}
 }
 
 bool FQuadtree::Remove(const FIntPoint& Point)
 {
-	return RemoveFromNode(Root.Get(), Point);
-}
+	if (!ContainsPoint(Nodes[0], Point))
+	{
+		return false;
+	}
 
-bool FQuadtree::RemoveFromNode(FQuadtreeNode* Node, const FIntPoint& Point)
-{
-	if (!Node->Bounds.IsInside(FVector2D(Point.X, Point.Y)))
+	FQuadtreeNode& Leaf = Nodes[FindLeaf(Point)];
+	int32 PointIndex = 0;
+	while (PointIndex < Leaf.NumPoints && PointPool[Leaf.Bucket + PointIndex] != Point)
+	{
+		++PointIndex;
+	}
+	if (PointIndex == Leaf.NumPoints)
 	{
 		return false;
 	}
 
-	// If we are a leaf node, try to remove the point directly
-	if (Node->Children[0] == nullptr)
+	PointPool[Leaf.Bucket + PointIndex] = PointPool[Leaf.Bucket + --Leaf.NumPoints];
+	if (Leaf.NumPoints == 0)
 	{
-		int32 RemovedCount = Node->Points.Remove(Point);
-		return RemovedCount > 0;
+		ReleaseBucket(Leaf.Bucket);
+		Leaf.Bucket = INDEX_NONE;
 	}
 
-	// Otherwise, recurse down to the correct child
-	int32 ChildIndex = GetChildIndexForPoint(Node, Point);
-	if (Node->Children[ChildIndex])
+	// Subtree counts only grow towards the root, so the highest ancestor that fell under the limit covers all others
+	int32 CollapseIndex = INDEX_NONE;
+	for (int32 Ancestor = Leaf.Parent; Ancestor != INDEX_NONE; Ancestor = Nodes[Ancestor].Parent)
 	{
-		return RemoveFromNode(Node->Children[ChildIndex].Get(), Point);
+		if (--Nodes[Ancestor].NumPoints < MaxPointsPerNode)
+		{
+			CollapseIndex = Ancestor;
+		}
 	}
-	return false;
+	if (CollapseIndex != INDEX_NONE)
+	{
+		Collapse(CollapseIndex);
+	}
+	return true;
 }
 
-bool FQuadtree::FindNearest(const FIntPoint& SearchPoint, float MaxSearchRadius, FIntPoint& OutNearestPoint) const
+void FQuadtree::Collapse(int32 NodeIndex)
 {
-	float MinDistanceSq = MaxSearchRadius * MaxSearchRadius;
-	FindNearestRecursive(Root.Get(), SearchPoint, MinDistanceSq, OutNearestPoint);
-	return MinDistanceSq < MaxSearchRadius * MaxSearchRadius;
+	TArray<FIntPoint, TInlineAllocator<16>> Points;
+
+	int32 Stack[MaxTraversalStack];
+	int32 StackSize = 0;
+	Stack[StackSize++] = NodeIndex;
+	while (StackSize > 0)
+	{
+		const FQuadtreeNode& Node = Nodes[Stack[--StackSize]];
+		if (Node.IsLeaf())
+		{
+			if (Node.Bucket != INDEX_NONE)
+			{
+				Points.Append(PointPool.GetData() + Node.Bucket, Node.NumPoints);
+				ReleaseBucket(Node.Bucket);
+			}
+			continue;
+		}
+
+		// Released slots are only reused by later allocations, so the children can still be read below
+		FreeNodeGroups.Add(Node.FirstChild);
+		check(StackSize + 4 <= MaxTraversalStack);
+		for (int32 ChildIndex = 0; ChildIndex < 4; ++ChildIndex)
+		{
+			Stack[StackSize++] = Node.FirstChild + ChildIndex;
+		}
+	}
+
+	FQuadtreeNode& Node = Nodes[NodeIndex];
+	check(Points.Num() == Node.NumPoints);
+	Node.FirstChild = INDEX_NONE;
+	Node.Bucket = INDEX_NONE;
+	if (Points.Num() > 0)
+	{
+		const int32 Bucket = AllocateBucket();
+		FMemory::Memcpy(PointPool.GetData() + Bucket, Points.GetData(), Points.Num() * sizeof(FIntPoint));
+		Nodes[NodeIndex].Bucket = Bucket;
+	}
 }
 
-void FQuadtree::Subdivide(FQuadtreeNode* Node)
+void FQuadtree::Build(TConstArrayView<FIntPoint> Points)
 {
-	const FVector2D Center = Node->Bounds.GetCenter();
-	const FVector2D HalfSize = Node->Bounds.GetSize() / 2.0f;
+	FQuadtreeNode Root;
+	Root.Min = Nodes[0].Min;
+	Root.Size = Nodes[0].Size;
+	Nodes.Reset();
+	Nodes.Add(Root);
+	PointPool.Reset();
+	FreeNodeGroups.Reset();
+	FreeBuckets.Reset();
 
-	Node->Children[0] = MakeUnique<FQuadtreeNode>(FBox2D(Node->Bounds.Min, Center));
-	Node->Children[1] = MakeUnique<FQuadtreeNode>(FBox2D(FVector2D(Center.X, Node->Bounds.Min.Y), FVector2D(Node->Bounds.Max.X, Center.Y)));
-	Node->Children[2] = MakeUnique<FQuadtreeNode>(FBox2D(FVector2D(Node->Bounds.Min.X, Center.Y), FVector2D(Center.X, Node->Bounds.Max.Y)));
-	Node->Children[3] = MakeUnique<FQuadtreeNode>(FBox2D(Center, Node->Bounds.Max));
+	TArray<uint64> Codes;
+	Codes.Reserve(Points.Num());
+	for (const FIntPoint& Point : Points)
+	{
+		if (ContainsPoint(Root, Point))
+		{
+			Codes.Add(QuadtreeMorton::Encode((uint32)(Point.X - Root.Min.X), (uint32)(Point.Y - Root.Min.Y)));
+		}
+	}
+	Algo::Sort(Codes);
+	Codes.SetNum(Algo::Unique(Codes), EAllowShrinking::No);
+
+	// Full leaves hold MaxPointsPerNode points and each split adds four nodes, which bounds both pools
+	const int32 ExpectedLeaves = Codes.Num() / MaxPointsPerNode + 1;
+	Nodes.Reserve(ExpectedLeaves * 2);
+	PointPool.Reserve(ExpectedLeaves * 2 * MaxPointsPerNode);
+
+	BuildNode(0, Codes, 0, Codes.Num());
+}
 
-	for (const FIntPoint& Point : Node->Points)
+void FQuadtree::BuildNode(int32 NodeIndex, const TArray<uint64>& Codes, int32 Begin, int32 End)
+{
+	const int32 Count = End - Begin;
+	Nodes[NodeIndex].NumPoints = Count;
+	if (Count <= MaxPointsPerNode || Nodes[NodeIndex].Size == 1)
 	{
-		Node->Children[GetChildIndexForPoint(Node, Point)]->Points.Add(Point);
+		if (Count > 0)
+		{
+			// Codes are relative to the root
+			const int32 Bucket = AllocateBucket();
+			const FIntPoint RootMin = Nodes[0].Min;
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				PointPool[Bucket + Index] = RootMin + QuadtreeMorton::Decode(Codes[Begin + Index]);
+			}
+			Nodes[NodeIndex].Bucket = Bucket;
+		}
+		return;
 	}
 
-	Node->Points.Empty();
+	// Codes inside this node share every bit above Shift + 2; the two bits at Shift select the child
+	const int32 Shift = 2 * (FMath::FloorLog2((uint32)Nodes[NodeIndex].Size) - 1);
+	const uint64 Prefix = Codes[Begin] & ~((4ull << Shift) - 1);
+	const int32 FirstChild = AllocateChildren(NodeIndex);
+
+	int32 ChildBegin = Begin;
+	for (int32 ChildIndex = 0; ChildIndex < 4; ++ChildIndex)
+	{
+		int32 ChildEnd = End;
+		if (ChildIndex < 3)
+		{
+			const uint64 NextChildStart = Prefix | ((uint64)(ChildIndex + 1) << Shift);
+			ChildEnd = ChildBegin + Algo::LowerBound(TConstArrayView<uint64>(Codes.GetData() + ChildBegin, End - ChildBegin), NextChildStart);
+		}
+		BuildNode(FirstChild + ChildIndex, Codes, ChildBegin, ChildEnd);
+		ChildBegin = ChildEnd;
+	}
 }
 
-int32 FQuadtree::GetChildIndexForPoint(const FQuadtreeNode* Node, const FIntPoint& Point) const
+int32 FQuadtree::AllocateChildren(int32 NodeIndex)
 {
-	const FVector2D Center = Node->Bounds.GetCenter();
-	if (Point.X < Center.X)
+	int32 FirstChild;
+	if (FreeNodeGroups.Num() > 0)
 	{
-		return (Point.Y < Center.Y) ? 0 : 2;
+		FirstChild = FreeNodeGroups.Pop(EAllowShrinking::No);
 	}
 	else
 	{
-		return (Point.Y < Center.Y) ? 1 : 3;
+		FirstChild = Nodes.AddUninitialized(4);
+	}
+
+	const int32 Half = Nodes[NodeIndex].Size >> 1;
+	const FIntPoint Min = Nodes[NodeIndex].Min;
+	for (int32 ChildIndex = 0; ChildIndex < 4; ++ChildIndex)
+	{
+		FQuadtreeNode& Child = Nodes[FirstChild + ChildIndex];
+		Child = FQuadtreeNode();
+		Child.Parent = NodeIndex;
+		Child.Min = FIntPoint(Min.X + ((ChildIndex & 1) ? Half : 0), Min.Y + ((ChildIndex & 2) ? Half : 0));
+		Child.Size = Half;
 	}
+
+	Nodes[NodeIndex].FirstChild = FirstChild;
+	return FirstChild;
 }
 
-void FQuadtree::FindNearestRecursive(const FQuadtreeNode* Node, const FIntPoint& SearchPoint, float& MinDistanceSq, FIntPoint& OutNearestPoint) const
+void FQuadtree::Subdivide(int32 NodeIndex)
 {
-	// Calculate the squared distance from the search point to the closest point on the node's bounding box.
-	float ClosestDistSqToNode = Node->Bounds.ComputeSquaredDistanceToPoint(FVector2D(SearchPoint.X, SearchPoint.Y));
+	const int32 FirstChild = AllocateChildren(NodeIndex);
+	FQuadtreeNode& Node = Nodes[NodeIndex];
+
+	// Children start empty and have at most MaxPointsPerNode points between them, so none of them can overflow here.
+	// The parent's bucket is handed to the child that receives the first point. The parent keeps its subtree count.
+	const int32 ParentBucket = Node.Bucket;
+	const int32 ParentNumPoints = Node.NumPoints;
+	Node.Bucket = INDEX_NONE;
+
+	TArray<FIntPoint, TInlineAllocator<16>> Moving;
+	Moving.Append(PointPool.GetData() + ParentBucket, ParentNumPoints);
 
-	// If the closest point on this node's bounding box is further than the current best found point,
-	// then this node (and its children) cannot contain a better point. Prune this branch.
-	if (ClosestDistSqToNode >= MinDistanceSq)
+	bool bReusedParentBucket = false;
+	for (const FIntPoint& Point : Moving)
 	{
-		return;
+		const int32 ChildNodeIndex = FirstChild + GetChildIndexForPoint(Nodes[NodeIndex], Point);
+		if (Nodes[ChildNodeIndex].Bucket == INDEX_NONE)
+		{
+			int32 Bucket;
+			if (!bReusedParentBucket)
+			{
+				Bucket = ParentBucket;
+				bReusedParentBucket = true;
+			}
+			else
+			{
+				Bucket = AllocateBucket();
+			}
+			Nodes[ChildNodeIndex].Bucket = Bucket;
+		}
+		FQuadtreeNode& Child = Nodes[ChildNodeIndex];
+		PointPool[Child.Bucket + Child.NumPoints++] = Point;
 	}
+}
 
-	for (const FIntPoint& Point : Node->Points)
+int32 FQuadtree::AllocateBucket()
+{
+	if (FreeBuckets.Num() > 0)
 	{
-		float DistSq = FVector::DistSquared(FVector(Point.X, Point.Y, 0), FVector(SearchPoint.X, SearchPoint.Y, 0));
-		if (DistSq < MinDistanceSq)
+		return FreeBuckets.Pop(EAllowShrinking::No);
+	}
+	return PointPool.AddUninitialized(MaxPointsPerNode);
+}
+
+void FQuadtree::ReleaseBucket(int32 Bucket)
+{
+	FreeBuckets.Add(Bucket);
+}
+
+double FQuadtree::DistSqToNode(const FQuadtreeNode& Node, const FIntPoint& Point)
+{
+	const int64 DX = (int64)FMath::Clamp(Point.X, Node.Min.X, Node.Min.X + Node.Size - 1) - Point.X;
+	const int64 DY = (int64)FMath::Clamp(Point.Y, Node.Min.Y, Node.Min.Y + Node.Size - 1) - Point.Y;
+	return (double)(DX * DX + DY * DY);
+}
+
+double FQuadtree::MaxDistSqToNode(const FQuadtreeNode& Node, const FIntPoint& Point)
+{
+	const int64 DX = FMath::Max(FMath::Abs((int64)Point.X - Node.Min.X), FMath::Abs((int64)Node.Min.X + Node.Size - 1 - Point.X));
+	const int64 DY = FMath::Max(FMath::Abs((int64)Point.Y - Node.Min.Y), FMath::Abs((int64)Node.Min.Y + Node.Size - 1 - Point.Y));
+	return (double)(DX * DX + DY * DY);
+}
+
+template<typename BoundFuncType, typename LeafFuncType>
+void FQuadtree::VisitNearestFirst(const FIntPoint& SearchPoint, BoundFuncType&& GetBoundDistSq, LeafFuncType&& VisitLeaf) const
+{
+	int32 Stack[MaxTraversalStack];
+	int32 StackSize = 0;
+	Stack[StackSize++] = 0;
+
+	while (StackSize > 0)
+	{
+		const FQuadtreeNode& Node = Nodes[Stack[--StackSize]];
+
+		// If the closest cell of this node is further than the current best found point,
+		// then this node (and its children) cannot contain a better point. Prune this branch.
+		if (DistSqToNode(Node, SearchPoint) >= GetBoundDistSq())
+		{
+			continue;
+		}
+
+		if (Node.IsLeaf())
 		{
-			MinDistanceSq = DistSq;
-			OutNearestPoint = Point;
+			VisitLeaf(Node);
+			continue;
 		}
+
+		// Visit the child containing the search point first, then its two edge neighbours, then the opposite one.
+		// The stack is LIFO, so push them in reverse.
+		check(StackSize + 4 <= MaxTraversalStack);
+		const int32 NearChild = GetChildIndexForPoint(Node, SearchPoint);
+		Stack[StackSize++] = Node.FirstChild + (NearChild ^ 3);
+		Stack[StackSize++] = Node.FirstChild + (NearChild ^ 2);
+		Stack[StackSize++] = Node.FirstChild + (NearChild ^ 1);
+		Stack[StackSize++] = Node.FirstChild + NearChild;
 	}
+}
+
+template<typename NodeFuncType>
+void FQuadtree::VisitInRadius(const FIntPoint& Center, double RadiusSq, bool bStopAtFullyInside, NodeFuncType&& VisitNode) const
+{
+	int32 Stack[MaxTraversalStack];
+	int32 StackSize = 0;
+	Stack[StackSize++] = 0;
 
-	if (Node->Children[0])
+	while (StackSize > 0)
 	{
-		// Recursively search children, prioritizing closer children first
-		TArray<TPair<float, FQuadtreeNode*>> SortedChildren;
-		for (int32 i = 0; i < 4; ++i)
+		const FQuadtreeNode& Node = Nodes[Stack[--StackSize]];
+		if (DistSqToNode(Node, Center) >= RadiusSq)
 		{
-			SortedChildren.Add(TPair<float, FQuadtreeNode*>(Node->Children[i]->Bounds.ComputeSquaredDistanceToPoint(FVector2D(SearchPoint.X, SearchPoint.Y)), Node->Children[i].Get()));
+			continue;
 		}
-		SortedChildren.Sort([](const TPair<float, FQuadtreeNode*>& A, const TPair<float, FQuadtreeNode*>& B) { return A.Key < B.Key; });
 
-		for (const TPair<float, FQuadtreeNode*>& ChildPair : SortedChildren)
+		const bool bFullyInside = MaxDistSqToNode(Node, Center) < RadiusSq;
+		if (Node.IsLeaf() || (bStopAtFullyInside && bFullyInside))
 		{
-			FindNearestRecursive(ChildPair.Value, SearchPoint, MinDistanceSq, OutNearestPoint);
+			VisitNode(Node, bFullyInside);
+			continue;
+		}
+
+		check(StackSize + 4 <= MaxTraversalStack);
+		for (int32 ChildIndex = 0; ChildIndex < 4; ++ChildIndex)
+		{
+			Stack[StackSize++] = Node.FirstChild + ChildIndex;
 		}
 	}
 }
+
+bool FQuadtree::FindNearest(const FIntPoint& SearchPoint, float MaxSearchRadius, FIntPoint& OutNearestPoint) const
+{
+	const double MaxDistanceSq = (double)MaxSearchRadius * MaxSearchRadius;
+	double MinDistanceSq = MaxDistanceSq;
+
+	VisitNearestFirst(SearchPoint, [&MinDistanceSq]() { return MinDistanceSq; }, [&](const FQuadtreeNode& Leaf)
+	{
+		const FIntPoint* Points = PointPool.GetData() + Leaf.Bucket;
+		for (int32 Index = 0; Index < Leaf.NumPoints; ++Index)
+		{
+			const double DistSq = WorldLayerCellDistSq(Points[Index], SearchPoint);
+			if (DistSq < MinDistanceSq)
+			{
+				MinDistanceSq = DistSq;
+				OutNearestPoint = Points[Index];
+			}
+		}
+	});
+
+	return MinDistanceSq < MaxDistanceSq;
+}
+
+int32 FQuadtree::FindKNearest(const FIntPoint& SearchPoint, float MaxSearchRadius, TArrayView<FIntPoint> OutPoints) const
+{
+	FWorldLayerKNearestHeap Heap(SearchPoint, OutPoints, MaxSearchRadius);
+	VisitNearestFirst(SearchPoint, [&Heap]() { return Heap.GetBoundDistSq(); }, [&](const FQuadtreeNode& Leaf)
+	{
+		const FIntPoint* Points = PointPool.GetData() + Leaf.Bucket;
+		for (int32 Index = 0; Index < Leaf.NumPoints; ++Index)
+		{
+			Heap.Offer(Points[Index]);
+		}
+	});
+	return Heap.Finish();
+}
+
+int32 FQuadtree::ForEachInRadius(const FIntPoint& Center, float Radius, TFunctionRef<void(const FIntPoint&)> Visitor) const
+{
+	const double RadiusSq = (double)Radius * Radius;
+	int32 Count = 0;
+	VisitInRadius(Center, RadiusSq, false, [&](const FQuadtreeNode& Leaf, bool bFullyInside)
+	{
+		const FIntPoint* Points = PointPool.GetData() + Leaf.Bucket;
+		for (int32 Index = 0; Index < Leaf.NumPoints; ++Index)
+		{
+			if (bFullyInside || WorldLayerCellDistSq(Points[Index], Center) < RadiusSq)
+			{
+				Visitor(Points[Index]);
+				++Count;
+			}
+		}
+	});
+	return Count;
+}
+
+int32 FQuadtree::CountInRadius(const FIntPoint& Center, float Radius) const
+{
+	const double RadiusSq = (double)Radius * Radius;
+	int32 Count = 0;
+	// Subtree counts let a node inside the circle count without visiting its leaves
+	VisitInRadius(Center, RadiusSq, true, [&](const FQuadtreeNode& Node, bool bFullyInside)
+	{
+		if (bFullyInside)
+		{
+			Count += Node.NumPoints;
+			return;
+		}
+
+		const FIntPoint* Points = PointPool.GetData() + Node.Bucket;
+		for (int32 Index = 0; Index < Node.NumPoints; ++Index)
+		{
+			Count += WorldLayerCellDistSq(Points[Index], Center) < RadiusSq ? 1 : 0;
+		}
+	});
+	return Count;
+}
+
+SIZE_T FQuadtree::GetAllocatedSize() const
+{
+	return Nodes.GetAllocatedSize() + PointPool.GetAllocatedSize() + FreeNodeGroups.GetAllocatedSize() + FreeBuckets.GetAllocatedSize();
+}
+
+FWorldLayerSpatialIndexStats FQuadtree::GetStats() const
+{
+	FWorldLayerSpatialIndexStats Stats;
+	Stats.NumPoints = Nodes[0].NumPoints;
+	Stats.NumFreeNodes = FreeNodeGroups.Num() * 4;
+	Stats.NumNodes = Nodes.Num() - Stats.NumFreeNodes;
+	Stats.AllocatedBytes = GetAllocatedSize();
+	return Stats;
+}
@@ -1,33 +1,116 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Spatial/SpatialIndex.h"
 
-// A node in the Quadtree
+// A node in the Quadtree. Nodes cover power-of-two squares of cells and live in one contiguous pool.
 struct FQuadtreeNode
 {
-	FQuadtreeNode(const FBox2D& InBounds) : Bounds(InBounds) {}
+	/** First cell covered by the node. The node covers [Min, Min + Size) on both axes. */
+	FIntPoint Min = FIntPoint::ZeroValue;
+	int32 Size = 0;
 
-	FBox2D Bounds;
-	TArray<FIntPoint> Points;
-	TUniquePtr<FQuadtreeNode> Children[4];
+	/** Index of the first of the four consecutive children, or INDEX_NONE for a leaf. */
+	int32 FirstChild = INDEX_NONE;
+
+	/** Index of the parent node, or INDEX_NONE for the root. */
+	int32 Parent = INDEX_NONE;
+
+	/** Leaves only: start of this leaf's bucket in the point pool, or INDEX_NONE while it never held a point. */
+	int32 Bucket = INDEX_NONE;
+
+	/** Number of points in the subtree. For a leaf, the number of points used in its bucket. */
+	int32 NumPoints = 0;
+
+	FORCEINLINE bool IsLeaf() const { return FirstChild == INDEX_NONE; }
 };
 
-// The Quadtree itself
-class FQuadtree
+/**
+ * Point quadtree linearized into two pools: nodes, and fixed-size point buckets of MaxPointsPerNode entries per leaf.
+ * Children are addressed by index rather than pointer, and queries walk the tree with a fixed-size stack, so neither
+ * inserts into existing leaves nor queries allocate. Points are treated as a set; inserting a point twice is a no-op.
+ * Removing points collapses every subtree that falls under MaxPointsPerNode back into one leaf. The freed node groups
+ * and buckets go to free lists that later splits draw from, so a tree under churn stays as small as its contents.
+ */
+class FQuadtree : public FWorldLayerSpatialIndex
 {
 public:
 	FQuadtree(const FBox2D& InBounds, int32 InMaxPointsPerNode = 4);
 
-	void Insert(const FIntPoint& Point);
-	bool Remove(const FIntPoint& Point);
-	bool FindNearest(const FIntPoint& SearchPoint, float MaxSearchRadius, FIntPoint& OutNearestPoint) const;
+	/**
+	 * Replaces the contents with Points in one pass. Points are sorted by Morton code, which orders them exactly as the
+	 * tree's quadrants nest, so each node is built from a contiguous range and every leaf gets one tight bucket.
+	 * Much faster than inserting the points one by one, which subdivides repeatedly.
+	 */
+	virtual void Build(TConstArrayView<FIntPoint> Points) override;
+
+	virtual void Insert(const FIntPoint& Point) override;
+	virtual bool Remove(const FIntPoint& Point) override;
+	virtual bool FindNearest(const FIntPoint& SearchPoint, float MaxSearchRadius, FIntPoint& OutNearestPoint) const override;
+	virtual int32 FindKNearest(const FIntPoint& SearchPoint, float MaxSearchRadius, TArrayView<FIntPoint> OutPoints) const override;
+	virtual int32 ForEachInRadius(const FIntPoint& Center, float Radius, TFunctionRef<void(const FIntPoint&)> Visitor) const override;
+	virtual int32 CountInRadius(const FIntPoint& Center, float Radius) const override;
+
+	virtual int32 GetNumPoints() const override { return Nodes[0].NumPoints; }
+
+	/** Bytes held by the node and point pools. */
+	virtual SIZE_T GetAllocatedSize() const override;
+
+	/** Nodes are tree nodes in use; free nodes are pooled for reuse by later splits. */
+	virtual FWorldLayerSpatialIndexStats GetStats() const override;
 
 private:
-	void Subdivide(FQuadtreeNode* Node);
-	int32 GetChildIndexForPoint(const FQuadtreeNode* Node, const FIntPoint& Point) const;
-	void FindNearestRecursive(const FQuadtreeNode* Node, const FIntPoint& SearchPoint, float& MinDistanceSq, FIntPoint& OutNearestPoint) const;
-	bool RemoveFromNode(FQuadtreeNode* Node, const FIntPoint& Point);
-	
-	TUniquePtr<FQuadtreeNode> Root;
+	/** Enough for three pending siblings per level of a tree over a 2^31 cell square. */
+	static constexpr int32 MaxTraversalStack = 128;
+
+	FORCEINLINE int32 GetChildIndexForPoint(const FQuadtreeNode& Node, const FIntPoint& Point) const
+	{
+		const int32 Half = Node.Size >> 1;
+		return (Point.X >= Node.Min.X + Half ? 1 : 0) | (Point.Y >= Node.Min.Y + Half ? 2 : 0);
+	}
+
+	FORCEINLINE static bool ContainsPoint(const FQuadtreeNode& Node, const FIntPoint& Point)
+	{
+		return (uint32)(Point.X - Node.Min.X) < (uint32)Node.Size && (uint32)(Point.Y - Node.Min.Y) < (uint32)Node.Size;
+	}
+
+	/** Squared distance from Point to the closest cell of the node. */
+	static double DistSqToNode(const FQuadtreeNode& Node, const FIntPoint& Point);
+
+	/** Squared distance from Point to the farthest cell of the node. */
+	static double MaxDistSqToNode(const FQuadtreeNode& Node, const FIntPoint& Point);
+
+	/**
+	 * Walks the tree nearest child first, skipping nodes that are not closer than GetBoundDistSq(), and calls VisitLeaf
+	 * for every leaf reached. The bound is re-read per node, so it may shrink while the walk progresses.
+	 */
+	template<typename BoundFuncType, typename LeafFuncType>
+	void VisitNearestFirst(const FIntPoint& SearchPoint, BoundFuncType&& GetBoundDistSq, LeafFuncType&& VisitLeaf) const;
+
+	/**
+	 * Calls VisitNode(Node, bFullyInside) for every leaf that overlaps the circle. With bStopAtFullyInside, a node that
+	 * lies entirely inside the circle is passed as a whole instead of being descended into.
+	 */
+	template<typename NodeFuncType>
+	void VisitInRadius(const FIntPoint& Center, double RadiusSq, bool bStopAtFullyInside, NodeFuncType&& VisitNode) const;
+
+	int32 FindLeaf(const FIntPoint& Point) const;
+	void Subdivide(int32 NodeIndex);
+
+	/** Appends the four children of a leaf and links them. Returns the index of the first child. */
+	int32 AllocateChildren(int32 NodeIndex);
+	void BuildNode(int32 NodeIndex, const TArray<uint64>& Codes, int32 Begin, int32 End);
+	int32 AllocateBucket();
+	void ReleaseBucket(int32 Bucket);
+
+	/** Turns an internal node back into a leaf holding all points of its subtree, and frees the nodes and buckets below it. */
+	void Collapse(int32 NodeIndex);
+
+	TArray<FQuadtreeNode> Nodes;
+	TArray<FIntPoint> PointPool;
 	int32 MaxPointsPerNode;
+
+	/** First node of each released group of four siblings, and start of each released bucket. */
+	TArray<int32> FreeNodeGroups;
+	TArray<int32> FreeBuckets;
 };
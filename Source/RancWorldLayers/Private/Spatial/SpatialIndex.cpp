@@ -0,0 +1,74 @@
+#include "Spatial/SpatialIndex.h"
+#include "Spatial/OccupancyPyramid.h"
+#include "Spatial/Quadtree.h"
+#include "Algo/Sort.h"
+
+TSharedPtr<FWorldLayerSpatialIndex> FWorldLayerSpatialIndex::Create(EWorldDataLayerStructureType StructureType, const FIntPoint& Resolution)
+{
+	switch (StructureType)
+	{
+		case EWorldDataLayerStructureType::OccupancyPyramid:
+			return MakeShared<FOccupancyPyramid>(Resolution);
+		case EWorldDataLayerStructureType::Quadtree:
+		default:
+			return MakeShared<FQuadtree>(FBox2D(FVector2D(0, 0), FVector2D(Resolution.X, Resolution.Y)));
+	}
+}
+
+void FWorldLayerKNearestHeap::Offer(const FIntPoint& Point)
+{
+	const double DistSq = WorldLayerCellDistSq(Point, SearchPoint);
+	if (DistSq >= GetBoundDistSq())
+	{
+		return;
+	}
+
+	int32 Index;
+	if (Num < Storage.Num())
+	{
+		// Sift the new point up from the end
+		Index = Num++;
+		while (Index > 0)
+		{
+			const int32 Parent = (Index - 1) / 2;
+			if (DistSqAt(Parent) >= DistSq)
+			{
+				break;
+			}
+			Storage[Index] = Storage[Parent];
+			Index = Parent;
+		}
+	}
+	else
+	{
+		// Replace the farthest point at the root and sift down
+		Index = 0;
+		for (;;)
+		{
+			const int32 Left = Index * 2 + 1;
+			if (Left >= Num)
+			{
+				break;
+			}
+			const int32 Right = Left + 1;
+			const int32 Larger = (Right < Num && DistSqAt(Right) > DistSqAt(Left)) ? Right : Left;
+			if (DistSqAt(Larger) <= DistSq)
+			{
+				break;
+			}
+			Storage[Index] = Storage[Larger];
+			Index = Larger;
+		}
+	}
+	Storage[Index] = Point;
+}
+
+int32 FWorldLayerKNearestHeap::Finish()
+{
+	const FIntPoint Origin = SearchPoint;
+	Algo::Sort(Storage.Left(Num), [&Origin](const FIntPoint& A, const FIntPoint& B)
+	{
+		return WorldLayerCellDistSq(A, Origin) < WorldLayerCellDistSq(B, Origin);
+	});
+	return Num;
+}
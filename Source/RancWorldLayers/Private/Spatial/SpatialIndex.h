@@ -0,0 +1,93 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldDataLayerAsset.h"
+#include "WorldLayerSpatialIndexStats.h"
+
+/**
+ * Set of cells of one tracked value, queryable by distance. UWorldDataLayer keeps one per tracked value and picks the
+ * implementation from FWorldDataLayerSpatialOptimization::StructureType.
+ */
+class FWorldLayerSpatialIndex
+{
+public:
+	virtual ~FWorldLayerSpatialIndex() = default;
+
+	/** Creates an empty index of the given type covering a layer of the given resolution. */
+	static TSharedPtr<FWorldLayerSpatialIndex> Create(EWorldDataLayerStructureType StructureType, const FIntPoint& Resolution);
+
+	/** Replaces the contents with Points in one pass. */
+	virtual void Build(TConstArrayView<FIntPoint> Points) = 0;
+
+	virtual void Insert(const FIntPoint& Point) = 0;
+	virtual bool Remove(const FIntPoint& Point) = 0;
+
+	/** Finds the point closest to SearchPoint that lies strictly within MaxSearchRadius cells. */
+	virtual bool FindNearest(const FIntPoint& SearchPoint, float MaxSearchRadius, FIntPoint& OutNearestPoint) const = 0;
+
+	/**
+	 * Finds up to OutPoints.Num() points closest to SearchPoint within MaxSearchRadius cells, written nearest first.
+	 * Returns how many were found. Uses OutPoints itself as the bounded priority queue, so it does not allocate.
+	 */
+	virtual int32 FindKNearest(const FIntPoint& SearchPoint, float MaxSearchRadius, TArrayView<FIntPoint> OutPoints) const = 0;
+
+	/** Calls Visitor for every point strictly within Radius cells of Center, in no particular order. Returns the number of points visited. */
+	virtual int32 ForEachInRadius(const FIntPoint& Center, float Radius, TFunctionRef<void(const FIntPoint&)> Visitor) const = 0;
+
+	/** Counts the points strictly within Radius cells of Center. */
+	virtual int32 CountInRadius(const FIntPoint& Center, float Radius) const = 0;
+
+	/** Number of cells in the index. */
+	virtual int32 GetNumPoints() const = 0;
+
+	/** Bytes of memory held by the index. */
+	virtual SIZE_T GetAllocatedSize() const = 0;
+
+	/** Points, structural units in use and pooled, and bytes held, for monitoring. */
+	virtual FWorldLayerSpatialIndexStats GetStats() const = 0;
+};
+
+/** Squared distance between two cells, exact for any int32 coordinates. */
+FORCEINLINE double WorldLayerCellDistSq(const FIntPoint& A, const FIntPoint& B)
+{
+	const int64 DX = (int64)A.X - B.X;
+	const int64 DY = (int64)A.Y - B.Y;
+	return (double)(DX * DX + DY * DY);
+}
+
+/**
+ * Bounded max-heap of the best K points found so far, kept in caller memory. The root is the farthest kept point, so
+ * GetBoundDistSq is what a candidate has to beat once the heap is full. Distances are recomputed from the points.
+ */
+struct FWorldLayerKNearestHeap
+{
+	FWorldLayerKNearestHeap(const FIntPoint& InSearchPoint, TArrayView<FIntPoint> InStorage, float MaxSearchRadius)
+		: SearchPoint(InSearchPoint)
+		, Storage(InStorage)
+		, MaxDistanceSq((double)MaxSearchRadius * MaxSearchRadius)
+	{
+	}
+
+	FORCEINLINE double GetBoundDistSq() const
+	{
+		// With no storage nothing can be kept, so nothing is worth visiting
+		if (Storage.Num() == 0)
+		{
+			return 0.0;
+		}
+		return Num < Storage.Num() ? MaxDistanceSq : WorldLayerCellDistSq(Storage[0], SearchPoint);
+	}
+
+	void Offer(const FIntPoint& Point);
+
+	/** Sorts the kept points nearest first and returns how many there are. */
+	int32 Finish();
+
+private:
+	FORCEINLINE double DistSqAt(int32 Index) const { return WorldLayerCellDistSq(Storage[Index], SearchPoint); }
+
+	FIntPoint SearchPoint;
+	TArrayView<FIntPoint> Storage;
+	double MaxDistanceSq;
+	int32 Num = 0;
+};
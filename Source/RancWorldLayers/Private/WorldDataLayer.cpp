@@ -1,11 +1,18 @@
 #include "WorldDataLayer.h"
-#include "Spatial/Quadtree.h"
+#include "WorldLayerAccessor.h"
+#include "WorldLayerSnapshot.h"
+#include "Spatial/SpatialIndex.h"
 #include "Engine/Texture2D.h"
+#include "Async/ParallelFor.h"
 #include "TextureResource.h"
 
 void UWorldDataLayer::Initialize(UWorldDataLayerAsset* InConfig, const FVector2D& InWorldGridSize)
 {
 	Config = TObjectPtr<UWorldDataLayerAsset>(InConfig);
+	if (!SnapshotChannel.IsValid())
+	{
+		SnapshotChannel = MakeShared<FWorldLayerSnapshotChannel, ESPMode::ThreadSafe>();
+	}
 	Reinitialize(InWorldGridSize);
 }
 
@@ -13,6 +20,8 @@ void UWorldDataLayer::Reinitialize(const FVector2D& InWorldGridSize)
 {
 	if (!Config) return;
 
+	++Generation;
+
 	if (Config->ResolutionMode == EResolutionMode::Absolute)
 	{
 		Resolution = Config->Resolution;
@@ -27,18 +36,11 @@ void UWorldDataLayer::Reinitialize(const FVector2D& InWorldGridSize)
 	UE_LOG(LogTemp, Log, TEXT("[RancWorldLayers] WorldDataLayer '%s' Initializing: Format=%d, Res=%dx%d"), 
 		*Config->LayerName.ToString(), (int32)Config->DataFormat, Resolution.X, Resolution.Y);
 
-	RawData.SetNumZeroed(Resolution.X * Resolution.Y * BytesPerPixel);
-
-	// 1. Initialize with DefaultValue
-	bIsInitializing = true;
-	for (int32 Y = 0; Y < Resolution.Y; ++Y)
-	{
-		for (int32 X = 0; X < Resolution.X; ++X)
-		{
-			SetValueAtPixel(FIntPoint(X, Y), Config->DefaultValue);
-		}
-	}
-	bIsInitializing = false;
+	// 1. Initialize with DefaultValue. The value is encoded once and the store replicates it per tile.
+	TArray<uint8, TInlineAllocator<8>> DefaultPixel;
+	DefaultPixel.SetNumUninitialized(BytesPerPixel);
+	EncodePixel(Config->DefaultValue, DefaultPixel.GetData());
+	Storage.Initialize(Resolution, BytesPerPixel, DefaultPixel.GetData(), Config->bUseSparseStorage);
 
 	// 2. Override with InitialDataTexture if provided
 	if (UTexture2D* Texture = Config->InitialDataTexture.LoadSynchronous())
@@ -58,39 +60,8 @@ void UWorldDataLayer::Reinitialize(const FVector2D& InWorldGridSize)
 			if (Source.GetMipData(OutRawData, 0))
 			{
 				UE_LOG(LogTemp, Log, TEXT("[RancWorldLayers] WorldDataLayer: Successfully locked Source data (%dx%d)"), TexWidth, TexHeight);
-				
-				for (int32 Y = 0; Y < Resolution.Y; ++Y)
-				{
-					float V = (float)Y / (float)Resolution.Y;
-					int32 TexY = FMath::Clamp(FMath::FloorToInt(V * TexHeight), 0, TexHeight - 1);
 
-					for (int32 X = 0; X < Resolution.X; ++X)
-					{
-						float U = (float)X / (float)Resolution.X;
-						int32 TexX = FMath::Clamp(FMath::FloorToInt(U * TexWidth), 0, TexWidth - 1);
-						
-						FLinearColor PixelColor = FLinearColor::Black;
-						
-						if (SourceFormat == TSF_BGRA8)
-						{
-							const FColor* FormattedData = reinterpret_cast<const FColor*>(OutRawData.GetData());
-							FColor RawColor = FormattedData[TexY * TexWidth + TexX];
-							
-							// Manual conversion to avoid FLinearColor(FColor) sRGB lookup table
-							PixelColor.R = RawColor.R / 255.0f;
-							PixelColor.G = RawColor.G / 255.0f;
-							PixelColor.B = RawColor.B / 255.0f;
-							PixelColor.A = RawColor.A / 255.0f;
-						}
-						else if (SourceFormat == TSF_G8)
-						{
-							float Gray = OutRawData[TexY * TexWidth + TexX] / 255.0f;
-							PixelColor = FLinearColor(Gray, Gray, Gray, 1.0f);
-						}
-
-						SetValueAtPixel(FIntPoint(X, Y), PixelColor);
-					}
-				}
+				PopulateFromPixels(OutRawData.GetData(), TexWidth, TexHeight, SourceFormat == TSF_G8);
 				bHasBeenInitializedFromTexture = true;
 				UE_LOG(LogTemp, Log, TEXT("[RancWorldLayers] WorldDataLayer: Successfully populated '%s' from Source."), *Config->LayerName.ToString());
 			}
@@ -106,40 +77,23 @@ void UWorldDataLayer::Reinitialize(const FVector2D& InWorldGridSize)
 				const void* RawTextureData = PlatformData->Mips[0].BulkData.LockReadOnly();
 				if (RawTextureData)
 				{
-					const int32 PWidth = Texture->GetSizeX();
-					const int32 PHeight = Texture->GetSizeY();
 					const EPixelFormat PixelFormat = Texture->GetPixelFormat();
-
-					for (int32 Y = 0; Y < Resolution.Y; ++Y)
+					if (PixelFormat == PF_B8G8R8A8 || PixelFormat == PF_G8)
 					{
-						float V = (float)Y / (float)Resolution.Y;
-						int32 TexY = FMath::Clamp(FMath::FloorToInt(V * PHeight), 0, PHeight - 1);
-
-						for (int32 X = 0; X < Resolution.X; ++X)
+						PopulateFromPixels(static_cast<const uint8*>(RawTextureData), Texture->GetSizeX(), Texture->GetSizeY(), PixelFormat == PF_G8);
+					}
+					else
+					{
+						// Unsupported platform formats resolve to black for every cell
+						uint8 BlackPixel[8];
+						EncodePixel(FLinearColor::Black, BlackPixel);
+						Storage.FillRows([this, &BlackPixel, BytesPerPixel](int32 Y, uint8* OutRow)
 						{
-							float U = (float)X / (float)Resolution.X;
-							int32 TexX = FMath::Clamp(FMath::FloorToInt(U * PWidth), 0, PWidth - 1);
-							
-							FLinearColor PixelColor = FLinearColor::Black;
-							
-							if (PixelFormat == PF_B8G8R8A8)
-							{
-								const FColor* FormattedData = static_cast<const FColor*>(RawTextureData);
-								FColor RawColor = FormattedData[TexY * PWidth + TexX];
-								PixelColor.R = RawColor.R / 255.0f;
-								PixelColor.G = RawColor.G / 255.0f;
-								PixelColor.B = RawColor.B / 255.0f;
-								PixelColor.A = RawColor.A / 255.0f;
-							}
-							else if (PixelFormat == PF_G8)
+							for (int32 X = 0; X < Resolution.X; ++X)
 							{
-								const uint8* ByteData = static_cast<const uint8*>(RawTextureData);
-								float Gray = ByteData[TexY * PWidth + TexX] / 255.0f;
-								PixelColor = FLinearColor(Gray, Gray, Gray, 1.0f);
+								FMemory::Memcpy(OutRow + X * BytesPerPixel, BlackPixel, BytesPerPixel);
 							}
-
-							SetValueAtPixel(FIntPoint(X, Y), PixelColor);
-						}
+						});
 					}
 					PlatformData->Mips[0].BulkData.Unlock();
 					bHasBeenInitializedFromTexture = true;
@@ -150,183 +104,680 @@ void UWorldDataLayer::Reinitialize(const FVector2D& InWorldGridSize)
 #endif
 	}
 
-	bIsDirty = true; // Mark dirty so it syncs to GPU
+	// Mark everything dirty so it syncs to GPU
+	TileDirtyBounds.Reset();
+	TileDirtyBounds.SetNum(Storage.GetNumTiles());
+	DirtyTiles.Reset();
+	MarkAllDirty();
 	LastReadbackTime = 0.0f;
 
 	// Initialize Spatial Index if configured
 	if (Config->SpatialOptimization.bBuildAccelerationStructure)
 	{
-		SpatialIndices.Empty();
-		for (const FLinearColor& ValueToTrack : Config->SpatialOptimization.ValuesToTrack)
+		RebuildSpatialIndices();
+	}
+}
+
+void UWorldDataLayer::RebuildSpatialIndices()
+{
+	SpatialIndices.Empty();
+	RangeIndices.Empty();
+	TMap<uint64, int32> SlotByKey;
+	TArray<FWorldLayerSpatialIndex*> Indices;
+	for (const FLinearColor& ValueToTrack : Config->SpatialOptimization.ValuesToTrack)
+	{
+		const uint64 Key = EncodeValueKey(ValueToTrack);
+		if (!SpatialIndices.Contains(Key))
 		{
-			SpatialIndices.Emplace(ValueToTrack, MakeShared<FQuadtree>(FBox2D(FVector2D(0, 0), FVector2D(Resolution.X, Resolution.Y))));
+			const TSharedPtr<FWorldLayerSpatialIndex>& Index = SpatialIndices.Add(Key, FWorldLayerSpatialIndex::Create(Config->SpatialOptimization.StructureType, Resolution));
+			SlotByKey.Add(Key, Indices.Add(Index.Get()));
 		}
+	}
+
+	// Range indices take the slots after the value indices
+	const int32 FirstRangeSlot = Indices.Num();
+	const TArray<FWorldDataLayerTrackedRange>& Ranges = Config->SpatialOptimization.RangesToTrack;
+	ensureMsgf(Ranges.Num() <= 64, TEXT("Layer %s tracks %d ranges; only the first 64 are indexed."), *Config->LayerName.ToString(), Ranges.Num());
+	for (int32 RangeIndex = 0; RangeIndex < FMath::Min(Ranges.Num(), 64); ++RangeIndex)
+	{
+		Indices.Add(RangeIndices.Add_GetRef(FWorldLayerSpatialIndex::Create(Config->SpatialOptimization.StructureType, Resolution)).Get());
+	}
+	if (Indices.IsEmpty())
+	{
+		return;
+	}
+
+	const int32* DefaultSlotPtr = SlotByKey.Find(GetPixelKey(Storage.GetDefaultPixel()));
+	const int32 DefaultSlot = DefaultSlotPtr ? *DefaultSlotPtr : INDEX_NONE;
+	const uint64 DefaultRangeMask = GetRangeMask(Storage.GetDefaultPixel());
+	const FIntPoint NumTiles = Storage.GetNumTilesXY();
+
+	// Classify one tile row per task into per-index point lists
+	TArray<TArray<TArray<FIntPoint>>> BandPoints;
+	BandPoints.SetNum(NumTiles.Y);
+	ParallelFor(NumTiles.Y, [&](int32 TileY)
+	{
+		TArray<TArray<FIntPoint>>& Points = BandPoints[TileY];
+		Points.SetNum(Indices.Num());
 
-		for (int32 Y = 0; Y < Resolution.Y; ++Y)
+		// Neighbouring cells mostly repeat values, so remember the ranges of the last value instead of decoding every cell
+		uint64 LastKey = GetPixelKey(Storage.GetDefaultPixel());
+		uint64 LastRangeMask = DefaultRangeMask;
+
+		for (int32 TileX = 0; TileX < NumTiles.X; ++TileX)
 		{
-			for (int32 X = 0; X < Resolution.X; ++X)
+			const int32 TileIndex = TileY * NumTiles.X + TileX;
+			if (DefaultSlot == INDEX_NONE && DefaultRangeMask == 0 && !Storage.IsTileAllocated(TileIndex))
 			{
-				FIntPoint PixelCoords(X, Y);
-				FLinearColor PixelValue = GetValueAtPixel(PixelCoords);
-				for (const auto& Elem : SpatialIndices)
+				continue;
+			}
+
+			const FIntRect TileRect = Storage.GetTileRect(TileIndex);
+			for (int32 Y = TileRect.Min.Y; Y < TileRect.Max.Y; ++Y)
+			{
+				for (int32 X = TileRect.Min.X; X < TileRect.Max.X; ++X)
 				{
-					if (PixelValue.Equals(Elem.Key, KINDA_SMALL_NUMBER))
+					const uint8* Pixel = Storage.GetPixel(X, Y);
+					const uint64 Key = GetPixelKey(Pixel);
+					if (const int32* Slot = SlotByKey.Find(Key))
 					{
-						Elem.Value->Insert(PixelCoords);
-						break;
+						Points[*Slot].Add(FIntPoint(X, Y));
+					}
+
+					if (RangeIndices.IsEmpty())
+					{
+						continue;
+					}
+					if (Key != LastKey)
+					{
+						LastKey = Key;
+						LastRangeMask = GetRangeMask(Pixel);
+					}
+					for (uint64 Mask = LastRangeMask; Mask != 0; Mask &= Mask - 1)
+					{
+						Points[FirstRangeSlot + FMath::CountTrailingZeros64(Mask)].Add(FIntPoint(X, Y));
 					}
 				}
 			}
 		}
-	}
+	});
+
+	// Each index is independent, so they are built in parallel as well
+	ParallelFor(Indices.Num(), [&](int32 Slot)
+	{
+		TArray<FIntPoint> Points;
+		int32 NumPoints = 0;
+		for (const TArray<TArray<FIntPoint>>& Band : BandPoints)
+		{
+			NumPoints += Band[Slot].Num();
+		}
+		Points.Reserve(NumPoints);
+		for (const TArray<TArray<FIntPoint>>& Band : BandPoints)
+		{
+			Points.Append(Band[Slot]);
+		}
+		Indices[Slot]->Build(Points);
+	});
 }
 
-FLinearColor UWorldDataLayer::GetValueAtPixel(const FIntPoint& PixelCoords) const
+/** Lookup from an 8-bit unorm to half, matching FFloat16(Byte / 255.0f). */
+struct FUnormToHalfTable
 {
-	// CRITICAL: Check bounds before calculating index to prevent row-wrapping
-	if (PixelCoords.X < 0 || PixelCoords.X >= Resolution.X || PixelCoords.Y < 0 || PixelCoords.Y >= Resolution.Y)
+	FFloat16 Values[256];
+
+	FUnormToHalfTable()
 	{
-		return Config->DefaultValue;
+		for (int32 Index = 0; Index < 256; ++Index)
+		{
+			Values[Index] = FFloat16(Index / 255.0f);
+		}
 	}
 
-	int32 PixelIndex = GetPixelIndex(PixelCoords);
-	if (!RawData.IsValidIndex(PixelIndex))
+	static const FUnormToHalfTable& Get()
 	{
-		return Config->DefaultValue;
+		static const FUnormToHalfTable Table;
+		return Table;
 	}
+};
+
+/**
+ * Converts a contiguous run of BGRA8 texels into the layer format. The byte formats are plain swizzles and the
+ * half formats go through the lookup table, so every loop is branch-free and left to the compiler to vectorize.
+ */
+template<EDataFormat Format>
+static void ConvertBGRA8Row(const uint8* Src, int32 Num, uint8* Dest)
+{
+	const FColor* Texels = reinterpret_cast<const FColor*>(Src);
+	if constexpr (Format == EDataFormat::R8)
+	{
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Dest[Index] = Texels[Index].R;
+		}
+	}
+	else if constexpr (Format == EDataFormat::RGBA8)
+	{
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Dest[Index * 4 + 0] = Texels[Index].R;
+			Dest[Index * 4 + 1] = Texels[Index].G;
+			Dest[Index * 4 + 2] = Texels[Index].B;
+			Dest[Index * 4 + 3] = Texels[Index].A;
+		}
+	}
+	else if constexpr (Format == EDataFormat::R16F)
+	{
+		const FFloat16* Half = FUnormToHalfTable::Get().Values;
+		FFloat16* Out = reinterpret_cast<FFloat16*>(Dest);
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Out[Index] = Half[Texels[Index].R];
+		}
+	}
+	else // RGBA16F
+	{
+		const FFloat16* Half = FUnormToHalfTable::Get().Values;
+		FFloat16* Out = reinterpret_cast<FFloat16*>(Dest);
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Out[Index * 4 + 0] = Half[Texels[Index].R];
+			Out[Index * 4 + 1] = Half[Texels[Index].G];
+			Out[Index * 4 + 2] = Half[Texels[Index].B];
+			Out[Index * 4 + 3] = Half[Texels[Index].A];
+		}
+	}
+}
 
-	int32 BytesPerPixel = GetBytesPerPixel();
+/** Converts a contiguous run of G8 texels into the layer format. Gray expands to (Gray, Gray, Gray, 1). */
+template<EDataFormat Format>
+static void ConvertG8Row(const uint8* Src, int32 Num, uint8* Dest)
+{
+	if constexpr (Format == EDataFormat::R8)
+	{
+		FMemory::Memcpy(Dest, Src, Num);
+	}
+	else if constexpr (Format == EDataFormat::RGBA8)
+	{
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Dest[Index * 4 + 0] = Src[Index];
+			Dest[Index * 4 + 1] = Src[Index];
+			Dest[Index * 4 + 2] = Src[Index];
+			Dest[Index * 4 + 3] = 255;
+		}
+	}
+	else if constexpr (Format == EDataFormat::R16F)
+	{
+		const FFloat16* Half = FUnormToHalfTable::Get().Values;
+		FFloat16* Out = reinterpret_cast<FFloat16*>(Dest);
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Out[Index] = Half[Src[Index]];
+		}
+	}
+	else // RGBA16F
+	{
+		const FFloat16* Half = FUnormToHalfTable::Get().Values;
+		const FFloat16 One = Half[255];
+		FFloat16* Out = reinterpret_cast<FFloat16*>(Dest);
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Out[Index * 4 + 0] = Half[Src[Index]];
+			Out[Index * 4 + 1] = Half[Src[Index]];
+			Out[Index * 4 + 2] = Half[Src[Index]];
+			Out[Index * 4 + 3] = One;
+		}
+	}
+}
 
-	FLinearColor Result = FLinearColor::Black;
+template<EDataFormat Format>
+static auto GetRowConverter(bool bGrayscale)
+{
+	return bGrayscale ? &ConvertG8Row<Format> : &ConvertBGRA8Row<Format>;
+}
+
+void UWorldDataLayer::PopulateFromPixels(const uint8* SrcData, int32 SrcWidth, int32 SrcHeight, bool bGrayscale)
+{
+	if (!SrcData || SrcWidth <= 0 || SrcHeight <= 0)
+	{
+		return;
+	}
 
+	void (*ConvertRow)(const uint8*, int32, uint8*) = nullptr;
 	switch (Config->DataFormat)
 	{
-		case EDataFormat::R8:
-			Result = FLinearColor(RawData[PixelIndex] / 255.0f, 0.0f, 0.0f, 0.0f);
-			break;
 		case EDataFormat::R16F:
-			Result = FLinearColor(*((FFloat16*)&RawData[PixelIndex]), 0.0f, 0.0f, 0.0f);
+			ConvertRow = GetRowConverter<EDataFormat::R16F>(bGrayscale);
 			break;
 		case EDataFormat::RGBA8:
-			Result = FLinearColor(
-				RawData[PixelIndex] / 255.0f,
-				RawData[PixelIndex + 1] / 255.0f,
-				RawData[PixelIndex + 2] / 255.0f,
-				RawData[PixelIndex + 3] / 255.0f
-			);
+			ConvertRow = GetRowConverter<EDataFormat::RGBA8>(bGrayscale);
 			break;
 		case EDataFormat::RGBA16F:
-			Result = FLinearColor(
-				*((FFloat16*)&RawData[PixelIndex]),
-				*((FFloat16*)&RawData[PixelIndex + 2]),
-				*((FFloat16*)&RawData[PixelIndex + 4]),
-				*((FFloat16*)&RawData[PixelIndex + 6])
-			);
+			ConvertRow = GetRowConverter<EDataFormat::RGBA16F>(bGrayscale);
+			break;
+		case EDataFormat::R8:
+		default:
+			ConvertRow = GetRowConverter<EDataFormat::R8>(bGrayscale);
 			break;
 	}
 
-	return Result;
+	// Nearest-neighbour column mapping, computed once with the same float math the per-cell loop used.
+	const int32 SrcBytesPerPixel = bGrayscale ? 1 : 4;
+	const int32 DestBytesPerPixel = GetBytesPerPixel();
+	TArray<int32> SrcColumns;
+	SrcColumns.SetNumUninitialized(Resolution.X);
+	bool bIdentityColumns = SrcWidth == Resolution.X;
+	for (int32 X = 0; X < Resolution.X; ++X)
+	{
+		const float U = (float)X / (float)Resolution.X;
+		SrcColumns[X] = FMath::Clamp(FMath::FloorToInt(U * SrcWidth), 0, SrcWidth - 1);
+		bIdentityColumns &= SrcColumns[X] == X;
+	}
+
+	Storage.FillRows([&](int32 Y, uint8* OutRow)
+	{
+		const float V = (float)Y / (float)Resolution.Y;
+		const int32 SrcY = FMath::Clamp(FMath::FloorToInt(V * SrcHeight), 0, SrcHeight - 1);
+		const uint8* SrcRow = SrcData + (int64)SrcY * SrcWidth * SrcBytesPerPixel;
+
+		if (bIdentityColumns)
+		{
+			ConvertRow(SrcRow, Resolution.X, OutRow);
+			return;
+		}
+
+		// Resampled rows are gathered into a small contiguous chunk first so the conversion stays a straight loop.
+		constexpr int32 ChunkSize = 256;
+		uint8 Gathered[ChunkSize * 4];
+		for (int32 ChunkStart = 0; ChunkStart < Resolution.X; ChunkStart += ChunkSize)
+		{
+			const int32 ChunkNum = FMath::Min(ChunkSize, Resolution.X - ChunkStart);
+			for (int32 Index = 0; Index < ChunkNum; ++Index)
+			{
+				FMemory::Memcpy(Gathered + Index * SrcBytesPerPixel, SrcRow + SrcColumns[ChunkStart + Index] * SrcBytesPerPixel, SrcBytesPerPixel);
+			}
+			ConvertRow(Gathered, ChunkNum, OutRow + ChunkStart * DestBytesPerPixel);
+		}
+	});
+}
+
+FLinearColor UWorldDataLayer::GetValueAtPixel(const FIntPoint& PixelCoords) const
+{
+	// CRITICAL: Check bounds before calculating index to prevent row-wrapping
+	if (!IsValidPixel(PixelCoords))
+	{
+		return Config->DefaultValue;
+	}
+
+	return DecodePixel(Storage.GetPixel(PixelCoords.X, PixelCoords.Y));
 }
 
 void UWorldDataLayer::SetValueAtPixel(const FIntPoint& PixelCoords, const FLinearColor& NewValue)
 {
-	if (!RawData.IsValidIndex(GetPixelIndex(PixelCoords)))
+	if (!IsValidPixel(PixelCoords))
 	{
 		return; // Out of bounds
 	}
 
 	const bool bShouldUpdateIndex = Config->SpatialOptimization.bBuildAccelerationStructure && !SpatialIndices.IsEmpty();
-	FLinearColor OldValue = FLinearColor::Black;
 
-	if (bShouldUpdateIndex)
+	const bool bShouldUpdateRanges = Config->SpatialOptimization.bBuildAccelerationStructure && !RangeIndices.IsEmpty();
+
+	// --- Modify the stored data ---
+	uint8 EncodedValue[8];
+	EncodePixel(NewValue, EncodedValue);
+	const uint8* OldPixel = Storage.GetPixel(PixelCoords.X, PixelCoords.Y);
+	const uint64 OldKey = GetPixelKey(OldPixel);
+	const uint64 OldRangeMask = bShouldUpdateRanges ? GetRangeMask(OldPixel) : 0;
+	if (!Storage.SetPixel(PixelCoords.X, PixelCoords.Y, EncodedValue))
 	{
-		OldValue = GetValueAtPixel(PixelCoords);
-		// A simple check is not sufficient due to data format quantization. We must proceed.
+		return; // Already held this value: nothing to index, upload or derive
 	}
 
-	// --- Modify the Raw Data ---
-	int32 PixelIndex = GetPixelIndex(PixelCoords);
+	// --- Update Spatial Indices by the exact stored bytes ---
+	const uint64 NewKey = GetPixelKey(EncodedValue);
+	if (bShouldUpdateIndex && OldKey != NewKey)
+	{
+		// Remove the point from the quadtree for the OLD value, then add it to the quadtree for the NEW value.
+		if (FWorldLayerSpatialIndex* OldIndex = FindSpatialIndexForKey(OldKey))
+		{
+			OldIndex->Remove(PixelCoords);
+		}
+		if (FWorldLayerSpatialIndex* NewIndex = FindSpatialIndexForKey(NewKey))
+		{
+			NewIndex->Insert(PixelCoords);
+		}
+	}
+	if (bShouldUpdateRanges && OldKey != NewKey)
+	{
+		UpdateRangeIndices(PixelCoords, OldRangeMask, GetRangeMask(EncodedValue));
+	}
 
-	switch (Config->DataFormat)
+	if (!bIsInitializing)
 	{
-		case EDataFormat::R8:
-			RawData[PixelIndex] = FMath::RoundToInt(NewValue.R * 255.0f);
-			break;
-		case EDataFormat::R16F:
-			*((FFloat16*)&RawData[PixelIndex]) = FFloat16(NewValue.R);
-			break;
-		case EDataFormat::RGBA8:
-			RawData[PixelIndex] = FMath::RoundToInt(NewValue.R * 255.0f);
-			RawData[PixelIndex + 1] = FMath::RoundToInt(NewValue.G * 255.0f);
-			RawData[PixelIndex + 2] = FMath::RoundToInt(NewValue.B * 255.0f);
-			RawData[PixelIndex + 3] = FMath::RoundToInt(NewValue.A * 255.0f);
-			break;
-		case EDataFormat::RGBA16F:
-			*((FFloat16*)&RawData[PixelIndex]) = FFloat16(NewValue.R);
-			*((FFloat16*)&RawData[PixelIndex + 2]) = FFloat16(NewValue.G);
-			*((FFloat16*)&RawData[PixelIndex + 4]) = FFloat16(NewValue.B);
-			*((FFloat16*)&RawData[PixelIndex + 6]) = FFloat16(NewValue.A);
-			break;
+		MarkDirty(FIntRect(PixelCoords, PixelCoords + FIntPoint(1, 1)));
 	}
+}
+
+void UWorldDataLayer::SetValueAtPixels(TConstArrayView<FIntPoint> Pixels, const FLinearColor& NewValue)
+{
+	const int32 BytesPerPixel = GetBytesPerPixel();
+	uint8 EncodedValue[8];
+	EncodePixel(NewValue, EncodedValue);
+
+	const bool bShouldUpdateIndex = Config->SpatialOptimization.bBuildAccelerationStructure && !SpatialIndices.IsEmpty();
+	FWorldLayerSpatialIndex* NewIndex = bShouldUpdateIndex ? FindSpatialIndexForKey(GetPixelKey(EncodedValue)) : nullptr;
+	const bool bShouldUpdateRanges = Config->SpatialOptimization.bBuildAccelerationStructure && !RangeIndices.IsEmpty();
+	const uint64 NewRangeMask = bShouldUpdateRanges ? GetRangeMask(EncodedValue) : 0;
 
-	// --- Update Spatial Indices with Format-Aware Comparison ---
-	if (bShouldUpdateIndex)
+	FIntRect Bounds(MAX_int32, MAX_int32, MIN_int32, MIN_int32);
+	for (const FIntPoint& PixelCoords : Pixels)
 	{
-		// Remove the point from the quadtree for the OLD value.
-		for (const auto& Elem : SpatialIndices)
+		if (!IsValidPixel(PixelCoords))
 		{
-			bool bMatches = false;
-			switch(Config->DataFormat)
-			{
-				case EDataFormat::R8:
-				case EDataFormat::R16F:
-					// For single-channel formats, compare only the R channel.
-					bMatches = FMath::IsNearlyEqual(OldValue.R, Elem.Key.R);
-					break;
-				default:
-					// For multi-channel formats, the read-back OldValue is canonical.
-					bMatches = OldValue.Equals(Elem.Key, KINDA_SMALL_NUMBER);
-					break;
-			}
-			if (bMatches)
+			continue;
+		}
+
+		// Cells that already hold the value need neither a write nor an index update
+		const uint8* Stored = Storage.GetPixel(PixelCoords.X, PixelCoords.Y);
+		if (FMemory::Memcmp(Stored, EncodedValue, BytesPerPixel) == 0)
+		{
+			continue;
+		}
+
+		if (bShouldUpdateIndex)
+		{
+			FWorldLayerSpatialIndex* OldIndex = FindSpatialIndexForKey(GetPixelKey(Stored));
+			if (OldIndex != NewIndex)
 			{
-				Elem.Value->Remove(PixelCoords);
-				break;
+				if (OldIndex)
+				{
+					OldIndex->Remove(PixelCoords);
+				}
+				if (NewIndex)
+				{
+					NewIndex->Insert(PixelCoords);
+				}
 			}
 		}
+		if (bShouldUpdateRanges)
+		{
+			UpdateRangeIndices(PixelCoords, GetRangeMask(Stored), NewRangeMask);
+		}
+
+		Storage.SetPixel(PixelCoords.X, PixelCoords.Y, EncodedValue);
+		Bounds.Include(PixelCoords);
+	}
+
+	if (!bIsInitializing && Bounds.Min.X <= Bounds.Max.X)
+	{
+		MarkDirty(FIntRect(Bounds.Min, Bounds.Max + FIntPoint(1, 1)));
+	}
+}
 
-		// Add the point to the quadtree for the NEW value.
-		for (const auto& Elem : SpatialIndices)
+uint64 UWorldDataLayer::EncodeValueKey(const FLinearColor& Value) const
+{
+	uint8 EncodedValue[8];
+	EncodePixel(Value, EncodedValue);
+	return GetPixelKey(EncodedValue);
+}
+
+FWorldLayerSpatialIndex* UWorldDataLayer::FindSpatialIndexForKey(uint64 Key) const
+{
+	const TSharedPtr<FWorldLayerSpatialIndex>* Index = SpatialIndices.Find(Key);
+	return Index ? Index->Get() : nullptr;
+}
+
+FWorldLayerSpatialIndex* UWorldDataLayer::FindSpatialIndexForRange(FName RangeName) const
+{
+	const TArray<FWorldDataLayerTrackedRange>& Ranges = Config->SpatialOptimization.RangesToTrack;
+	for (int32 RangeIndex = 0; RangeIndex < RangeIndices.Num() && RangeIndex < Ranges.Num(); ++RangeIndex)
+	{
+		if (Ranges[RangeIndex].RangeName == RangeName)
 		{
-			bool bMatches = false;
-			switch(Config->DataFormat)
+			return RangeIndices[RangeIndex].Get();
+		}
+	}
+	return nullptr;
+}
+
+uint64 UWorldDataLayer::GetRangeMask(const uint8* Pixel) const
+{
+	const TArray<FWorldDataLayerTrackedRange>& Ranges = Config->SpatialOptimization.RangesToTrack;
+	const int32 NumRanges = FMath::Min(Ranges.Num(), 64);
+	if (NumRanges == 0)
+	{
+		return 0;
+	}
+
+	const FLinearColor Value = DecodePixel(Pixel);
+	uint64 Mask = 0;
+	for (int32 RangeIndex = 0; RangeIndex < NumRanges; ++RangeIndex)
+	{
+		Mask |= Ranges[RangeIndex].Contains(Value) ? (1ull << RangeIndex) : 0;
+	}
+	return Mask;
+}
+
+void UWorldDataLayer::UpdateRangeIndices(const FIntPoint& PixelCoords, uint64 OldMask, uint64 NewMask)
+{
+	for (uint64 Changed = OldMask ^ NewMask; Changed != 0; Changed &= Changed - 1)
+	{
+		const int32 RangeIndex = FMath::CountTrailingZeros64(Changed);
+		if (NewMask & (1ull << RangeIndex))
+		{
+			RangeIndices[RangeIndex]->Insert(PixelCoords);
+		}
+		else
+		{
+			RangeIndices[RangeIndex]->Remove(PixelCoords);
+		}
+	}
+}
+
+FWorldLayerSpatialIndexStats UWorldDataLayer::GetSpatialIndexStats() const
+{
+	FWorldLayerSpatialIndexStats Stats;
+	for (const TPair<uint64, TSharedPtr<FWorldLayerSpatialIndex>>& Pair : SpatialIndices)
+	{
+		Stats += Pair.Value->GetStats();
+	}
+	for (const TSharedPtr<FWorldLayerSpatialIndex>& Index : RangeIndices)
+	{
+		Stats += Index->GetStats();
+	}
+	return Stats;
+}
+
+void UWorldDataLayer::MarkDirty(const FIntRect& Rect)
+{
+	const FIntRect Clipped(Rect.Min.ComponentMax(FIntPoint::ZeroValue), Rect.Max.ComponentMin(Resolution));
+	if (Clipped.Width() <= 0 || Clipped.Height() <= 0)
+	{
+		return;
+	}
+
+	++Revision;
+	NotifyChangeObservers(Clipped);
+	if (bAllDirty)
+	{
+		return;
+	}
+
+	constexpr int32 Log2 = FWorldDataLayerTileStore::TileSizeLog2;
+	const int32 TilesPerRow = Storage.GetNumTilesXY().X;
+	for (int32 TileY = Clipped.Min.Y >> Log2; TileY <= (Clipped.Max.Y - 1) >> Log2; ++TileY)
+	{
+		for (int32 TileX = Clipped.Min.X >> Log2; TileX <= (Clipped.Max.X - 1) >> Log2; ++TileX)
+		{
+			const int32 TileIndex = TileY * TilesPerRow + TileX;
+			const FIntRect TileRect = Storage.GetTileRect(TileIndex);
+			const FIntRect Part(TileRect.Min.ComponentMax(Clipped.Min), TileRect.Max.ComponentMin(Clipped.Max));
+
+			FIntRect& Bounds = TileDirtyBounds[TileIndex];
+			if (Bounds.IsEmpty())
 			{
-				case EDataFormat::R8:
-				case EDataFormat::R16F:
-					// Compare the R channel of the incoming value with the tracked key's R channel.
-					bMatches = FMath::IsNearlyEqual(NewValue.R, Elem.Key.R);
-					break;
-				default:
-					bMatches = NewValue.Equals(Elem.Key, KINDA_SMALL_NUMBER);
-					break;
+				Bounds = Part;
+				DirtyTiles.Add(TileIndex);
 			}
-			if (bMatches)
+			else
 			{
-				Elem.Value->Insert(PixelCoords);
-				break;
+				Bounds.Min = Bounds.Min.ComponentMin(Part.Min);
+				Bounds.Max = Bounds.Max.ComponentMax(Part.Max);
 			}
 		}
 	}
+}
 
-	if (!bIsInitializing)
+void UWorldDataLayer::MarkAllDirty()
+{
+	++Revision;
+	bAllDirty = true;
+	NotifyChangeObservers(FIntRect(FIntPoint::ZeroValue, Resolution));
+}
+
+void UWorldDataLayer::WriteEncodedRect(const FIntRect& Rect, const uint8* Src, int32 SrcStride)
+{
+	const bool bShouldUpdateIndex = Config->SpatialOptimization.bBuildAccelerationStructure && !SpatialIndices.IsEmpty();
+	const bool bShouldUpdateRanges = Config->SpatialOptimization.bBuildAccelerationStructure && !RangeIndices.IsEmpty();
+	if (bShouldUpdateIndex || bShouldUpdateRanges)
 	{
-		bIsDirty = true;
+		// Move only the cells of Rect whose bytes change, before the write replaces the old ones
+		const int32 BytesPerPixel = GetBytesPerPixel();
+		const FIntRect Clipped(Rect.Min.ComponentMax(FIntPoint::ZeroValue), Rect.Max.ComponentMin(Resolution));
+		for (int32 Y = Clipped.Min.Y; Y < Clipped.Max.Y; ++Y)
+		{
+			const uint8* SrcRow = Src + (int64)(Y - Rect.Min.Y) * SrcStride;
+			for (int32 X = Clipped.Min.X; X < Clipped.Max.X; ++X)
+			{
+				const uint8* NewPixel = SrcRow + (X - Rect.Min.X) * BytesPerPixel;
+				const uint8* OldPixel = Storage.GetPixel(X, Y);
+				const uint64 OldKey = GetPixelKey(OldPixel);
+				const uint64 NewKey = GetPixelKey(NewPixel);
+				if (OldKey == NewKey)
+				{
+					continue;
+				}
+
+				const FIntPoint PixelCoords(X, Y);
+				if (bShouldUpdateIndex)
+				{
+					if (FWorldLayerSpatialIndex* OldIndex = FindSpatialIndexForKey(OldKey))
+					{
+						OldIndex->Remove(PixelCoords);
+					}
+					if (FWorldLayerSpatialIndex* NewIndex = FindSpatialIndexForKey(NewKey))
+					{
+						NewIndex->Insert(PixelCoords);
+					}
+				}
+				if (bShouldUpdateRanges)
+				{
+					UpdateRangeIndices(PixelCoords, GetRangeMask(OldPixel), GetRangeMask(NewPixel));
+				}
+			}
+		}
 	}
+
+	Storage.WriteRect(Rect, Src, SrcStride);
+	MarkDirty(Rect);
 }
 
-int32 UWorldDataLayer::GetPixelIndex(const FIntPoint& PixelCoords) const
+int32 UWorldDataLayer::AddChangeObserver()
 {
-	return (PixelCoords.Y * Resolution.X + PixelCoords.X) * GetBytesPerPixel();
+	return ObserverChangedBounds.Add(FIntRect(FIntPoint::ZeroValue, Resolution));
+}
+
+FIntRect UWorldDataLayer::ConsumeChangedBounds(int32 ObserverSlot)
+{
+	if (!ObserverChangedBounds.IsValidIndex(ObserverSlot))
+	{
+		return FIntRect();
+	}
+
+	const FIntRect Bounds = ObserverChangedBounds[ObserverSlot];
+	ObserverChangedBounds[ObserverSlot] = FIntRect();
+	return Bounds;
+}
+
+void UWorldDataLayer::RemoveChangeObserver(int32 ObserverSlot)
+{
+	if (ObserverChangedBounds.IsValidIndex(ObserverSlot))
+	{
+		ObserverChangedBounds.RemoveAt(ObserverSlot);
+	}
+}
+
+void UWorldDataLayer::NotifyChangeObservers(const FIntRect& Rect)
+{
+	for (FIntRect& Bounds : ObserverChangedBounds)
+	{
+		if (Bounds.IsEmpty())
+		{
+			Bounds = Rect;
+		}
+		else
+		{
+			Bounds.Min = Bounds.Min.ComponentMin(Rect.Min);
+			Bounds.Max = Bounds.Max.ComponentMax(Rect.Max);
+		}
+	}
+}
+
+void UWorldDataLayer::ConsumeDirtyRegions(TArray<FIntRect>& OutRegions)
+{
+	OutRegions.Reset();
+
+	if (!bAllDirty && DirtyTiles.Num() > 0)
+	{
+		// Sorting puts the tiles in row-major order, so horizontal neighbours end up next to each other.
+		DirtyTiles.Sort();
+
+		const int32 TilesPerRow = Storage.GetNumTilesXY().X;
+		int64 DirtyArea = 0;
+		int32 PrevTileIndex = INDEX_NONE;
+		for (const int32 TileIndex : DirtyTiles)
+		{
+			const FIntRect& Bounds = TileDirtyBounds[TileIndex];
+			DirtyArea += Bounds.Area();
+
+			const bool bContinuesRow = TileIndex == PrevTileIndex + 1 && TileIndex % TilesPerRow != 0;
+			PrevTileIndex = TileIndex;
+			if (bContinuesRow)
+			{
+				FIntRect& Last = OutRegions.Last();
+				const FIntRect Merged(Last.Min.ComponentMin(Bounds.Min), Last.Max.ComponentMax(Bounds.Max));
+				if (Merged.Area() <= 2 * (Last.Area() + Bounds.Area()))
+				{
+					Last = Merged;
+					continue;
+				}
+			}
+			OutRegions.Add(Bounds);
+		}
+
+		// Past half of the layer, a single upload is cheaper than many small ones.
+		if (DirtyArea * 2 >= (int64)Resolution.X * Resolution.Y)
+		{
+			bAllDirty = true;
+		}
+	}
+
+	if (bAllDirty)
+	{
+		OutRegions.Reset();
+		if (Resolution.X > 0 && Resolution.Y > 0)
+		{
+			OutRegions.Add(FIntRect(FIntPoint::ZeroValue, Resolution));
+		}
+	}
+
+	for (const int32 TileIndex : DirtyTiles)
+	{
+		TileDirtyBounds[TileIndex] = FIntRect();
+	}
+	DirtyTiles.Reset();
+	bAllDirty = false;
 }
 
 int32 UWorldDataLayer::GetBytesPerPixel() const
@@ -334,14 +785,68 @@ int32 UWorldDataLayer::GetBytesPerPixel() const
 	switch (Config->DataFormat)
 	{
 		case EDataFormat::R8:
-			return 1;
+			return TWorldLayerFormatTraits<EDataFormat::R8>::BytesPerPixel;
 		case EDataFormat::R16F:
-			return 2; // FFloat16 is 2 bytes
+			return TWorldLayerFormatTraits<EDataFormat::R16F>::BytesPerPixel;
 		case EDataFormat::RGBA8:
-			return 4;
+			return TWorldLayerFormatTraits<EDataFormat::RGBA8>::BytesPerPixel;
 		case EDataFormat::RGBA16F:
-			return 8; // 4 FFloat16s = 8 bytes
+			return TWorldLayerFormatTraits<EDataFormat::RGBA16F>::BytesPerPixel;
 		default:
 			return 0; // Should not happen
 	}
 }
+
+void UWorldDataLayer::EncodePixel(const FLinearColor& Value, uint8* OutPixel) const
+{
+	switch (Config->DataFormat)
+	{
+		case EDataFormat::R8:
+			TWorldLayerFormatTraits<EDataFormat::R8>::Encode(Value, OutPixel);
+			break;
+		case EDataFormat::R16F:
+			TWorldLayerFormatTraits<EDataFormat::R16F>::Encode(Value, OutPixel);
+			break;
+		case EDataFormat::RGBA8:
+			TWorldLayerFormatTraits<EDataFormat::RGBA8>::Encode(Value, OutPixel);
+			break;
+		case EDataFormat::RGBA16F:
+			TWorldLayerFormatTraits<EDataFormat::RGBA16F>::Encode(Value, OutPixel);
+			break;
+	}
+}
+
+FLinearColor UWorldDataLayer::DecodePixel(const uint8* Pixel) const
+{
+	switch (Config->DataFormat)
+	{
+		case EDataFormat::R8:
+			return TWorldLayerFormatTraits<EDataFormat::R8>::Decode(Pixel);
+		case EDataFormat::R16F:
+			return TWorldLayerFormatTraits<EDataFormat::R16F>::Decode(Pixel);
+		case EDataFormat::RGBA8:
+			return TWorldLayerFormatTraits<EDataFormat::RGBA8>::Decode(Pixel);
+		case EDataFormat::RGBA16F:
+			return TWorldLayerFormatTraits<EDataFormat::RGBA16F>::Decode(Pixel);
+		default:
+			return FLinearColor::Black;
+	}
+}
+
+void UWorldDataLayer::PublishSnapshot(const FWorldLayerPixelTransform& Transform, uint32 LayoutGeneration)
+{
+	if (!SnapshotChannel.IsValid())
+	{
+		return;
+	}
+
+	if (PublishedRevision == Revision && PublishedGeneration == Generation && PublishedLayoutGeneration == LayoutGeneration)
+	{
+		return;
+	}
+
+	SnapshotChannel->Publish(MakeShared<FWorldLayerSnapshot, ESPMode::ThreadSafe>(*this, Transform));
+	PublishedRevision = Revision;
+	PublishedGeneration = Generation;
+	PublishedLayoutGeneration = LayoutGeneration;
+}
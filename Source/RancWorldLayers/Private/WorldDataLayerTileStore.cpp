@@ -0,0 +1,265 @@
+#include "WorldDataLayerTileStore.h"
+#include "Async/ParallelFor.h"
+
+void FWorldDataLayerTileStore::Initialize(const FIntPoint& InResolution, int32 InBytesPerPixel, const uint8* DefaultPixel, bool bInSparse)
+{
+	Reset();
+
+	Resolution = FIntPoint(FMath::Max(InResolution.X, 0), FMath::Max(InResolution.Y, 0));
+	BytesPerPixel = InBytesPerPixel;
+	bSparse = bInSparse;
+	NumTiles = FIntPoint(FMath::DivideAndRoundUp(Resolution.X, TileSize), FMath::DivideAndRoundUp(Resolution.Y, TileSize));
+	TileBytes = PixelsPerTile * BytesPerPixel;
+
+	// Build the constant tile with a pattern fill: seed one pixel, then keep doubling the filled prefix.
+	DefaultTile = MakeShared<FWorldDataLayerTileBuffer, ESPMode::ThreadSafe>();
+	DefaultTile->SetNumUninitialized(TileBytes);
+	uint8* Pattern = DefaultTile->GetData();
+	FMemory::Memcpy(Pattern, DefaultPixel, BytesPerPixel);
+	for (int32 Filled = BytesPerPixel; Filled < TileBytes; Filled *= 2)
+	{
+		FMemory::Memcpy(Pattern + Filled, Pattern, FMath::Min(Filled, TileBytes - Filled));
+	}
+
+	const int32 TileCount = GetNumTiles();
+	OwnedTiles.SetNum(TileCount);
+	TileData.Init(DefaultTile->GetData(), TileCount);
+
+	if (!bSparse)
+	{
+		// Every tile is an independent allocation, so dense layers copy the pattern in parallel.
+		ParallelFor(TileCount, [this](int32 TileIndex)
+		{
+			OwnedTiles[TileIndex] = MakeShared<FWorldDataLayerTileBuffer, ESPMode::ThreadSafe>(*DefaultTile);
+			TileData[TileIndex] = OwnedTiles[TileIndex]->GetData();
+		});
+		NumAllocatedTiles = TileCount;
+	}
+}
+
+void FWorldDataLayerTileStore::Reset()
+{
+	OwnedTiles.Empty();
+	TileData.Empty();
+	DefaultTile.Reset();
+	NumAllocatedTiles = 0;
+	Resolution = FIntPoint::ZeroValue;
+	NumTiles = FIntPoint::ZeroValue;
+}
+
+uint8* FWorldDataLayerTileStore::GetMutablePixel(int32 X, int32 Y)
+{
+	return GetWritableTile(GetTileIndex(X, Y)) + GetOffsetInTile(X, Y);
+}
+
+bool FWorldDataLayerTileStore::SetPixel(int32 X, int32 Y, const uint8* Pixel)
+{
+	const int32 TileIndex = GetTileIndex(X, Y);
+	if (FMemory::Memcmp(TileData[TileIndex] + GetOffsetInTile(X, Y), Pixel, BytesPerPixel) == 0)
+	{
+		return false;
+	}
+
+	FMemory::Memcpy(GetWritableTile(TileIndex) + GetOffsetInTile(X, Y), Pixel, BytesPerPixel);
+	return true;
+}
+
+void FWorldDataLayerTileStore::CopyRect(const FIntRect& Rect, uint8* Dest, int32 DestStride) const
+{
+	for (int32 Y = Rect.Min.Y; Y < Rect.Max.Y; ++Y)
+	{
+		uint8* DestRow = Dest + (Y - Rect.Min.Y) * DestStride;
+		int32 X = Rect.Min.X;
+		while (X < Rect.Max.X)
+		{
+			// Copy the run of this row that lies inside one tile.
+			const int32 RunEnd = FMath::Min((X | TileMask) + 1, Rect.Max.X);
+			const int32 RunBytes = (RunEnd - X) * BytesPerPixel;
+			FMemory::Memcpy(DestRow + (X - Rect.Min.X) * BytesPerPixel, GetPixel(X, Y), RunBytes);
+			X = RunEnd;
+		}
+	}
+}
+
+void FWorldDataLayerTileStore::WriteRect(const FIntRect& Rect, const uint8* Src, int32 SrcStride)
+{
+	const FIntRect Clipped(Rect.Min.ComponentMax(FIntPoint::ZeroValue), Rect.Max.ComponentMin(Resolution));
+	if (Clipped.Width() <= 0 || Clipped.Height() <= 0)
+	{
+		return;
+	}
+
+	const int32 FirstTileX = Clipped.Min.X >> TileSizeLog2;
+	const int32 FirstTileY = Clipped.Min.Y >> TileSizeLog2;
+	const int32 LastTileX = (Clipped.Max.X - 1) >> TileSizeLog2;
+	const int32 LastTileY = (Clipped.Max.Y - 1) >> TileSizeLog2;
+
+	for (int32 TileY = FirstTileY; TileY <= LastTileY; ++TileY)
+	{
+		for (int32 TileX = FirstTileX; TileX <= LastTileX; ++TileX)
+		{
+			const int32 TileIndex = TileY * NumTiles.X + TileX;
+			const FIntRect TileRect = GetTileRect(TileIndex);
+			const FIntRect Part(TileRect.Min.ComponentMax(Clipped.Min), TileRect.Max.ComponentMin(Clipped.Max));
+			const int32 PartBytes = Part.Width() * BytesPerPixel;
+
+			auto GetSrcRow = [&](int32 Y)
+			{
+				return Src + (Y - Rect.Min.Y) * SrcStride + (Part.Min.X - Rect.Min.X) * BytesPerPixel;
+			};
+
+			if (!IsTileAllocated(TileIndex))
+			{
+				bool bAllDefault = true;
+				for (int32 Y = Part.Min.Y; Y < Part.Max.Y && bAllDefault; ++Y)
+				{
+					bAllDefault = IsDefaultRow(GetSrcRow(Y), Part.Width());
+				}
+				if (bAllDefault)
+				{
+					continue;
+				}
+			}
+
+			uint8* Tile = GetWritableTile(TileIndex);
+			for (int32 Y = Part.Min.Y; Y < Part.Max.Y; ++Y)
+			{
+				FMemory::Memcpy(Tile + GetOffsetInTile(Part.Min.X, Y), GetSrcRow(Y), PartBytes);
+			}
+		}
+	}
+}
+
+void FWorldDataLayerTileStore::FillRows(TFunctionRef<void(int32 Y, uint8* OutRow)> RowWriter)
+{
+	const int32 RowBytes = Resolution.X * BytesPerPixel;
+
+	// Each band covers one row of tiles, so bands never touch the same tile and can run in parallel.
+	ParallelFor(NumTiles.Y, [&](int32 TileY)
+	{
+		const int32 FirstRow = TileY * TileSize;
+		const int32 NumRows = FMath::Min(TileSize, Resolution.Y - FirstRow);
+
+		TArray<uint8> Band;
+		Band.SetNumUninitialized(NumRows * RowBytes);
+		for (int32 Row = 0; Row < NumRows; ++Row)
+		{
+			RowWriter(FirstRow + Row, Band.GetData() + Row * RowBytes);
+		}
+
+		for (int32 TileX = 0; TileX < NumTiles.X; ++TileX)
+		{
+			const int32 TileIndex = TileY * NumTiles.X + TileX;
+			const int32 FirstColumn = TileX * TileSize;
+			const int32 NumColumns = FMath::Min(TileSize, Resolution.X - FirstColumn);
+			const uint8* BandTile = Band.GetData() + FirstColumn * BytesPerPixel;
+
+			if (bSparse)
+			{
+				bool bAllDefault = true;
+				for (int32 Row = 0; Row < NumRows && bAllDefault; ++Row)
+				{
+					bAllDefault = IsDefaultRow(BandTile + Row * RowBytes, NumColumns);
+				}
+				if (bAllDefault)
+				{
+					OwnedTiles[TileIndex].Reset();
+					TileData[TileIndex] = DefaultTile->GetData();
+					continue;
+				}
+			}
+
+			FWorldDataLayerTileRef& Tile = OwnedTiles[TileIndex];
+			if (!Tile.IsValid() || !Tile.IsUnique())
+			{
+				// The whole tile is overwritten, so a fresh copy of the default tile is enough. It also keeps
+				// edge tiles at the default value outside the layer resolution.
+				Tile = MakeShared<FWorldDataLayerTileBuffer, ESPMode::ThreadSafe>(*DefaultTile);
+			}
+			TileData[TileIndex] = Tile->GetData();
+
+			for (int32 Row = 0; Row < NumRows; ++Row)
+			{
+				FMemory::Memcpy(Tile->GetData() + ((Row << TileSizeLog2) * BytesPerPixel), BandTile + Row * RowBytes, NumColumns * BytesPerPixel);
+			}
+		}
+	});
+
+	NumAllocatedTiles = CountAllocatedTiles();
+}
+
+int32 FWorldDataLayerTileStore::Compact()
+{
+	if (!bSparse)
+	{
+		return 0;
+	}
+
+	int32 NumReleased = 0;
+	for (int32 TileIndex = 0; TileIndex < OwnedTiles.Num(); ++TileIndex)
+	{
+		if (IsTileAllocated(TileIndex) && FMemory::Memcmp(OwnedTiles[TileIndex]->GetData(), DefaultTile->GetData(), TileBytes) == 0)
+		{
+			ReleaseTile(TileIndex);
+			++NumReleased;
+		}
+	}
+	return NumReleased;
+}
+
+FIntRect FWorldDataLayerTileStore::GetTileRect(int32 TileIndex) const
+{
+	const FIntPoint Min((TileIndex % NumTiles.X) * TileSize, (TileIndex / NumTiles.X) * TileSize);
+	return FIntRect(Min, (Min + FIntPoint(TileSize, TileSize)).ComponentMin(Resolution));
+}
+
+SIZE_T FWorldDataLayerTileStore::GetAllocatedSize() const
+{
+	return (SIZE_T)(NumAllocatedTiles + 1) * TileBytes + OwnedTiles.GetAllocatedSize() + TileData.GetAllocatedSize();
+}
+
+void FWorldDataLayerTileStore::AllocateTile(int32 TileIndex)
+{
+	OwnedTiles[TileIndex] = MakeShared<FWorldDataLayerTileBuffer, ESPMode::ThreadSafe>(*DefaultTile);
+	TileData[TileIndex] = OwnedTiles[TileIndex]->GetData();
+	++NumAllocatedTiles;
+}
+
+void FWorldDataLayerTileStore::ReleaseTile(int32 TileIndex)
+{
+	OwnedTiles[TileIndex].Reset();
+	TileData[TileIndex] = DefaultTile->GetData();
+	--NumAllocatedTiles;
+}
+
+uint8* FWorldDataLayerTileStore::GetWritableTile(int32 TileIndex)
+{
+	FWorldDataLayerTileRef& Tile = OwnedTiles[TileIndex];
+	if (!Tile.IsValid())
+	{
+		AllocateTile(TileIndex);
+	}
+	else if (!Tile.IsUnique())
+	{
+		// A read snapshot still holds this tile; detach before writing.
+		Tile = MakeShared<FWorldDataLayerTileBuffer, ESPMode::ThreadSafe>(*Tile);
+		TileData[TileIndex] = Tile->GetData();
+	}
+	return TileData[TileIndex];
+}
+
+bool FWorldDataLayerTileStore::IsDefaultRow(const uint8* Row, int32 NumPixels) const
+{
+	// DefaultTile holds at least one full row of default pixels, so a single compare covers the run.
+	return FMemory::Memcmp(Row, DefaultTile->GetData(), NumPixels * BytesPerPixel) == 0;
+}
+
+int32 FWorldDataLayerTileStore::CountAllocatedTiles() const
+{
+	int32 Count = 0;
+	for (const FWorldDataLayerTileRef& Tile : OwnedTiles)
+	{
+		Count += Tile.IsValid() ? 1 : 0;
+	}
+	return Count;
+}
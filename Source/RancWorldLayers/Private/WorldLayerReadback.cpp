@@ -0,0 +1,85 @@
+#include "WorldLayerReadback.h"
+#include "WorldLayerAccessor.h"
+
+EPixelFormat FWorldLayerGpuFormat::GetPixelFormat(EDataFormat DataFormat)
+{
+	switch (DataFormat)
+	{
+		case EDataFormat::R8: return PF_G8;
+		case EDataFormat::R16F: return PF_R16F;
+		case EDataFormat::RGBA8: return PF_B8G8R8A8;
+		case EDataFormat::RGBA16F: return PF_FloatRGBA;
+		default: return PF_Unknown;
+	}
+}
+
+int32 FWorldLayerGpuFormat::GetBytesPerTexel(EDataFormat DataFormat)
+{
+	switch (DataFormat)
+	{
+		case EDataFormat::R8: return TWorldLayerFormatTraits<EDataFormat::R8>::BytesPerPixel;
+		case EDataFormat::R16F: return TWorldLayerFormatTraits<EDataFormat::R16F>::BytesPerPixel;
+		case EDataFormat::RGBA8: return TWorldLayerFormatTraits<EDataFormat::RGBA8>::BytesPerPixel;
+		case EDataFormat::RGBA16F: return TWorldLayerFormatTraits<EDataFormat::RGBA16F>::BytesPerPixel;
+		default: return 0;
+	}
+}
+
+/** Swaps bytes 0 and 2 of each 4-byte texel, RGBA8 <-> BGRA8. Src and Dst may be the same. */
+static void SwapRedBlue(const uint8* Src, uint8* Dst, int64 NumTexels)
+{
+	for (int64 Index = 0; Index < NumTexels; ++Index)
+	{
+		const uint8 Red = Src[Index * 4];
+		Dst[Index * 4] = Src[Index * 4 + 2];
+		Dst[Index * 4 + 1] = Src[Index * 4 + 1];
+		Dst[Index * 4 + 2] = Red;
+		Dst[Index * 4 + 3] = Src[Index * 4 + 3];
+	}
+}
+
+void FWorldLayerGpuFormat::ConvertFromGpu(EDataFormat DataFormat, const uint8* Src, int64 SrcPitch, const FIntPoint& Size, uint8* Dst, int64 DstStride)
+{
+	const int64 RowBytes = (int64)Size.X * GetBytesPerTexel(DataFormat);
+	for (int32 Y = 0; Y < Size.Y; ++Y)
+	{
+		const uint8* SrcRow = Src + Y * SrcPitch;
+		uint8* DstRow = Dst + Y * DstStride;
+		if (DataFormat == EDataFormat::RGBA8)
+		{
+			SwapRedBlue(SrcRow, DstRow, Size.X);
+		}
+		else
+		{
+			FMemory::Memcpy(DstRow, SrcRow, RowBytes);
+		}
+	}
+}
+
+void FWorldLayerGpuFormat::ConvertToGpu(EDataFormat DataFormat, uint8* Data, int64 NumCells)
+{
+	if (NeedsConversion(DataFormat))
+	{
+		SwapRedBlue(Data, Data, NumCells);
+	}
+}
+
+FLinearColor FWorldLayerReadbackResult::GetValue(const FIntPoint& Pixel) const
+{
+	check(Rect.Contains(Pixel));
+	// A failed readback carries no cells
+	if (!bSucceeded)
+	{
+		return FLinearColor::Black;
+	}
+	const int32 BytesPerPixel = FWorldLayerGpuFormat::GetBytesPerTexel(DataFormat);
+	const uint8* Cell = Data.GetData() + ((int64)(Pixel.Y - Rect.Min.Y) * Rect.Width() + (Pixel.X - Rect.Min.X)) * BytesPerPixel;
+	switch (DataFormat)
+	{
+		case EDataFormat::R8: return TWorldLayerFormatTraits<EDataFormat::R8>::Decode(Cell);
+		case EDataFormat::R16F: return TWorldLayerFormatTraits<EDataFormat::R16F>::Decode(Cell);
+		case EDataFormat::RGBA8: return TWorldLayerFormatTraits<EDataFormat::RGBA8>::Decode(Cell);
+		case EDataFormat::RGBA16F: return TWorldLayerFormatTraits<EDataFormat::RGBA16F>::Decode(Cell);
+		default: return FLinearColor::Black;
+	}
+}
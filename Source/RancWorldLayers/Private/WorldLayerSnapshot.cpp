@@ -0,0 +1,237 @@
+#include "WorldLayerSnapshot.h"
+#include "WorldDataLayer.h"
+
+/** Releases the calling thread's epoch record when the thread exits, so pooled and short-lived threads reuse records. */
+struct FWorldLayerThreadRecordOwner
+{
+	FWorldLayerEpochDomain::FThreadRecord* Record = nullptr;
+
+	~FWorldLayerThreadRecordOwner()
+	{
+		if (Record)
+		{
+			Record->Epoch.store(0, std::memory_order_release);
+			Record->bInUse.store(false, std::memory_order_release);
+		}
+	}
+};
+
+FWorldLayerEpochDomain& FWorldLayerEpochDomain::Get()
+{
+	static FWorldLayerEpochDomain Domain;
+	return Domain;
+}
+
+FWorldLayerEpochDomain::~FWorldLayerEpochDomain()
+{
+	// Nothing can read anymore once the domain is torn down.
+	for (FRetired& Entry : Retired)
+	{
+		Entry.Deleter();
+	}
+	Retired.Empty();
+
+	FThreadRecord* Record = Records.exchange(nullptr);
+	while (Record)
+	{
+		FThreadRecord* Next = Record->Next;
+		delete Record;
+		Record = Next;
+	}
+}
+
+FWorldLayerEpochDomain::FThreadRecord& FWorldLayerEpochDomain::GetThreadRecord()
+{
+	static thread_local FWorldLayerThreadRecordOwner Owner;
+	if (Owner.Record)
+	{
+		return *Owner.Record;
+	}
+
+	// Reuse a record released by an exited thread before growing the list.
+	for (FThreadRecord* Record = Records.load(std::memory_order_acquire); Record; Record = Record->Next)
+	{
+		bool bExpected = false;
+		if (!Record->bInUse.load(std::memory_order_relaxed) && Record->bInUse.compare_exchange_strong(bExpected, true))
+		{
+			Owner.Record = Record;
+			return *Record;
+		}
+	}
+
+	FThreadRecord* NewRecord = new FThreadRecord();
+	NewRecord->bInUse.store(true, std::memory_order_relaxed);
+	FThreadRecord* Head = Records.load(std::memory_order_relaxed);
+	do
+	{
+		NewRecord->Next = Head;
+	}
+	while (!Records.compare_exchange_weak(Head, NewRecord, std::memory_order_release, std::memory_order_relaxed));
+
+	Owner.Record = NewRecord;
+	return *NewRecord;
+}
+
+void FWorldLayerEpochDomain::Enter()
+{
+	FThreadRecord& Record = GetThreadRecord();
+	if (Record.Depth++ == 0)
+	{
+		// Sequentially consistent so the record is visible before any shared pointer is loaded.
+		Record.Epoch.store(GlobalEpoch.load());
+	}
+}
+
+void FWorldLayerEpochDomain::Exit()
+{
+	FThreadRecord& Record = GetThreadRecord();
+	check(Record.Depth > 0);
+	if (--Record.Depth == 0)
+	{
+		Record.Epoch.store(0, std::memory_order_release);
+	}
+}
+
+void FWorldLayerEpochDomain::Retire(TUniqueFunction<void()>&& Deleter)
+{
+	// The object is already unreachable for new readers. Readers that started at or before this epoch may still hold it.
+	const uint64 RetireEpoch = GlobalEpoch.fetch_add(1);
+
+	FScopeLock Lock(&RetiredLock);
+	Retired.Add({RetireEpoch, MoveTemp(Deleter)});
+}
+
+uint64 FWorldLayerEpochDomain::GetOldestActiveEpoch() const
+{
+	uint64 Oldest = MAX_uint64;
+	for (FThreadRecord* Record = Records.load(std::memory_order_acquire); Record; Record = Record->Next)
+	{
+		const uint64 Epoch = Record->Epoch.load();
+		if (Epoch != 0)
+		{
+			Oldest = FMath::Min(Oldest, Epoch);
+		}
+	}
+	return Oldest;
+}
+
+int32 FWorldLayerEpochDomain::Reclaim()
+{
+	TArray<TUniqueFunction<void()>> Ready;
+	{
+		FScopeLock Lock(&RetiredLock);
+		if (Retired.IsEmpty())
+		{
+			return 0;
+		}
+
+		const uint64 OldestActive = GetOldestActiveEpoch();
+		for (int32 Index = Retired.Num() - 1; Index >= 0; --Index)
+		{
+			if (Retired[Index].Epoch < OldestActive)
+			{
+				Ready.Add(MoveTemp(Retired[Index].Deleter));
+				Retired.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			}
+		}
+	}
+
+	// Run outside the lock; deleters may release large tile buffers.
+	for (TUniqueFunction<void()>& Deleter : Ready)
+	{
+		Deleter();
+	}
+	return Ready.Num();
+}
+
+int32 FWorldLayerEpochDomain::GetNumPendingRetired() const
+{
+	FScopeLock Lock(&RetiredLock);
+	return Retired.Num();
+}
+
+FWorldLayerSnapshot::FWorldLayerSnapshot(const UWorldDataLayer& Layer, const FWorldLayerPixelTransform& InTransform)
+	: LayerName(Layer.Config->LayerName)
+	, DataFormat(Layer.Config->DataFormat)
+	, Resolution(Layer.Resolution)
+	, NumTilesX(Layer.Storage.GetNumTilesXY().X)
+	, DefaultValue(Layer.Config->DefaultValue)
+	, Transform(InTransform)
+	, Revision(Layer.GetRevision())
+	, Generation(Layer.GetGeneration())
+	, Tiles(Layer.Storage.GetTileRefs())
+	, DefaultTile(Layer.Storage.GetDefaultTileRef())
+{
+	const uint8* const* LayerTiles = Layer.Storage.GetTileTable();
+	TileTable.SetNumUninitialized(Tiles.Num());
+	for (int32 TileIndex = 0; TileIndex < Tiles.Num(); ++TileIndex)
+	{
+		TileTable[TileIndex] = LayerTiles[TileIndex];
+	}
+}
+
+FLinearColor FWorldLayerSnapshot::GetValueAtPixel(const FIntPoint& PixelCoords) const
+{
+	return VisitWorldLayerAccessor(*this, [&PixelCoords](const auto& Accessor)
+	{
+		return Accessor.Get(PixelCoords.X, PixelCoords.Y);
+	});
+}
+
+bool FWorldLayerSnapshot::GetValueAtLocation(const FVector2D& WorldLocation, FLinearColor& OutValue) const
+{
+	const FIntPoint Pixel = Transform.ToPixel(WorldLocation);
+	OutValue = GetValueAtPixel(Pixel);
+	return (uint32)Pixel.X < (uint32)Resolution.X && (uint32)Pixel.Y < (uint32)Resolution.Y;
+}
+
+float FWorldLayerSnapshot::GetFloatValueAtLocation(const FVector2D& WorldLocation) const
+{
+	const FIntPoint Pixel = Transform.ToPixel(WorldLocation);
+	return VisitWorldLayerAccessor(*this, [&Pixel](const auto& Accessor)
+	{
+		return Accessor.GetR(Pixel.X, Pixel.Y);
+	});
+}
+
+void FWorldLayerSnapshot::GetValuesAtLocations(TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const
+{
+	check(OutValues.Num() == Locations.Num());
+
+	VisitWorldLayerAccessor(*this, [&](const auto& Accessor)
+	{
+		ForEachPixelCoordinateChunk(Transform, Locations, [&](int32 ChunkStart, int32 ChunkNum, const double* PixelCoords)
+		{
+			for (int32 Index = 0; Index < ChunkNum; ++Index)
+			{
+				const FIntPoint Pixel = Transform.ClampIfNeeded(FMath::FloorToInt(PixelCoords[Index * 2]), FMath::FloorToInt(PixelCoords[Index * 2 + 1]));
+				OutValues[ChunkStart + Index] = Accessor.Get(Pixel.X, Pixel.Y);
+			}
+		});
+	});
+}
+
+FWorldLayerSnapshotChannel::~FWorldLayerSnapshotChannel()
+{
+	// Readers need a reference to the channel to call Acquire, so none can be inside it anymore.
+	delete Current.exchange(nullptr);
+}
+
+FWorldLayerSnapshotPtr FWorldLayerSnapshotChannel::Acquire() const
+{
+	FWorldLayerEpochScope EpochScope;
+	const FWorldLayerSnapshotPtr* Holder = Current.load();
+	return Holder ? *Holder : FWorldLayerSnapshotPtr();
+}
+
+void FWorldLayerSnapshotChannel::Publish(FWorldLayerSnapshotPtr Snapshot)
+{
+	FWorldLayerSnapshotPtr* Previous = Current.exchange(new FWorldLayerSnapshotPtr(MoveTemp(Snapshot)));
+	if (Previous)
+	{
+		FWorldLayerEpochDomain::Get().Retire([Previous]()
+		{
+			delete Previous;
+		});
+	}
+}
@@ -0,0 +1,125 @@
+#include "WorldLayerStagingPool.h"
+#include "WorldLayerReadback.h"
+
+FWorldLayerStagingPool::~FWorldLayerStagingPool()
+{
+	ensureMsgf(!HasBlocksInFlight(), TEXT("[RancWorldLayers] Staging pool destroyed while render commands still read its blocks."));
+}
+
+FWorldLayerStagingBlock& FWorldLayerStagingPool::Acquire(int64 Bytes)
+{
+	Bytes = FMath::Max<int64>(Bytes, 0);
+
+	// Smallest released block that fits, else the largest released one, which grows
+	FWorldLayerStagingBlock* Best = nullptr;
+	FWorldLayerStagingBlock* Largest = nullptr;
+	for (const TUniquePtr<FWorldLayerStagingBlock>& Block : Blocks)
+	{
+		if (Block->IsInFlight())
+		{
+			continue;
+		}
+		const int64 Capacity = Block->Memory.Num();
+		if (Capacity >= Bytes && (!Best || Capacity < Best->Memory.Num()))
+		{
+			Best = Block.Get();
+		}
+		if (!Largest || Capacity > Largest->Memory.Num())
+		{
+			Largest = Block.Get();
+		}
+	}
+
+	FWorldLayerStagingBlock* Block = Best ? Best : Largest;
+	if (!Block)
+	{
+		Block = Blocks.Add_GetRef(MakeUnique<FWorldLayerStagingBlock>()).Get();
+	}
+	if (Block->Memory.Num() < Bytes)
+	{
+		Block->Memory.SetNumUninitialized(Bytes);
+		++NumAllocations;
+	}
+
+	Block->Size = Bytes;
+	Block->Regions.Reset();
+	Block->SharedTiles.Reset();
+	Block->bInFlight.store(true, std::memory_order_relaxed);
+	return *Block;
+}
+
+FWorldLayerStagingBlock& FWorldLayerStagingPool::Stage(const FWorldDataLayerTileStore& Storage, EDataFormat DataFormat, TConstArrayView<FIntRect> Regions)
+{
+	const int32 BytesPerPixel = Storage.GetBytesPerPixel();
+	if (!FWorldLayerGpuFormat::NeedsConversion(DataFormat))
+	{
+		// Zero copy: the consumer reads the tiles in place. They are copy-on-write, so the game thread clones a tile the
+		// block still holds before writing to it instead of changing it underneath
+		FWorldLayerStagingBlock& Block = Acquire(0);
+		const int32 TilePitch = FWorldDataLayerTileStore::TileSize * BytesPerPixel;
+		for (const FIntRect& Region : Regions)
+		{
+			for (int32 TileY = Region.Min.Y >> FWorldDataLayerTileStore::TileSizeLog2; TileY <= (Region.Max.Y - 1) >> FWorldDataLayerTileStore::TileSizeLog2; ++TileY)
+			{
+				for (int32 TileX = Region.Min.X >> FWorldDataLayerTileStore::TileSizeLog2; TileX <= (Region.Max.X - 1) >> FWorldDataLayerTileStore::TileSizeLog2; ++TileX)
+				{
+					const int32 TileIndex = TileY * Storage.GetNumTilesXY().X + TileX;
+					const FIntRect TileRect = Storage.GetTileRect(TileIndex);
+					const FIntRect Part(TileRect.Min.ComponentMax(Region.Min), TileRect.Max.ComponentMin(Region.Max));
+					Block.SharedTiles.Add(Storage.IsTileAllocated(TileIndex) ? Storage.GetTileRefs()[TileIndex] : Storage.GetDefaultTileRef());
+					Block.Regions.Add({Part, Storage.GetPixel(Part.Min.X, Part.Min.Y), TilePitch});
+				}
+			}
+		}
+		return Block;
+	}
+
+	int64 TotalBytes = 0;
+	for (const FIntRect& Region : Regions)
+	{
+		TotalBytes += (int64)Region.Width() * Region.Height() * BytesPerPixel;
+	}
+
+	FWorldLayerStagingBlock& Block = Acquire(TotalBytes);
+	int64 Offset = 0;
+	for (const FIntRect& Region : Regions)
+	{
+		uint8* Texels = Block.GetData() + Offset;
+		Storage.CopyRect(Region, Texels, Region.Width() * BytesPerPixel);
+		FWorldLayerGpuFormat::ConvertToGpu(DataFormat, Texels, (int64)Region.Width() * Region.Height());
+		Block.Regions.Add({Region, Texels, Region.Width() * BytesPerPixel});
+		Offset += (int64)Region.Width() * Region.Height() * BytesPerPixel;
+	}
+	return Block;
+}
+
+bool FWorldLayerStagingPool::HasBlocksInFlight() const
+{
+	for (const TUniquePtr<FWorldLayerStagingBlock>& Block : Blocks)
+	{
+		if (Block->IsInFlight())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FWorldLayerStagingPool::Reset()
+{
+	ensureMsgf(!HasBlocksInFlight(), TEXT("[RancWorldLayers] Staging pool reset while render commands still read its blocks."));
+	Blocks.Empty();
+}
+
+FWorldLayerStagingStats FWorldLayerStagingPool::GetStats() const
+{
+	FWorldLayerStagingStats Stats;
+	Stats.NumBlocks = Blocks.Num();
+	for (const TUniquePtr<FWorldLayerStagingBlock>& Block : Blocks)
+	{
+		Stats.BlocksInFlight += Block->IsInFlight() ? 1 : 0;
+		Stats.ReservedBytes += Block->Memory.Num();
+	}
+	Stats.NumAllocations = NumAllocations;
+	return Stats;
+}
@@ -0,0 +1,153 @@
+#include "WorldLayerUploadScheduler.h"
+
+static bool RectContains(const FIntRect& Outer, const FIntRect& Inner)
+{
+	return Inner.Min.X >= Outer.Min.X && Inner.Min.Y >= Outer.Min.Y && Inner.Max.X <= Outer.Max.X && Inner.Max.Y <= Outer.Max.Y;
+}
+
+void FWorldLayerUploadScheduler::Enqueue(FName LayerName, const FIntRect& Region, int32 BytesPerPixel, int32 Priority)
+{
+	if (Region.Width() <= 0 || Region.Height() <= 0 || BytesPerPixel <= 0)
+	{
+		return;
+	}
+
+	uint64 EnqueueFrame = Frame;
+	uint64 Sequence = NextSequence++;
+	for (int32 Index = Queue.Num() - 1; Index >= 0; --Index)
+	{
+		FEntry& Entry = Queue[Index];
+		if (Entry.LayerName != LayerName)
+		{
+			continue;
+		}
+		if (RectContains(Entry.Region, Region))
+		{
+			Entry.Priority = FMath::Max(Entry.Priority, Priority);
+			return;
+		}
+		if (RectContains(Region, Entry.Region))
+		{
+			EnqueueFrame = FMath::Min(EnqueueFrame, Entry.EnqueueFrame);
+			Sequence = FMath::Min(Sequence, Entry.Sequence);
+			Queue.RemoveAt(Index);
+		}
+	}
+
+	FEntry& Entry = Queue.AddDefaulted_GetRef();
+	Entry.LayerName = LayerName;
+	Entry.Region = Region;
+	Entry.BytesPerPixel = BytesPerPixel;
+	Entry.Priority = Priority;
+	Entry.EnqueueFrame = EnqueueFrame;
+	Entry.Sequence = Sequence;
+}
+
+void FWorldLayerUploadScheduler::RemoveLayer(FName LayerName)
+{
+	Queue.RemoveAll([LayerName](const FEntry& Entry) { return Entry.LayerName == LayerName; });
+}
+
+void FWorldLayerUploadScheduler::Reset()
+{
+	Queue.Reset();
+	RegionsLastFrame = 0;
+	BytesLastFrame = 0;
+}
+
+int64 FWorldLayerUploadScheduler::Flush(IWorldLayerUploadSink& Sink)
+{
+	++Frame;
+	RegionsLastFrame = 0;
+	BytesLastFrame = 0;
+	if (Queue.IsEmpty())
+	{
+		return 0;
+	}
+
+	// Effective priority is the configured one plus the frames waited
+	const uint64 CurrentFrame = Frame;
+	Queue.Sort([CurrentFrame](const FEntry& A, const FEntry& B)
+	{
+		const int64 PriorityA = (int64)A.Priority + (int64)(CurrentFrame - A.EnqueueFrame);
+		const int64 PriorityB = (int64)B.Priority + (int64)(CurrentFrame - B.EnqueueFrame);
+		return PriorityA != PriorityB ? PriorityA > PriorityB : A.Sequence < B.Sequence;
+	});
+
+	const bool bUnlimited = BytesPerFrame <= 0;
+	int64 Remaining = BytesPerFrame;
+	int32 NumDone = 0;
+	for (FEntry& Entry : Queue)
+	{
+		const int64 RowBytes = (int64)Entry.Region.Width() * Entry.BytesPerPixel;
+		int32 Rows = Entry.Region.Height();
+		if (!bUnlimited && Entry.GetBytes() > Remaining)
+		{
+			Rows = (int32)FMath::Min<int64>(Remaining / RowBytes, Rows);
+			if (Rows == 0)
+			{
+				if (RegionsLastFrame > 0)
+				{
+					break;
+				}
+				Rows = 1;
+			}
+		}
+
+		const FIntRect Band(Entry.Region.Min, FIntPoint(Entry.Region.Max.X, Entry.Region.Min.Y + Rows));
+		Sink.Upload(Entry.LayerName, Band);
+		++RegionsLastFrame;
+		BytesLastFrame += Rows * RowBytes;
+		Remaining -= Rows * RowBytes;
+
+		Entry.Region.Min.Y += Rows;
+		if (Entry.Region.Height() > 0)
+		{
+			break;
+		}
+		++NumDone;
+		if (!bUnlimited && Remaining <= 0)
+		{
+			break;
+		}
+	}
+
+	// Finished entries are the front of the sorted queue
+	Queue.RemoveAt(0, NumDone);
+	return BytesLastFrame;
+}
+
+bool FWorldLayerUploadScheduler::IsLayerQueued(FName LayerName) const
+{
+	return Queue.ContainsByPredicate([LayerName](const FEntry& Entry) { return Entry.LayerName == LayerName; });
+}
+
+int64 FWorldLayerUploadScheduler::FlushLayer(FName LayerName, IWorldLayerUploadSink& Sink)
+{
+	int64 Bytes = 0;
+	for (int32 Index = 0; Index < Queue.Num();)
+	{
+		if (Queue[Index].LayerName != LayerName)
+		{
+			++Index;
+			continue;
+		}
+		Sink.Upload(LayerName, Queue[Index].Region);
+		Bytes += Queue[Index].GetBytes();
+		Queue.RemoveAt(Index);
+	}
+	return Bytes;
+}
+
+FWorldLayerUploadStats FWorldLayerUploadScheduler::GetStats() const
+{
+	FWorldLayerUploadStats Stats;
+	Stats.QueuedRegions = Queue.Num();
+	for (const FEntry& Entry : Queue)
+	{
+		Stats.QueuedBytes += Entry.GetBytes();
+	}
+	Stats.RegionsLastFrame = RegionsLastFrame;
+	Stats.BytesLastFrame = BytesLastFrame;
+	return Stats;
+}
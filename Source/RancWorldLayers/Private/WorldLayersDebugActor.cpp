@@ -13,6 +13,7 @@
 #include "Components/ComboBoxString.h"
 #include "Components/DecalComponent.h"
 #include "Engine/TextureRenderTarget2D.h"
+#include "Engine/Texture2DArray.h"
 #include "EngineUtils.h"
 #include "ImageUtils.h"
 #include "Misc/FileHelper.h"
@@ -488,7 +489,7 @@ void AWorldLayersDebugActor::Update3DVisualization()
 		
 		const bool bLayerChanged = (LastLayerName != TargetLayerName);
 		const bool bModeChanged = (LastLoggedMode != Current3DMode);
-		const bool bDataDirty = DataLayer->bIsDirty;
+		const bool bDataDirty = DataLayer->GetRevision() != LastLayerRevision;
 
 		static int32 ForceUpdateFrames = 0;
 		if (bLayerChanged || bModeChanged)
@@ -515,13 +516,12 @@ void AWorldLayersDebugActor::Update3DVisualization()
 				Subsystem->UpdateDebugRenderTarget(TargetLayerName, DebugRenderTargetInstance);
 			}
 
-			// Clear the dirty flag
-			UWorldDataLayer* MutableLayer = const_cast<UWorldDataLayer*>(DataLayer);
-			MutableLayer->bIsDirty = false;
+			// Remember the revision we visualized. The layer's dirty state belongs to the GPU sync and is left alone.
+			LastLayerRevision = DataLayer->GetRevision();
 
 			// Fallback/Legacy: Still get Tex for logging and potential override
 			UTexture* Tex = Subsystem->GetLayerGpuTexture(TargetLayerName);
-			if (!Tex)
+			if (!Tex || Tex->IsA<UTexture2DArray>()) // A shared texture array cannot stand in for a 2D texture
 			{
 				Tex = Subsystem->GetDebugTextureForLayer(TargetLayerName, DebugTextureInstance);
 				DebugTextureInstance = Cast<UTexture2D>(Tex);
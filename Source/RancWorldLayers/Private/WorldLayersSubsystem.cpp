@@ -1,13 +1,23 @@
 #include "WorldLayersSubsystem.h"
+#include "WorldLayerAccessor.h"
+#include "WorldLayerSnapshot.h"
 #include "Engine/TextureRenderTarget2D.h"
+#include "Engine/Texture2DArray.h"
 #include "ImageUtils.h"
 #include "EngineUtils.h"
 #include "RHICommandList.h"
 #include "WorldDataLayerAsset.h"
 #include "DynamicRHI.h"
 #include "RHIResources.h"
+#include "RenderingThread.h"
 #include "WorldDataVolume.h"
-#include "Spatial/Quadtree.h"
+#include "Spatial/SpatialIndex.h"
+#include "Derivation/WorldLayerDistanceField.h"
+#include "Derivation/WorldLayerImageOps.h"
+#include "Gpu/WorldLayerGpuReadback.h"
+#include "Curves/CurveFloat.h"
+#include "WorldLayerDerivations.h"
+#include "Async/ParallelFor.h"
 #include "WorldLayersDebugActor.h"
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "WorldLayersDebugWidget.h"
@@ -15,6 +25,8 @@
 #include "Framework/Application/SlateApplication.h"
 #include "Materials/MaterialParameterCollection.h"
 #include "Materials/MaterialParameterCollectionInstance.h"
+#include "Algo/StableSort.h"
+#include <atomic>
 
 /** Global input processor to catch keys in the Editor even without focus/PIE. Managed by the Subsystem. */
 class FWorldLayersInputProcessor : public IInputProcessor
@@ -44,8 +56,25 @@ public:
 void UWorldLayersSubsystem::ClearAllLayers()
 {
 	UE_LOG(LogTemp, Log, TEXT("[RancWorldLayers] Subsystem: Clearing all registered layers."));
+	// Nobody will poll these anymore
+	for (FPendingReadback& Readback : PendingReadbacks)
+	{
+		if (Readback.Promise)
+		{
+			Readback.Promise->SetValue(CompleteReadback(Readback, EWorldLayerReadbackPoll::Failed, FWorldLayerReadbackTexels()));
+		}
+	}
+	PendingReadbacks.Empty();
+	UploadScheduler.Reset();
+	TextureArrays.Empty();
+
 	WorldDataLayers.Empty();
+	DistanceFieldStates.Empty();
+	DerivationNodes.Empty();
+	DerivationLevels.Empty();
+	bDerivationGraphDirty = true;
 	WorldDataVolume = nullptr;
+	BumpLayoutGeneration();
 }
 
 void UWorldLayersSubsystem::InitializeFromVolume(AWorldDataVolume* Volume)
@@ -82,6 +111,8 @@ void UWorldLayersSubsystem::InitializeFromVolume(AWorldDataVolume* Volume)
 	}
 
 	UE_LOG(LogTemp, Log, TEXT("[RancWorldLayers] Subsystem Bounds Configured: Origin=%s, Size=%s"), *WorldGridOrigin.ToString(), *WorldGridSize.ToString());
+	BumpLayoutGeneration();
+	UploadScheduler.SetBudget((int64)Volume->GpuUploadBudgetPerFrameKB * 1024);
 
 	// Load and register all layers specified in the volume
 	for (const TSoftObjectPtr<UWorldDataLayerAsset>& LayerAssetPtr : Volume->LayerAssets)
@@ -209,6 +240,8 @@ void UWorldLayersSubsystem::SpawnDebugActor()
 void UWorldLayersSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
+	BumpLayoutGeneration();
+	FWorldLayerImageOps::RegisterAll(*this);
 
 	UWorld* World = GetWorld();
 	if (!World || World->IsNetMode(NM_DedicatedServer) || World->HasAnyFlags(RF_ClassDefaultObject))
@@ -261,7 +294,29 @@ void UWorldLayersSubsystem::Deinitialize()
 		DebugActor = nullptr;
 	}
 
+	// Render commands still reading staging blocks must finish before the pool frees them
+	if (StagingPool.HasBlocksInFlight())
+	{
+		FlushRenderingCommands();
+	}
+	StagingPool.Reset();
+
+	// Nobody will poll these again, so their callers learn now that the cells never arrive
+	for (FPendingReadback& Readback : PendingReadbacks)
+	{
+		if (Readback.Promise)
+		{
+			Readback.Promise->SetValue(CompleteReadback(Readback, EWorldLayerReadbackPoll::Failed, FWorldLayerReadbackTexels()));
+		}
+	}
+	PendingReadbacks.Empty();
+
+	TextureArrays.Empty();
 	WorldDataLayers.Empty();
+	DistanceFieldStates.Empty();
+	DerivationNodes.Empty();
+	DerivationLevels.Empty();
+	bDerivationGraphDirty = true;
 	Super::Deinitialize();
 }
 
@@ -293,16 +348,20 @@ bool UWorldLayersSubsystem::Tick(float DeltaTime)
 		SpawnDebugActor();
 	}
 
+	// Apply writes queued by other threads, then publish before the GPU sync so worker threads see this frame's CPU writes
+	ProcessWriteCommands();
+	UpdateDerivedLayers();
+	PublishReadSnapshots();
+
 	for (auto& Elem : WorldDataLayers)
 	{
 		UWorldDataLayer* Layer = Elem.Value;
 		if (!Layer) continue;
 
-		// Handle CPU to GPU sync
-		if (Layer->bIsDirty && Layer->GpuRepresentation)
+		// Queue CPU changes for upload; FlushUploads spends the frame's upload budget after the loop
+		if (Layer->IsDirty() && Layer->GpuRepresentation)
 		{
 			SyncCPUToGPU(Layer);
-			Layer->bIsDirty = false;
 		}
 
 		// Handle GPU to CPU readback
@@ -313,7 +372,8 @@ bool UWorldLayersSubsystem::Tick(float DeltaTime)
 
 			if (ReadbackBehavior == EWorldDataLayerReadbackBehavior::Periodic)
 			{
-				if (GetWorld() && GetWorld()->GetTimeSeconds() - Layer->LastReadbackTime >= PeriodicReadbackSeconds)
+				// Wait until queued uploads reach the GPU, or the readback would write stale texels over newer CPU edits
+				if (GetWorld() && GetWorld()->GetTimeSeconds() - Layer->LastReadbackTime >= PeriodicReadbackSeconds && !UploadScheduler.IsLayerQueued(Elem.Key))
 				{
 					ReadbackTexture(Layer);
 					Layer->LastReadbackTime = GetWorld()->GetTimeSeconds();
@@ -321,6 +381,9 @@ bool UWorldLayersSubsystem::Tick(float DeltaTime)
 			}
 		}
 	}
+
+	FlushUploads();
+	PollReadbacks();
 	return true;
 }
 
@@ -344,27 +407,90 @@ UWorldLayersSubsystem* UWorldLayersSubsystem::Get(const UObject* WorldContext)
 	return World->GetSubsystem<UWorldLayersSubsystem>();
 }
 
-bool UWorldLayersSubsystem::GetValueAtLocation(FName LayerName, const FVector2D& WorldLocation, FLinearColor& OutValue) const
+FWorldLayerHandle UWorldLayersSubsystem::GetLayerHandle(FName LayerName) const
 {
-	// AUTO-SYNC (Thread Safe): Only if on Game Thread.
-	if (!WorldDataVolume.IsValid() && IsInGameThread())
+	FWorldLayerHandle Handle(LayerName);
+	ResolveHandle(Handle);
+	return Handle;
+}
+
+void UWorldLayersSubsystem::BumpLayoutGeneration()
+{
+	// Drawn from one counter for all subsystems, so a handle can never validate against a different world.
+	static std::atomic<uint32> NextLayoutGeneration{1};
+	LayoutGeneration = NextLayoutGeneration.fetch_add(1);
+}
+
+TSharedPtr<FWorldLayerSnapshotChannel, ESPMode::ThreadSafe> UWorldLayersSubsystem::GetLayerSnapshotChannel(FName LayerName) const
+{
+	const UWorldDataLayer* DataLayer = GetDataLayer(LayerName);
+	return DataLayer ? DataLayer->GetSnapshotChannel() : nullptr;
+}
+
+TSharedPtr<FWorldLayerSnapshotChannel, ESPMode::ThreadSafe> UWorldLayersSubsystem::GetLayerSnapshotChannel(const FWorldLayerHandle& Handle) const
+{
+	const UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	return DataLayer ? DataLayer->GetSnapshotChannel() : nullptr;
+}
+
+void UWorldLayersSubsystem::PublishReadSnapshots()
+{
+	for (auto& Elem : WorldDataLayers)
 	{
-		AWorldDataVolume* FoundVolume = nullptr;
-		for (TActorIterator<AWorldDataVolume> It(GetWorld()); It; ++It)
+		UWorldDataLayer* Layer = Elem.Value;
+		if (Layer && Layer->Config && Layer->Config->bAllowConcurrentReads)
 		{
-			FoundVolume = *It;
-			break;
+			Layer->PublishSnapshot(GetPixelTransform(Layer), LayoutGeneration);
 		}
-		if (FoundVolume)
+	}
+
+	FWorldLayerEpochDomain::Get().Reclaim();
+}
+
+UWorldDataLayer* UWorldLayersSubsystem::ResolveHandle(const FWorldLayerHandle& Handle) const
+{
+	// The layout generation is checked first: only while it matches is the cached layer pointer known to be alive.
+	if (Handle.LayoutGeneration == LayoutGeneration && Handle.Layer && Handle.Layer->GetGeneration() == Handle.LayerGeneration)
+	{
+		return Handle.Layer;
+	}
+
+	// GetDataLayer may auto-discover a volume, which re-registers layers and moves the layout generation
+	GetDataLayer(Handle.LayerName);
+	Handle.Layer = WorldDataLayers.FindRef(Handle.LayerName);
+	Handle.LayoutGeneration = LayoutGeneration;
+	if (Handle.Layer)
+	{
+		Handle.LayerGeneration = Handle.Layer->GetGeneration();
+		Handle.Transform = GetPixelTransform(Handle.Layer);
+	}
+	return Handle.Layer;
+}
+
+bool UWorldLayersSubsystem::GetValueAtLocation(FName LayerName, const FVector2D& WorldLocation, FLinearColor& OutValue) const
+{
+	if (const UWorldDataLayer* DataLayer = GetDataLayer(LayerName))
+	{
+		const FIntPoint Pixel = WorldLocationToPixel(WorldLocation, DataLayer);
+		OutValue = VisitWorldLayerAccessor(*DataLayer, [&Pixel](const auto& Accessor)
 		{
-			const_cast<UWorldLayersSubsystem*>(this)->InitializeFromVolume(FoundVolume);
-		}
+			return Accessor.Get(Pixel.X, Pixel.Y);
+		});
+		return true;
 	}
+	OutValue = FLinearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	return false;
+}
 
-	if (const UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName))
+bool UWorldLayersSubsystem::GetValueAtLocation(const FWorldLayerHandle& Handle, const FVector2D& WorldLocation, FLinearColor& OutValue) const
+{
+	if (const UWorldDataLayer* DataLayer = ResolveHandle(Handle))
 	{
-		FIntPoint PixelCoords = WorldLocationToPixel(WorldLocation, DataLayer);
-		OutValue = DataLayer->GetValueAtPixel(PixelCoords);
+		const FIntPoint Pixel = Handle.Transform.ToPixel(WorldLocation);
+		OutValue = VisitWorldLayerAccessor(*DataLayer, [&Pixel](const auto& Accessor)
+		{
+			return Accessor.Get(Pixel.X, Pixel.Y);
+		});
 		return true;
 	}
 	OutValue = FLinearColor(0.0f, 0.0f, 0.0f, 0.0f);
@@ -375,36 +501,18 @@ bool UWorldLayersSubsystem::GetValueAtLocationInterpolated(FName LayerName, cons
 {
 	if (const UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName))
 	{
-		// 1. Calculate continuous pixel coordinates
-		FVector2D RelativeLocation = WorldLocation - WorldGridOrigin;
-		FVector2D CellSize;
-		if (DataLayer->Config->ResolutionMode == EResolutionMode::RelativeToWorld)
-		{
-			CellSize = DataLayer->Config->CellSize;
-		}
-		else
-		{
-			CellSize = FVector2D(WorldGridSize.X / (float)DataLayer->Resolution.X, WorldGridSize.Y / (float)DataLayer->Resolution.Y);
-		}
-
-		// Center-aligned sampling: subtract 0.5 to make integer coordinates represent pixel centers
-		float PixelX = (RelativeLocation.X / CellSize.X) - 0.5f;
-		float PixelY = (RelativeLocation.Y / CellSize.Y) - 0.5f;
-
-		int32 X0 = FMath::FloorToInt(PixelX);
-		int32 Y0 = FMath::FloorToInt(PixelY);
-		float FracX = PixelX - (float)X0;
-		float FracY = PixelY - (float)Y0;
+		return SampleLayerInterpolated(DataLayer, GetPixelTransform(DataLayer), MakeArrayView(&WorldLocation, 1), MakeArrayView(&OutValue, 1));
+	}
 
-		// 2. Fetch 4 neighbors
-		FLinearColor V00 = DataLayer->GetValueAtPixel(FIntPoint(X0, Y0));
-		FLinearColor V10 = DataLayer->GetValueAtPixel(FIntPoint(X0 + 1, Y0));
-		FLinearColor V01 = DataLayer->GetValueAtPixel(FIntPoint(X0, Y0 + 1));
-		FLinearColor V11 = DataLayer->GetValueAtPixel(FIntPoint(X0 + 1, Y0 + 1));
+	OutValue = FLinearColor::Black;
+	return false;
+}
 
-		// 3. Bi-Lerp
-		OutValue = FMath::BiLerp(V00, V10, V01, V11, FracX, FracY);
-		return true;
+bool UWorldLayersSubsystem::GetValueAtLocationInterpolated(const FWorldLayerHandle& Handle, const FVector2D& WorldLocation, FLinearColor& OutValue) const
+{
+	if (const UWorldDataLayer* DataLayer = ResolveHandle(Handle))
+	{
+		return SampleLayerInterpolated(DataLayer, Handle.Transform, MakeArrayView(&WorldLocation, 1), MakeArrayView(&OutValue, 1));
 	}
 
 	OutValue = FLinearColor::Black;
@@ -421,252 +529,1080 @@ float UWorldLayersSubsystem::GetFloatValueAtLocation(FName LayerName, const FVec
 	return 0.0f;
 }
 
-void UWorldLayersSubsystem::SetValueAtLocation(FName LayerName, const FVector2D& WorldLocation, const FLinearColor& NewValue)
+float UWorldLayersSubsystem::GetFloatValueAtLocation(const FWorldLayerHandle& Handle, const FVector2D& WorldLocation) const
 {
-	if (UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName))
+	if (const UWorldDataLayer* DataLayer = ResolveHandle(Handle))
 	{
-		FIntPoint PixelCoords = WorldLocationToPixel(WorldLocation, DataLayer);
-		DataLayer->SetValueAtPixel(PixelCoords, NewValue);
+		const FIntPoint Pixel = Handle.Transform.ToPixel(WorldLocation);
+		return VisitWorldLayerAccessor(*DataLayer, [&Pixel](const auto& Accessor)
+		{
+			return Accessor.GetR(Pixel.X, Pixel.Y);
+		});
 	}
+	return 0.0f;
 }
 
-void UWorldLayersSubsystem::RegisterDataLayer(UWorldDataLayerAsset* LayerAsset)
+bool UWorldLayersSubsystem::SampleLayer(const UWorldDataLayer* DataLayer, const FWorldLayerPixelTransform& Transform, TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const
 {
-	if (LayerAsset)
+	check(OutValues.Num() == Locations.Num());
+
+	if (!DataLayer)
 	{
-		UWorldDataLayer* TargetLayer = WorldDataLayers.FindRef(LayerAsset->LayerName);
-		bool bIsNew = false;
-		if (!TargetLayer)
+		for (FLinearColor& Value : OutValues)
 		{
-			TargetLayer = NewObject<UWorldDataLayer>(this);
-			WorldDataLayers.Add(LayerAsset->LayerName, TargetLayer);
-			bIsNew = true;
+			Value = FLinearColor(0.0f, 0.0f, 0.0f, 0.0f);
 		}
+		return false;
+	}
 
-		TargetLayer->Initialize(LayerAsset, WorldGridSize);
-
-		if (LayerAsset->GPUConfiguration.bKeepUpdatedOnGPU)
+	VisitWorldLayerAccessor(*DataLayer, [&](const auto& Accessor)
+	{
+		ForEachPixelCoordinateChunk(Transform, Locations, [&](int32 ChunkStart, int32 ChunkNum, const double* PixelCoords)
 		{
-			EPixelFormat PixelFormat = PF_Unknown;
-			switch (LayerAsset->DataFormat)
+			for (int32 Index = 0; Index < ChunkNum; ++Index)
 			{
-				case EDataFormat::R8: PixelFormat = PF_G8; break;
-				case EDataFormat::R16F: PixelFormat = PF_R16F; break;
-				case EDataFormat::RGBA8: PixelFormat = PF_B8G8R8A8; break;
-				case EDataFormat::RGBA16F: PixelFormat = PF_FloatRGBA; break;
+				const FIntPoint Pixel = Transform.ClampIfNeeded(FMath::FloorToInt(PixelCoords[Index * 2]), FMath::FloorToInt(PixelCoords[Index * 2 + 1]));
+				OutValues[ChunkStart + Index] = Accessor.Get(Pixel.X, Pixel.Y);
 			}
+		});
+	});
+	return true;
+}
 
-			if (PixelFormat != PF_Unknown)
-			{
-				if (LayerAsset->GPUConfiguration.bIsGPUWritable)
-				{
-					if (!TargetLayer->GpuRepresentation || !TargetLayer->GpuRepresentation->IsA<UTextureRenderTarget2D>())
-					{
-						TargetLayer->GpuRepresentation = NewObject<UTextureRenderTarget2D>(TargetLayer);
-					}
-					Cast<UTextureRenderTarget2D>(TargetLayer->GpuRepresentation)->InitCustomFormat(TargetLayer->Resolution.X, TargetLayer->Resolution.Y, PixelFormat, false);
-				}
-				else
-				{
-					if (!TargetLayer->GpuRepresentation || !TargetLayer->GpuRepresentation->IsA<UTexture2D>() || 
-						TargetLayer->GpuRepresentation->GetResource()->GetSizeX() != TargetLayer->Resolution.X ||
-						TargetLayer->GpuRepresentation->GetResource()->GetSizeY() != TargetLayer->Resolution.Y)
-					{
-						TargetLayer->GpuRepresentation = UTexture2D::CreateTransient(TargetLayer->Resolution.X, TargetLayer->Resolution.Y, PixelFormat);
-					}
-				}
-				TargetLayer->GpuRepresentation->UpdateResource();
-			}
+bool UWorldLayersSubsystem::SampleLayerInterpolated(const UWorldDataLayer* DataLayer, const FWorldLayerPixelTransform& Transform, TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const
+{
+	check(OutValues.Num() == Locations.Num());
+
+	if (!DataLayer)
+	{
+		for (FLinearColor& Value : OutValues)
+		{
+			Value = FLinearColor::Black;
 		}
+		return false;
 	}
+
+	VisitWorldLayerAccessor(*DataLayer, [&](const auto& Accessor)
+	{
+		ForEachPixelCoordinateChunk(Transform, Locations, [&](int32 ChunkStart, int32 ChunkNum, const double* PixelCoords)
+		{
+			for (int32 Index = 0; Index < ChunkNum; ++Index)
+			{
+				// Center-aligned sampling: subtract 0.5 to make integer coordinates represent pixel centers
+				const float PixelX = PixelCoords[Index * 2] - 0.5f;
+				const float PixelY = PixelCoords[Index * 2 + 1] - 0.5f;
+				OutValues[ChunkStart + Index] = Accessor.GetBilinear(PixelX, PixelY);
+			}
+		});
+	});
+	return true;
 }
 
-UTexture* UWorldLayersSubsystem::GetLayerGpuTexture(FName LayerName) const
+bool UWorldLayersSubsystem::SampleLayerFloat(const UWorldDataLayer* DataLayer, const FWorldLayerPixelTransform& Transform, TConstArrayView<FVector2D> Locations, TArrayView<float> OutValues) const
 {
-	const UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName);
-	if (DataLayer)
+	check(OutValues.Num() == Locations.Num());
+
+	if (!DataLayer)
 	{
-		return DataLayer->GpuRepresentation;
+		for (float& Value : OutValues)
+		{
+			Value = 0.0f;
+		}
+		return false;
 	}
-	return nullptr;
+
+	VisitWorldLayerAccessor(*DataLayer, [&](const auto& Accessor)
+	{
+		ForEachPixelCoordinateChunk(Transform, Locations, [&](int32 ChunkStart, int32 ChunkNum, const double* PixelCoords)
+		{
+			for (int32 Index = 0; Index < ChunkNum; ++Index)
+			{
+				const FIntPoint Pixel = Transform.ClampIfNeeded(FMath::FloorToInt(PixelCoords[Index * 2]), FMath::FloorToInt(PixelCoords[Index * 2 + 1]));
+				OutValues[ChunkStart + Index] = Accessor.GetR(Pixel.X, Pixel.Y);
+			}
+		});
+	});
+	return true;
 }
 
-bool UWorldLayersSubsystem::FindNearestPointWithValue(FName LayerName, const FVector2D& SearchOrigin, float MaxSearchRadius, const FLinearColor& TargetValue, FVector2D& OutWorldLocation) const
+bool UWorldLayersSubsystem::SampleLayerDominant3(const UWorldDataLayer* DataLayer, const FWorldLayerPixelTransform& Transform, TConstArrayView<FVector2D> Locations, TArrayView<FWorldLayerDominant3Sample> OutSamples) const
 {
-	const UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName);
-	if (!DataLayer || !DataLayer->Config->SpatialOptimization.bBuildAccelerationStructure || DataLayer->SpatialIndices.IsEmpty())
+	check(OutSamples.Num() == Locations.Num());
+
+	if (!DataLayer || DataLayer->Config->DataFormat != EDataFormat::RGBA8)
 	{
+		if (DataLayer)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] GetDominant3AtLocations: Layer %s is not RGBA8."), *DataLayer->Config->LayerName.ToString());
+		}
+		for (FWorldLayerDominant3Sample& Sample : OutSamples)
+		{
+			Sample = FWorldLayerDominant3Sample();
+		}
 		return false;
 	}
 
-	TSharedPtr<FQuadtree> TargetQuadtree;
-	for (const auto& Elem : DataLayer->SpatialIndices)
+	const TWorldLayerAccessor<EDataFormat::RGBA8> Accessor(*DataLayer);
+	const FWorldLayerDominant3Sample DefaultSample = FWorldLayerDominant3Codec::Decode(Accessor.GetDefaultValue());
+	ForEachPixelCoordinateChunk(Transform, Locations, [&](int32 ChunkStart, int32 ChunkNum, const double* PixelCoords)
 	{
-		if (TargetValue.Equals(Elem.Key, KINDA_SMALL_NUMBER))
+		for (int32 Index = 0; Index < ChunkNum; ++Index)
 		{
-			TargetQuadtree = Elem.Value;
-			break;
+			const FIntPoint Pixel = Transform.ClampIfNeeded(FMath::FloorToInt(PixelCoords[Index * 2]), FMath::FloorToInt(PixelCoords[Index * 2 + 1]));
+			OutSamples[ChunkStart + Index] = Accessor.IsValidPixel(Pixel.X, Pixel.Y)
+				? FWorldLayerDominant3Codec::Decode(Accessor.GetPixelUnchecked(Pixel.X, Pixel.Y))
+				: DefaultSample;
 		}
-	}
+	});
+	return true;
+}
 
-	if (!TargetQuadtree)
-	{
-		return false;
-	}
+bool UWorldLayersSubsystem::GetValuesAtLocations(FName LayerName, TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const
+{
+	const UWorldDataLayer* DataLayer = GetDataLayer(LayerName);
+	return SampleLayer(DataLayer, DataLayer ? GetPixelTransform(DataLayer) : FWorldLayerPixelTransform(), Locations, OutValues);
+}
 
-	FIntPoint SearchPixel = WorldLocationToPixel(SearchOrigin, DataLayer);
-	const float PixelSizeX = WorldGridSize.X / DataLayer->Resolution.X;
-	const float PixelRadius = MaxSearchRadius / PixelSizeX;
+bool UWorldLayersSubsystem::GetValuesAtLocations(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const
+{
+	const UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	return SampleLayer(DataLayer, Handle.Transform, Locations, OutValues);
+}
 
-	FIntPoint NearestPixel;
-	if (TargetQuadtree->FindNearest(SearchPixel, PixelRadius, NearestPixel))
+bool UWorldLayersSubsystem::GetValuesAtLocationsInterpolated(FName LayerName, TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const
+{
+	const UWorldDataLayer* DataLayer = GetDataLayer(LayerName);
+	return SampleLayerInterpolated(DataLayer, DataLayer ? GetPixelTransform(DataLayer) : FWorldLayerPixelTransform(), Locations, OutValues);
+}
+
+bool UWorldLayersSubsystem::GetValuesAtLocationsInterpolated(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const
+{
+	const UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	return SampleLayerInterpolated(DataLayer, Handle.Transform, Locations, OutValues);
+}
+
+bool UWorldLayersSubsystem::GetFloatValuesAtLocations(FName LayerName, TConstArrayView<FVector2D> Locations, TArrayView<float> OutValues) const
+{
+	const UWorldDataLayer* DataLayer = GetDataLayer(LayerName);
+	return SampleLayerFloat(DataLayer, DataLayer ? GetPixelTransform(DataLayer) : FWorldLayerPixelTransform(), Locations, OutValues);
+}
+
+bool UWorldLayersSubsystem::GetFloatValuesAtLocations(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Locations, TArrayView<float> OutValues) const
+{
+	const UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	return SampleLayerFloat(DataLayer, Handle.Transform, Locations, OutValues);
+}
+
+bool UWorldLayersSubsystem::GetDominant3AtLocations(FName LayerName, TConstArrayView<FVector2D> Locations, TArrayView<FWorldLayerDominant3Sample> OutSamples) const
+{
+	const UWorldDataLayer* DataLayer = GetDataLayer(LayerName);
+	return SampleLayerDominant3(DataLayer, DataLayer ? GetPixelTransform(DataLayer) : FWorldLayerPixelTransform(), Locations, OutSamples);
+}
+
+bool UWorldLayersSubsystem::GetDominant3AtLocations(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Locations, TArrayView<FWorldLayerDominant3Sample> OutSamples) const
+{
+	const UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	return SampleLayerDominant3(DataLayer, Handle.Transform, Locations, OutSamples);
+}
+
+bool UWorldLayersSubsystem::GetLayerTileCounts(FName LayerName, int32& OutAllocatedTiles, int32& OutImplicitTiles) const
+{
+	if (const UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName))
 	{
-		OutWorldLocation = PixelToWorldLocation(NearestPixel, DataLayer);
+		OutAllocatedTiles = DataLayer->GetNumAllocatedTiles();
+		OutImplicitTiles = DataLayer->GetNumImplicitTiles();
 		return true;
 	}
-
+	OutAllocatedTiles = 0;
+	OutImplicitTiles = 0;
 	return false;
 }
 
-/** Queues an asynchronous readback of a GPU texture to a staging buffer. This is non-blocking. */
-void UWorldLayersSubsystem::ReadbackTexture(UWorldDataLayer* DataLayer)
+void UWorldLayersSubsystem::SetValueAtLocation(FName LayerName, const FVector2D& WorldLocation, const FLinearColor& NewValue)
 {
-	if (!DataLayer || !DataLayer->GpuRepresentation || !DataLayer->Config->GPUConfiguration.bIsGPUWritable)
+	if (UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName))
 	{
-		return;
+		FIntPoint PixelCoords = WorldLocationToPixel(WorldLocation, DataLayer);
+		DataLayer->SetValueAtPixel(PixelCoords, NewValue);
 	}
+}
 
-	UTextureRenderTarget2D* RenderTarget = Cast<UTextureRenderTarget2D>(DataLayer->GpuRepresentation);
-	if (!RenderTarget || !RenderTarget->GetResource()) return;
-
-	FTextureResource* TextureResource = RenderTarget->GetResource();
-	const FName LayerName = DataLayer->Config->LayerName;
-	
-	// Enqueue a command on the render thread to perform the readback.
-	ENQUEUE_RENDER_COMMAND(ReadSurfaceCommand)(
-	[this, TextureResource, LayerName](FRHICommandListImmediate& RHICmdList)
+void UWorldLayersSubsystem::SetValueAtLocation(const FWorldLayerHandle& Handle, const FVector2D& WorldLocation, const FLinearColor& NewValue)
+{
+	if (UWorldDataLayer* DataLayer = ResolveHandle(Handle))
 	{
-		// This code now runs on the Render Thread.
-		
-		FRHITexture* TextureRHI = TextureResource->GetTexture2DRHI();
-		if (!TextureRHI) return;
-
-		FIntRect ReadbackRect(0, 0, TextureRHI->GetSizeX(), TextureRHI->GetSizeY());
+		DataLayer->SetValueAtPixel(Handle.Transform.ToPixel(WorldLocation), NewValue);
+	}
+}
 
-		// Create a TArray to hold the readback data. This will be populated by the RHI function.
-		TArray<FColor> ReadbackData;
+void UWorldLayersSubsystem::EnqueueSetValue(const FWorldLayerHandle& Handle, const FVector2D& WorldLocation, const FLinearColor& NewValue)
+{
+	EnqueueStamp(Handle, WorldLocation, 0.0f, NewValue);
+}
 
-		// Call the CORRECT, SYNCHRONOUS readback function. This will block the render thread briefly.
-		// GetReference() is used to get the raw pointer from the RHI ref.
-		RHICmdList.ReadSurfaceData(
-			TextureRHI,
-			ReadbackRect,
-			ReadbackData,
-			FReadSurfaceDataFlags()
-		);
+void UWorldLayersSubsystem::EnqueueStamp(const FWorldLayerHandle& Handle, const FVector2D& WorldLocation, float Radius, const FLinearColor& NewValue)
+{
+	if (!Handle.IsSet())
+	{
+		return;
+	}
 
-		// Now that we have the data, schedule a task to process it back on the game thread.
-		// We move the ReadbackData array into the lambda to transfer ownership safely.
-		AsyncTask(ENamedThreads::GameThread, [this, LayerName, ReadbackData = MoveTemp(ReadbackData)]()
-		{
-			// This code now runs safely on the Game Thread.
-			if (UWorldDataLayer* LayerToUpdate = WorldDataLayers.FindRef(LayerName))
-			{
-				const int32 TotalBytes = LayerToUpdate->Resolution.X * LayerToUpdate->Resolution.Y * LayerToUpdate->GetBytesPerPixel();
-				if (ReadbackData.Num() * sizeof(FColor) == TotalBytes)
-				{
-					LayerToUpdate->RawData.SetNum(TotalBytes);
-					FMemory::Memcpy(LayerToUpdate->RawData.GetData(), ReadbackData.GetData(), TotalBytes);
-					LayerToUpdate->bIsDirty = true;
-				}
-			}
-		});
-	});
+	FWorldLayerWriteCommand Command;
+	Command.LayerName = Handle.GetLayerName();
+	Command.WorldLocation = WorldLocation;
+	Command.Radius = FMath::Max(Radius, 0.0f);
+	Command.Value = NewValue;
+	PendingWriteCommands.Enqueue(MoveTemp(Command));
 }
 
-
-/** Updates a GPU texture from CPU data. Now handles both UTexture2D and UTextureRenderTarget2D. */
-void UWorldLayersSubsystem::SyncCPUToGPU(UWorldDataLayer* DataLayer)
+void UWorldLayersSubsystem::GatherCommandPixels(const FWorldLayerWriteCommand& Command, const FWorldLayerPixelTransform& Transform, TArray<FIntPoint>& OutPixels)
 {
-	if (!DataLayer || !DataLayer->GpuRepresentation || !DataLayer->GpuRepresentation->GetResource())
+	if (Command.Radius <= 0.0f)
 	{
+		OutPixels.Add(Transform.ToPixel(Command.WorldLocation));
 		return;
 	}
 
-	FTextureResource* TextureResource = DataLayer->GpuRepresentation->GetResource();
-	const int32 Width = DataLayer->Resolution.X;
-	const int32 Height = DataLayer->Resolution.Y;
-	const int32 BytesPerPixel = DataLayer->GetBytesPerPixel();
-	const uint32 Stride = Width * BytesPerPixel;
-	TArray<uint8> RawDataCopy = DataLayer->RawData; // Make a copy for the lambda
+	// Work in continuous pixel space, where cell (X, Y) has its center at (X + 0.5, Y + 0.5)
+	const FVector2D Center = Transform.ToPixelContinuous(Command.WorldLocation);
+	const FVector2D PixelRadius(Command.Radius / Transform.CellSize.X, Command.Radius / Transform.CellSize.Y);
+	const FVector2D InvRadiusSq(1.0 / (PixelRadius.X * PixelRadius.X), 1.0 / (PixelRadius.Y * PixelRadius.Y));
 
-	ENQUEUE_RENDER_COMMAND(UpdateWorldDataLayerTexture)(
-	[TextureResource, Width, Height, Stride, RawDataCopy](FRHICommandListImmediate& RHICmdList)
+	const int32 MinX = FMath::Max(FMath::FloorToInt(Center.X - PixelRadius.X), 0);
+	const int32 MinY = FMath::Max(FMath::FloorToInt(Center.Y - PixelRadius.Y), 0);
+	const int32 MaxX = FMath::Min(FMath::CeilToInt(Center.X + PixelRadius.X), Transform.Resolution.X - 1);
+	const int32 MaxY = FMath::Min(FMath::CeilToInt(Center.Y + PixelRadius.Y), Transform.Resolution.Y - 1);
+
+	for (int32 Y = MinY; Y <= MaxY; ++Y)
 	{
-		FUpdateTextureRegion2D UpdateRegion(0, 0, 0, 0, Width, Height);
-		FRHITexture* Texture2DRHI = TextureResource->GetTextureRHI();
-		if (Texture2DRHI)
+		const double DY = (Y + 0.5) - Center.Y;
+		const double RowTerm = DY * DY * InvRadiusSq.Y;
+		for (int32 X = MinX; X <= MaxX; ++X)
 		{
-			RHICmdList.UpdateTexture2D(Texture2DRHI, 0, UpdateRegion, Stride, RawDataCopy.GetData());
+			const double DX = (X + 0.5) - Center.X;
+			if (DX * DX * InvRadiusSq.X + RowTerm <= 1.0)
+			{
+				OutPixels.Add(FIntPoint(X, Y));
+			}
 		}
-	});
+	}
 }
 
-#include "Curves/CurveLinearColor.h"
-
-UTexture2D* UWorldLayersSubsystem::GetDebugTextureForLayer(FName LayerName, UTexture2D* InDebugTexture)
+int32 UWorldLayersSubsystem::ProcessWriteCommands()
 {
-	UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName);
-	if (!DataLayer)
+	WriteCommandBatch.Reset();
+	FWorldLayerWriteCommand Command;
+	while (PendingWriteCommands.Dequeue(Command))
 	{
-		return nullptr;
+		WriteCommandBatch.Add(MoveTemp(Command));
+	}
+	if (WriteCommandBatch.IsEmpty())
+	{
+		return 0;
 	}
 
-	const int32 Width = DataLayer->Resolution.X;
-	const int32 Height = DataLayer->Resolution.Y;
+	// Group by layer so each layer and its mapping are resolved once. The sort is stable, so later writes still win.
+	Algo::StableSort(WriteCommandBatch, [](const FWorldLayerWriteCommand& A, const FWorldLayerWriteCommand& B)
+	{
+		return A.LayerName.FastLess(B.LayerName);
+	});
 
-	// Create a new texture if one isn't provided or if the size is wrong
-	UTexture2D* DebugTexture = InDebugTexture;
-	if (!DebugTexture || DebugTexture->GetSizeX() != Width || DebugTexture->GetSizeY() != Height)
+	for (int32 GroupStart = 0; GroupStart < WriteCommandBatch.Num();)
 	{
-		DebugTexture = UTexture2D::CreateTransient(Width, Height, PF_B8G8R8A8);
-		if (!DebugTexture)
+		const FName LayerName = WriteCommandBatch[GroupStart].LayerName;
+		int32 GroupEnd = GroupStart + 1;
+		while (GroupEnd < WriteCommandBatch.Num() && WriteCommandBatch[GroupEnd].LayerName == LayerName)
 		{
-			return nullptr;
+			++GroupEnd;
 		}
+
+		if (UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName))
+		{
+			const FWorldLayerPixelTransform Transform = GetPixelTransform(DataLayer);
+			for (int32 Index = GroupStart; Index < GroupEnd; ++Index)
+			{
+				const FWorldLayerWriteCommand& LayerCommand = WriteCommandBatch[Index];
+				WritePixelScratch.Reset();
+				GatherCommandPixels(LayerCommand, Transform, WritePixelScratch);
+				DataLayer->SetValueAtPixels(WritePixelScratch, LayerCommand.Value);
+			}
+		}
+
+		GroupStart = GroupEnd;
 	}
 
-	// Lock the texture for writing
-	uint8* MipData = static_cast<uint8*>(DebugTexture->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_WRITE));
+	return WriteCommandBatch.Num();
+}
 
-	UCurveLinearColor* ColorCurve = Cast<UCurveLinearColor>(DataLayer->Config->DebugVisualization.ColorCurve.LoadSynchronous());
+void UWorldLayersSubsystem::RegisterDataLayer(UWorldDataLayerAsset* LayerAsset)
+{
+	if (LayerAsset)
+	{
+		UWorldDataLayer* TargetLayer = WorldDataLayers.FindRef(LayerAsset->LayerName);
+		bool bIsNew = false;
+		if (!TargetLayer)
+		{
+			TargetLayer = NewObject<UWorldDataLayer>(this);
+			WorldDataLayers.Add(LayerAsset->LayerName, TargetLayer);
+			bIsNew = true;
+		}
 
-	// Copy data from our layer to the texture
-	for (int32 y = 0; y < Height; ++y)
+		// Regions queued for the previous configuration may not fit anymore; the layer uploads in full again
+		UploadScheduler.RemoveLayer(LayerAsset->LayerName);
+		TargetLayer->Initialize(LayerAsset, WorldGridSize);
+		bDerivationGraphDirty = true;
+		if (LayerAsset->bAllowConcurrentReads)
+		{
+			TargetLayer->PublishSnapshot(GetPixelTransform(TargetLayer), LayoutGeneration);
+		}
+
+		const FWorldDataLayerGPUConfiguration& GPUConfiguration = LayerAsset->GPUConfiguration;
+		const bool bPackable = GPUConfiguration.bKeepUpdatedOnGPU && !GPUConfiguration.bIsGPUWritable && FWorldLayerGpuFormat::GetPixelFormat(LayerAsset->DataFormat) != PF_Unknown;
+		if (!bPackable && GPUConfiguration.bKeepUpdatedOnGPU && !GPUConfiguration.TextureArrayName.IsNone())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] RegisterDataLayer: Layer '%s' is GPU-writable and keeps its own texture instead of joining texture array '%s'."),
+				*LayerAsset->LayerName.ToString(), *GPUConfiguration.TextureArrayName.ToString());
+		}
+		const bool bPacked = AssignTextureArray(TargetLayer, bPackable ? GPUConfiguration.TextureArrayName : NAME_None);
+
+		if (GPUConfiguration.bKeepUpdatedOnGPU && !bPacked)
+		{
+			const EPixelFormat PixelFormat = FWorldLayerGpuFormat::GetPixelFormat(LayerAsset->DataFormat);
+
+			if (PixelFormat != PF_Unknown)
+			{
+				if (LayerAsset->GPUConfiguration.bIsGPUWritable)
+				{
+					if (!TargetLayer->GpuRepresentation || !TargetLayer->GpuRepresentation->IsA<UTextureRenderTarget2D>())
+					{
+						TargetLayer->GpuRepresentation = NewObject<UTextureRenderTarget2D>(TargetLayer);
+					}
+					Cast<UTextureRenderTarget2D>(TargetLayer->GpuRepresentation)->InitCustomFormat(TargetLayer->Resolution.X, TargetLayer->Resolution.Y, PixelFormat, false);
+				}
+				else
+				{
+					if (!TargetLayer->GpuRepresentation || !TargetLayer->GpuRepresentation->IsA<UTexture2D>() || 
+						TargetLayer->GpuRepresentation->GetResource()->GetSizeX() != TargetLayer->Resolution.X ||
+						TargetLayer->GpuRepresentation->GetResource()->GetSizeY() != TargetLayer->Resolution.Y)
+					{
+						TargetLayer->GpuRepresentation = UTexture2D::CreateTransient(TargetLayer->Resolution.X, TargetLayer->Resolution.Y, PixelFormat);
+					}
+				}
+				TargetLayer->GpuRepresentation->UpdateResource();
+			}
+		}
+	}
+}
+
+UTexture* UWorldLayersSubsystem::GetLayerGpuTexture(FName LayerName) const
+{
+	const UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName);
+	if (DataLayer)
+	{
+		return DataLayer->GpuRepresentation;
+	}
+	return nullptr;
+}
+
+bool UWorldLayersSubsystem::GetLayerTextureArraySlice(FName LayerName, FName& OutTextureArrayName, int32& OutSlice) const
+{
+	for (const TPair<FName, FWorldLayerTextureArray>& Pair : TextureArrays)
+	{
+		const int32 Slice = Pair.Value.Slices.IndexOfByKey(LayerName);
+		if (Slice != INDEX_NONE)
+		{
+			OutTextureArrayName = Pair.Key;
+			OutSlice = Slice;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool UWorldLayersSubsystem::AssignTextureArray(UWorldDataLayer* DataLayer, FName TextureArrayName)
+{
+	const FName LayerName = DataLayer->Config->LayerName;
+	const auto Fits = [DataLayer](const FWorldLayerTextureArray& TextureArray)
+	{
+		return TextureArray.DataFormat == DataLayer->Config->DataFormat && TextureArray.Resolution == DataLayer->Resolution;
+	};
+
+	// Leave the current array unless the layer stays in it unchanged; its slice then keeps its index
+	for (TPair<FName, FWorldLayerTextureArray>& Pair : TextureArrays)
+	{
+		FWorldLayerTextureArray& TextureArray = Pair.Value;
+		const int32 Slice = TextureArray.Slices.IndexOfByKey(LayerName);
+		if (Slice == INDEX_NONE)
+		{
+			continue;
+		}
+		if (Pair.Key == TextureArrayName && Fits(TextureArray))
+		{
+			DataLayer->GpuRepresentation = TextureArray.Texture;
+			DataLayer->GpuSlice = Slice;
+			DataLayer->MarkAllDirty();
+			return true;
+		}
+
+		// Materials bake the texture and the slices into their defaults, so the slice becomes a hole instead of moving
+		// the others, and the array keeps its texture even once every member is gone
+		TextureArray.Slices[Slice] = NAME_None;
+		DataLayer->GpuRepresentation = nullptr;
+		DataLayer->GpuSlice = INDEX_NONE;
+		break;
+	}
+
+	if (TextureArrayName.IsNone())
+	{
+		return false;
+	}
+
+	FWorldLayerTextureArray& TextureArray = TextureArrays.FindOrAdd(TextureArrayName);
+	bool bReallocate = !TextureArray.Texture;
+	if (!TextureArray.Slices.ContainsByPredicate([](FName Member) { return !Member.IsNone(); }))
+	{
+		// Nobody uses the array, so it takes on the layout of the layer joining it
+		bReallocate |= !Fits(TextureArray);
+		TextureArray.DataFormat = DataLayer->Config->DataFormat;
+		TextureArray.Resolution = DataLayer->Resolution;
+		TextureArray.Slices.Reset();
+	}
+	else if (!Fits(TextureArray))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] RegisterDataLayer: Layer '%s' (%dx%d) does not match the resolution or format of texture array '%s' (%dx%d) and keeps its own texture."),
+			*LayerName.ToString(), DataLayer->Resolution.X, DataLayer->Resolution.Y, *TextureArrayName.ToString(), TextureArray.Resolution.X, TextureArray.Resolution.Y);
+		return false;
+	}
+
+	// Fill the first hole, or grow the array by a slice
+	int32 Slice = TextureArray.Slices.IndexOfByKey(NAME_None);
+	if (Slice == INDEX_NONE)
+	{
+		Slice = TextureArray.Slices.Add(LayerName);
+		bReallocate |= TextureArray.Texture && TextureArray.Slices.Num() > TextureArray.Texture->GetArraySize();
+	}
+	else
+	{
+		TextureArray.Slices[Slice] = LayerName;
+	}
+
+	if (bReallocate)
+	{
+		RebuildTextureArray(TextureArray);
+	}
+	else
+	{
+		DataLayer->GpuRepresentation = TextureArray.Texture;
+		DataLayer->GpuSlice = Slice;
+		DataLayer->MarkAllDirty();
+	}
+	return true;
+}
+
+void UWorldLayersSubsystem::RebuildTextureArray(FWorldLayerTextureArray& TextureArray)
+{
+	const EPixelFormat PixelFormat = FWorldLayerGpuFormat::GetPixelFormat(TextureArray.DataFormat);
+	const FIntPoint Resolution = TextureArray.Resolution;
+	const int32 NumSlices = FMath::Max(TextureArray.Slices.Num(), 1);
+
+	if (!TextureArray.Texture)
+	{
+		TextureArray.Texture = UTexture2DArray::CreateTransient(Resolution.X, Resolution.Y, NumSlices, PixelFormat);
+	}
+	else
+	{
+		// Reallocate the existing texture the way CreateTransient lays it out, so materials holding it see the new slices
+		FTexturePlatformData* PlatformData = TextureArray.Texture->GetPlatformData();
+		PlatformData->SizeX = Resolution.X;
+		PlatformData->SizeY = Resolution.Y;
+		PlatformData->SetNumSlices(NumSlices);
+		PlatformData->PixelFormat = PixelFormat;
+
+		FTexture2DMipMap& Mip = PlatformData->Mips[0];
+		Mip.SizeX = Resolution.X;
+		Mip.SizeY = Resolution.Y;
+		Mip.SizeZ = NumSlices;
+		const FPixelFormatInfo& FormatInfo = GPixelFormats[PixelFormat];
+		Mip.BulkData.Lock(LOCK_READ_WRITE);
+		Mip.BulkData.Realloc((int64)FormatInfo.BlockBytes * (Resolution.X / FormatInfo.BlockSizeX) * (Resolution.Y / FormatInfo.BlockSizeY) * NumSlices);
+		Mip.BulkData.Unlock();
+	}
+	TextureArray.Texture->UpdateResource();
+
+	if (!TextureArray.Scratch || TextureArray.Scratch->GetSizeX() != Resolution.X || TextureArray.Scratch->GetSizeY() != Resolution.Y || TextureArray.Scratch->GetPixelFormat() != PixelFormat)
+	{
+		TextureArray.Scratch = UTexture2D::CreateTransient(Resolution.X, Resolution.Y, PixelFormat);
+		TextureArray.Scratch->UpdateResource();
+	}
+
+	// The reallocated texture starts out empty, so every slice uploads in full
+	for (int32 Slice = 0; Slice < TextureArray.Slices.Num(); ++Slice)
 	{
-		for (int32 x = 0; x < Width; ++x)
+		if (UWorldDataLayer* Member = TextureArray.Slices[Slice].IsNone() ? nullptr : WorldDataLayers.FindRef(TextureArray.Slices[Slice]))
 		{
-			FLinearColor PixelValue = DataLayer->GetValueAtPixel(FIntPoint(x, y));
-			FColor MappedColor;
+			Member->GpuRepresentation = TextureArray.Texture;
+			Member->GpuSlice = Slice;
+			UploadScheduler.RemoveLayer(TextureArray.Slices[Slice]);
+			Member->MarkAllDirty();
+		}
+	}
+}
+
+const FWorldLayerTextureArray* UWorldLayersSubsystem::FindTextureArray(const UWorldDataLayer* DataLayer) const
+{
+	for (const TPair<FName, FWorldLayerTextureArray>& Pair : TextureArrays)
+	{
+		if (Pair.Value.Texture == DataLayer->GpuRepresentation)
+		{
+			return &Pair.Value;
+		}
+	}
+	return nullptr;
+}
+
+bool UWorldLayersSubsystem::FindNearestPointWithValue(FName LayerName, const FVector2D& SearchOrigin, float MaxSearchRadius, const FLinearColor& TargetValue, FVector2D& OutWorldLocation) const
+{
+	const UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName);
+	return DataLayer && FindNearestPointInIndex(FindSpatialIndexInLayer(DataLayer, TargetValue), GetPixelTransform(DataLayer), SearchOrigin, MaxSearchRadius, OutWorldLocation);
+}
+
+bool UWorldLayersSubsystem::FindNearestPointWithValue(const FWorldLayerHandle& Handle, const FVector2D& SearchOrigin, float MaxSearchRadius, const FLinearColor& TargetValue, FVector2D& OutWorldLocation) const
+{
+	const UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	return DataLayer && FindNearestPointInIndex(FindSpatialIndexInLayer(DataLayer, TargetValue), Handle.Transform, SearchOrigin, MaxSearchRadius, OutWorldLocation);
+}
+
+bool UWorldLayersSubsystem::FindNearestPointInRange(FName LayerName, FName RangeName, const FVector2D& SearchOrigin, float MaxSearchRadius, FVector2D& OutWorldLocation) const
+{
+	const UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName);
+	return DataLayer && FindNearestPointInIndex(FindSpatialIndexInLayer(DataLayer, RangeName), GetPixelTransform(DataLayer), SearchOrigin, MaxSearchRadius, OutWorldLocation);
+}
+
+bool UWorldLayersSubsystem::FindNearestPointInRange(const FWorldLayerHandle& Handle, FName RangeName, const FVector2D& SearchOrigin, float MaxSearchRadius, FVector2D& OutWorldLocation) const
+{
+	const UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	return DataLayer && FindNearestPointInIndex(FindSpatialIndexInLayer(DataLayer, RangeName), Handle.Transform, SearchOrigin, MaxSearchRadius, OutWorldLocation);
+}
+
+bool UWorldLayersSubsystem::FindNearestPointInIndex(const FWorldLayerSpatialIndex* Index, const FWorldLayerPixelTransform& Transform, const FVector2D& SearchOrigin, float MaxSearchRadius, FVector2D& OutWorldLocation)
+{
+	if (!Index)
+	{
+		return false;
+	}
+
+	const FIntPoint SearchPixel = Transform.ToPixel(SearchOrigin);
+	const float PixelRadius = MaxSearchRadius / Transform.CellSize.X;
+
+	FIntPoint NearestPixel;
+	if (Index->FindNearest(SearchPixel, PixelRadius, NearestPixel))
+	{
+		OutWorldLocation = Transform.ToWorld(NearestPixel);
+		return true;
+	}
+
+	return false;
+}
 
-			if (DataLayer->Config->DebugVisualization.VisualizationMode == EWorldDataLayerVisualizationMode::ColorRamp && ColorCurve)
+const FWorldLayerSpatialIndex* UWorldLayersSubsystem::FindSpatialIndexInLayer(const UWorldDataLayer* DataLayer, const FLinearColor& TargetValue)
+{
+	if (!DataLayer->Config->SpatialOptimization.bBuildAccelerationStructure || DataLayer->SpatialIndices.IsEmpty())
+	{
+		return nullptr;
+	}
+	return DataLayer->FindSpatialIndexForKey(DataLayer->EncodeValueKey(TargetValue));
+}
+
+const FWorldLayerSpatialIndex* UWorldLayersSubsystem::FindSpatialIndexInLayer(const UWorldDataLayer* DataLayer, FName RangeName)
+{
+	if (!DataLayer->Config->SpatialOptimization.bBuildAccelerationStructure)
+	{
+		return nullptr;
+	}
+	return DataLayer->FindSpatialIndexForRange(RangeName);
+}
+
+int32 UWorldLayersSubsystem::FindKNearestInIndex(const FWorldLayerSpatialIndex& Index, const FWorldLayerPixelTransform& Transform, const FVector2D& SearchOrigin, float MaxSearchRadius, TArrayView<FIntPoint> Scratch, TArrayView<FVector2D> OutWorldLocations)
+{
+	const int32 NumFound = Index.FindKNearest(Transform.ToPixel(SearchOrigin), MaxSearchRadius / Transform.CellSize.X, Scratch);
+	for (int32 ResultIndex = 0; ResultIndex < NumFound; ++ResultIndex)
+	{
+		OutWorldLocations[ResultIndex] = Transform.ToWorld(Scratch[ResultIndex]);
+	}
+	return NumFound;
+}
+
+int32 UWorldLayersSubsystem::FindKNearestPointsWithValue(FName LayerName, const FVector2D& SearchOrigin, float MaxSearchRadius, const FLinearColor& TargetValue, int32 MaxResults, TArray<FVector2D>& OutWorldLocations) const
+{
+	OutWorldLocations.Reset();
+	const UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName);
+	const FWorldLayerSpatialIndex* TargetIndex = DataLayer ? FindSpatialIndexInLayer(DataLayer, TargetValue) : nullptr;
+	if (!TargetIndex || MaxResults <= 0)
+	{
+		return 0;
+	}
+
+	// Blueprint callers may pass any count; never reserve more slots than the index can fill
+	MaxResults = FMath::Min(MaxResults, TargetIndex->GetNumPoints());
+	if (MaxResults <= 0)
+	{
+		return 0;
+	}
+
+	TArray<FIntPoint, TInlineAllocator<64>> Scratch;
+	Scratch.SetNumUninitialized(MaxResults);
+	OutWorldLocations.SetNumUninitialized(MaxResults);
+	const int32 NumFound = FindKNearestInIndex(*TargetIndex, GetPixelTransform(DataLayer), SearchOrigin, MaxSearchRadius, Scratch, OutWorldLocations);
+	OutWorldLocations.SetNum(NumFound, EAllowShrinking::No);
+	return NumFound;
+}
+
+int32 UWorldLayersSubsystem::FindKNearestPointsWithValue(const FWorldLayerHandle& Handle, const FVector2D& SearchOrigin, float MaxSearchRadius, const FLinearColor& TargetValue, TArrayView<FVector2D> OutWorldLocations) const
+{
+	const UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	const FWorldLayerSpatialIndex* TargetIndex = DataLayer ? FindSpatialIndexInLayer(DataLayer, TargetValue) : nullptr;
+	if (!TargetIndex || OutWorldLocations.Num() == 0)
+	{
+		return 0;
+	}
+
+	TArray<FIntPoint, TInlineAllocator<64>> Scratch;
+	Scratch.SetNumUninitialized(OutWorldLocations.Num());
+	return FindKNearestInIndex(*TargetIndex, Handle.Transform, SearchOrigin, MaxSearchRadius, Scratch, OutWorldLocations);
+}
+
+void UWorldLayersSubsystem::FindKNearestPointsWithValueBatch(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Origins, float MaxSearchRadius, const FLinearColor& TargetValue, TArrayView<FVector2D> OutWorldLocations, TArrayView<int32> OutCounts) const
+{
+	check(OutCounts.Num() == Origins.Num());
+	FMemory::Memzero(OutCounts.GetData(), OutCounts.Num() * sizeof(int32));
+
+	const int32 K = Origins.Num() > 0 ? OutWorldLocations.Num() / Origins.Num() : 0;
+	const UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	const FWorldLayerSpatialIndex* TargetIndex = DataLayer ? FindSpatialIndexInLayer(DataLayer, TargetValue) : nullptr;
+	if (!TargetIndex || K == 0)
+	{
+		return;
+	}
+
+	// One heap buffer serves every origin
+	TArray<FIntPoint, TInlineAllocator<64>> Scratch;
+	Scratch.SetNumUninitialized(K);
+	for (int32 OriginIndex = 0; OriginIndex < Origins.Num(); ++OriginIndex)
+	{
+		OutCounts[OriginIndex] = FindKNearestInIndex(*TargetIndex, Handle.Transform, Origins[OriginIndex], MaxSearchRadius, Scratch, OutWorldLocations.Slice(OriginIndex * K, K));
+	}
+}
+
+int32 UWorldLayersSubsystem::FindPointsWithValueInRadius(FName LayerName, const FVector2D& Center, float Radius, const FLinearColor& TargetValue, TArray<FVector2D>& OutWorldLocations) const
+{
+	OutWorldLocations.Reset();
+	const UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName);
+	const FWorldLayerSpatialIndex* TargetIndex = DataLayer ? FindSpatialIndexInLayer(DataLayer, TargetValue) : nullptr;
+	if (!TargetIndex)
+	{
+		return 0;
+	}
+
+	const FWorldLayerPixelTransform Transform = GetPixelTransform(DataLayer);
+	return TargetIndex->ForEachInRadius(Transform.ToPixel(Center), Radius / Transform.CellSize.X, [&](const FIntPoint& Pixel)
+	{
+		OutWorldLocations.Add(Transform.ToWorld(Pixel));
+	});
+}
+
+int32 UWorldLayersSubsystem::ForEachPointWithValueInRadius(const FWorldLayerHandle& Handle, const FVector2D& Center, float Radius, const FLinearColor& TargetValue, TFunctionRef<void(const FVector2D&)> Visitor) const
+{
+	const UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	const FWorldLayerSpatialIndex* TargetIndex = DataLayer ? FindSpatialIndexInLayer(DataLayer, TargetValue) : nullptr;
+	if (!TargetIndex)
+	{
+		return 0;
+	}
+
+	const FWorldLayerPixelTransform& Transform = Handle.Transform;
+	return TargetIndex->ForEachInRadius(Transform.ToPixel(Center), Radius / Transform.CellSize.X, [&](const FIntPoint& Pixel)
+	{
+		Visitor(Transform.ToWorld(Pixel));
+	});
+}
+
+void UWorldLayersSubsystem::ForEachPointWithValueInRadiusBatch(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Origins, float Radius, const FLinearColor& TargetValue, TFunctionRef<void(int32, const FVector2D&)> Visitor) const
+{
+	const UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	const FWorldLayerSpatialIndex* TargetIndex = DataLayer ? FindSpatialIndexInLayer(DataLayer, TargetValue) : nullptr;
+	if (!TargetIndex)
+	{
+		return;
+	}
+
+	const FWorldLayerPixelTransform& Transform = Handle.Transform;
+	const float PixelRadius = Radius / Transform.CellSize.X;
+	for (int32 OriginIndex = 0; OriginIndex < Origins.Num(); ++OriginIndex)
+	{
+		TargetIndex->ForEachInRadius(Transform.ToPixel(Origins[OriginIndex]), PixelRadius, [&](const FIntPoint& Pixel)
+		{
+			Visitor(OriginIndex, Transform.ToWorld(Pixel));
+		});
+	}
+}
+
+int32 UWorldLayersSubsystem::CountPointsWithValueInRadius(FName LayerName, const FVector2D& Center, float Radius, const FLinearColor& TargetValue) const
+{
+	const UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName);
+	const FWorldLayerSpatialIndex* TargetIndex = DataLayer ? FindSpatialIndexInLayer(DataLayer, TargetValue) : nullptr;
+	if (!TargetIndex)
+	{
+		return 0;
+	}
+
+	const FWorldLayerPixelTransform Transform = GetPixelTransform(DataLayer);
+	return TargetIndex->CountInRadius(Transform.ToPixel(Center), Radius / Transform.CellSize.X);
+}
+
+int32 UWorldLayersSubsystem::CountPointsWithValueInRadius(const FWorldLayerHandle& Handle, const FVector2D& Center, float Radius, const FLinearColor& TargetValue) const
+{
+	const UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	const FWorldLayerSpatialIndex* TargetIndex = DataLayer ? FindSpatialIndexInLayer(DataLayer, TargetValue) : nullptr;
+	return TargetIndex ? TargetIndex->CountInRadius(Handle.Transform.ToPixel(Center), Radius / Handle.Transform.CellSize.X) : 0;
+}
+
+void UWorldLayersSubsystem::CountPointsWithValueInRadiusBatch(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Origins, float Radius, const FLinearColor& TargetValue, TArrayView<int32> OutCounts) const
+{
+	check(OutCounts.Num() == Origins.Num());
+	const UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	const FWorldLayerSpatialIndex* TargetIndex = DataLayer ? FindSpatialIndexInLayer(DataLayer, TargetValue) : nullptr;
+	const float PixelRadius = Radius / Handle.Transform.CellSize.X;
+	for (int32 OriginIndex = 0; OriginIndex < Origins.Num(); ++OriginIndex)
+	{
+		OutCounts[OriginIndex] = TargetIndex ? TargetIndex->CountInRadius(Handle.Transform.ToPixel(Origins[OriginIndex]), PixelRadius) : 0;
+	}
+}
+
+void UWorldLayersSubsystem::ReadbackTexture(UWorldDataLayer* DataLayer)
+{
+	if (!DataLayer || !DataLayer->GpuRepresentation || !DataLayer->Config->GPUConfiguration.bIsGPUWritable)
+	{
+		return;
+	}
+
+	const FName LayerName = DataLayer->Config->LayerName;
+	const bool bInFlight = PendingReadbacks.ContainsByPredicate([LayerName](const FPendingReadback& Readback)
+	{
+		return Readback.LayerName == LayerName && !Readback.Promise;
+	});
+	if (!bInFlight)
+	{
+		StartReadback(DataLayer, FIntRect(FIntPoint::ZeroValue, DataLayer->Resolution), true);
+	}
+}
+
+TFuture<FWorldLayerReadbackResult> UWorldLayersSubsystem::RequestReadback(FName LayerName, const FIntRect& Rect)
+{
+	return RequestReadback(GetLayerHandle(LayerName), Rect);
+}
+
+TFuture<FWorldLayerReadbackResult> UWorldLayersSubsystem::RequestReadback(const FWorldLayerHandle& Handle, const FIntRect& Rect)
+{
+	UWorldDataLayer* DataLayer = ResolveHandle(Handle);
+	const FWorldDataLayerGPUConfiguration* GPUConfiguration = DataLayer ? &DataLayer->Config->GPUConfiguration : nullptr;
+	const bool bWriteToLayer = GPUConfiguration && GPUConfiguration->bIsGPUWritable && GPUConfiguration->ReadbackBehavior == EWorldDataLayerReadbackBehavior::OnDemand;
+
+	if (bWriteToLayer)
+	{
+		FlushLayerUploads(DataLayer);
+	}
+
+	FPendingReadback* Readback = DataLayer ? StartReadback(DataLayer, Rect, bWriteToLayer) : nullptr;
+	if (!Readback)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] RequestReadback: Layer '%s' has no GPU texture to read from in the requested rect."), *Handle.LayerName.ToString());
+		FWorldLayerReadbackResult Failed;
+		Failed.DataFormat = DataLayer ? DataLayer->Config->DataFormat : EDataFormat::R8;
+		return MakeFulfilledPromise<FWorldLayerReadbackResult>(MoveTemp(Failed)).GetFuture();
+	}
+
+	Readback->Promise = MakeUnique<TPromise<FWorldLayerReadbackResult>>();
+	return Readback->Promise->GetFuture();
+}
+
+void UWorldLayersSubsystem::SetReadbackTransferFactory(FWorldLayerReadbackTransferFactory Factory)
+{
+	ReadbackTransferFactory = MoveTemp(Factory);
+}
+
+UWorldLayersSubsystem::FPendingReadback* UWorldLayersSubsystem::StartReadback(UWorldDataLayer* DataLayer, const FIntRect& Rect, bool bWriteToLayer)
+{
+	const FIntRect Clipped(Rect.Min.ComponentMax(FIntPoint::ZeroValue), Rect.Max.ComponentMin(DataLayer->Resolution));
+	if (Clipped.Width() <= 0 || Clipped.Height() <= 0)
+	{
+		return nullptr;
+	}
+
+	TUniquePtr<IWorldLayerReadbackTransfer> Transfer = ReadbackTransferFactory
+		? ReadbackTransferFactory(*DataLayer, Clipped)
+		: FWorldLayerGpuReadbackTransfer::Create(DataLayer->GpuRepresentation, DataLayer->Config->DataFormat, Clipped, FMath::Max(DataLayer->GpuSlice, 0));
+	if (!Transfer)
+	{
+		return nullptr;
+	}
+
+	FPendingReadback& Readback = PendingReadbacks.AddDefaulted_GetRef();
+	Readback.LayerName = DataLayer->Config->LayerName;
+	Readback.LayerGeneration = DataLayer->GetGeneration();
+	Readback.Rect = Clipped;
+	Readback.DataFormat = DataLayer->Config->DataFormat;
+	Readback.bWriteToLayer = bWriteToLayer;
+	Readback.Transfer = MoveTemp(Transfer);
+	return &Readback;
+}
+
+int32 UWorldLayersSubsystem::PollReadbacks()
+{
+	// Finished readbacks leave the list before any promise is fulfilled, as continuations may request new ones
+	TArray<TPair<TUniquePtr<TPromise<FWorldLayerReadbackResult>>, FWorldLayerReadbackResult>> Completed;
+	for (int32 Index = 0; Index < PendingReadbacks.Num();)
+	{
+		FPendingReadback& Readback = PendingReadbacks[Index];
+		FWorldLayerReadbackTexels Texels;
+		const EWorldLayerReadbackPoll Status = Readback.Transfer->Poll(Texels);
+		if (Status == EWorldLayerReadbackPoll::Pending)
+		{
+			++Index;
+			continue;
+		}
+
+		FWorldLayerReadbackResult Result = CompleteReadback(Readback, Status, Texels);
+		Completed.Emplace(MoveTemp(Readback.Promise), MoveTemp(Result));
+		PendingReadbacks.RemoveAt(Index);
+	}
+
+	for (auto& Pair : Completed)
+	{
+		if (Pair.Key)
+		{
+			Pair.Key->SetValue(MoveTemp(Pair.Value));
+		}
+	}
+	return Completed.Num();
+}
+
+FWorldLayerReadbackResult UWorldLayersSubsystem::CompleteReadback(const FPendingReadback& Readback, EWorldLayerReadbackPoll Status, const FWorldLayerReadbackTexels& Texels)
+{
+	FWorldLayerReadbackResult Result;
+	Result.Rect = Readback.Rect;
+	Result.DataFormat = Readback.DataFormat;
+	if (Status != EWorldLayerReadbackPoll::Ready)
+	{
+		return Result;
+	}
+
+	const FIntPoint Size = Readback.Rect.Size();
+	const int64 RowBytes = (int64)Size.X * FWorldLayerGpuFormat::GetBytesPerTexel(Readback.DataFormat);
+	if (Texels.RowPitch < RowBytes || Texels.Data.Num() < Texels.RowPitch * (Size.Y - 1) + RowBytes)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] Readback of '%s' returned %lld bytes with a row pitch of %lld; expected %dx%d texels."),
+			*Readback.LayerName.ToString(), Texels.Data.Num(), Texels.RowPitch, Size.X, Size.Y);
+		return Result;
+	}
+
+	Result.Data.SetNumUninitialized(RowBytes * Size.Y);
+	FWorldLayerGpuFormat::ConvertFromGpu(Readback.DataFormat, Texels.Data.GetData(), Texels.RowPitch, Size, Result.Data.GetData(), RowBytes);
+	Result.bSucceeded = true;
+
+	// A layer reinitialized since the request may have a different size or format
+	UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(Readback.LayerName);
+	if (Readback.bWriteToLayer && DataLayer && DataLayer->GetGeneration() == Readback.LayerGeneration)
+	{
+		DataLayer->WriteEncodedRect(Readback.Rect, Result.Data.GetData(), (int32)RowBytes);
+	}
+	return Result;
+}
+
+void UWorldLayersSubsystem::SyncCPUToGPU(UWorldDataLayer* DataLayer)
+{
+	if (!DataLayer || !DataLayer->GpuRepresentation || !DataLayer->GpuRepresentation->GetResource())
+	{
+		return;
+	}
+
+	TArray<FIntRect> DirtyRegions;
+	DataLayer->ConsumeDirtyRegions(DirtyRegions);
+	for (const FIntRect& Region : DirtyRegions)
+	{
+		UploadScheduler.Enqueue(DataLayer->Config->LayerName, Region, DataLayer->GetBytesPerPixel(), DataLayer->Config->GPUConfiguration.UploadPriority);
+	}
+}
+
+/** Groups released regions by layer, so each layer uploads in one render command. */
+struct FWorldLayerCollectingUploadSink : IWorldLayerUploadSink
+{
+	TMap<FName, TArray<FIntRect>> RegionsByLayer;
+
+	virtual void Upload(FName LayerName, const FIntRect& Region) override
+	{
+		RegionsByLayer.FindOrAdd(LayerName).Add(Region);
+	}
+};
+
+void UWorldLayersSubsystem::FlushUploads()
+{
+	FWorldLayerCollectingUploadSink Sink;
+	UploadScheduler.Flush(Sink);
+	for (const TPair<FName, TArray<FIntRect>>& Pair : Sink.RegionsByLayer)
+	{
+		UploadRegions(WorldDataLayers.FindRef(Pair.Key), Pair.Value);
+	}
+}
+
+void UWorldLayersSubsystem::FlushLayerUploads(UWorldDataLayer* DataLayer)
+{
+	if (!DataLayer)
+	{
+		return;
+	}
+	if (DataLayer->IsDirty())
+	{
+		SyncCPUToGPU(DataLayer);
+	}
+
+	const FName LayerName = DataLayer->Config->LayerName;
+	FWorldLayerCollectingUploadSink Sink;
+	UploadScheduler.FlushLayer(LayerName, Sink);
+	if (const TArray<FIntRect>* Regions = Sink.RegionsByLayer.Find(LayerName))
+	{
+		UploadRegions(DataLayer, *Regions);
+	}
+}
+
+void UWorldLayersSubsystem::SetUploadBudget(int64 BytesPerFrame)
+{
+	UploadScheduler.SetBudget(BytesPerFrame);
+}
+
+FWorldLayerUploadStats UWorldLayersSubsystem::GetUploadStats() const
+{
+	return UploadScheduler.GetStats();
+}
+
+FWorldLayerStagingStats UWorldLayersSubsystem::GetStagingStats() const
+{
+	return StagingPool.GetStats();
+}
+
+/** Updates a GPU texture from CPU data. Handles both UTexture2D and UTextureRenderTarget2D. */
+void UWorldLayersSubsystem::UploadRegions(UWorldDataLayer* DataLayer, TConstArrayView<FIntRect> DirtyRegions)
+{
+	if (!DataLayer || !DataLayer->GpuRepresentation || !DataLayer->GpuRepresentation->GetResource())
+	{
+		return;
+	}
+
+	FTextureResource* TextureResource = DataLayer->GpuRepresentation->GetResource();
+
+	// Packed layers upload into their array's scratch texture and copy from there into their slice
+	const FWorldLayerTextureArray* TextureArray = DataLayer->GpuSlice != INDEX_NONE ? FindTextureArray(DataLayer) : nullptr;
+	FTextureResource* ScratchResource = TextureArray && TextureArray->Scratch ? TextureArray->Scratch->GetResource() : nullptr;
+	if (DataLayer->GpuSlice != INDEX_NONE && !ScratchResource)
+	{
+		return;
+	}
+	const int32 Slice = DataLayer->GpuSlice;
+
+	// Formats the GPU stores as-is are read straight from the shared tiles, the others from converted pooled memory
+	FWorldLayerStagingBlock* Block = &StagingPool.Stage(DataLayer->Storage, DataLayer->Config->DataFormat, DirtyRegions);
+
+	// The render command releases the block once UpdateTexture2D has copied the texels
+	ENQUEUE_RENDER_COMMAND(UpdateWorldDataLayerTexture)(
+	[TextureResource, ScratchResource, Slice, Block](FRHICommandListImmediate& RHICmdList)
+	{
+		FRHITexture* TextureRHI = TextureResource->GetTextureRHI();
+		FRHITexture* UploadRHI = ScratchResource ? ScratchResource->GetTextureRHI() : TextureRHI;
+		if (TextureRHI && UploadRHI)
+		{
+			for (const FWorldLayerStagingRegion& Region : Block->Regions)
 			{
-				float NormalizedValue = (PixelValue.R - DataLayer->Config->DebugValueRange.X) / (DataLayer->Config->DebugValueRange.Y - DataLayer->Config->DebugValueRange.X);
-				MappedColor = ColorCurve->GetLinearColorValue(FMath::Clamp(NormalizedValue, 0.f, 1.f)).ToFColor(true);
+				const FUpdateTextureRegion2D UpdateRegion(Region.Rect.Min.X, Region.Rect.Min.Y, 0, 0, Region.Rect.Width(), Region.Rect.Height());
+				RHICmdList.UpdateTexture2D(UploadRHI, 0, UpdateRegion, Region.Pitch, Region.Data);
 			}
-			else // Grayscale
+
+			if (UploadRHI != TextureRHI)
 			{
-				MappedColor = PixelValue.ToFColor(true); // to sRGB
+				RHICmdList.Transition({FRHITransitionInfo(UploadRHI, ERHIAccess::Unknown, ERHIAccess::CopySrc), FRHITransitionInfo(TextureRHI, ERHIAccess::Unknown, ERHIAccess::CopyDest)});
+				for (const FWorldLayerStagingRegion& Region : Block->Regions)
+				{
+					FRHICopyTextureInfo CopyInfo;
+					CopyInfo.Size = FIntVector(Region.Rect.Width(), Region.Rect.Height(), 1);
+					CopyInfo.SourcePosition = FIntVector(Region.Rect.Min.X, Region.Rect.Min.Y, 0);
+					CopyInfo.DestPosition = CopyInfo.SourcePosition;
+					CopyInfo.DestSliceIndex = Slice;
+					CopyInfo.NumSlices = 1;
+					RHICmdList.CopyTexture(UploadRHI, TextureRHI, CopyInfo);
+				}
+				RHICmdList.Transition({FRHITransitionInfo(UploadRHI, ERHIAccess::CopySrc, ERHIAccess::SRVMask), FRHITransitionInfo(TextureRHI, ERHIAccess::CopyDest, ERHIAccess::SRVMask)});
 			}
+		}
+		Block->Release();
+	});
+}
+
+#include "Curves/CurveLinearColor.h"
+
+UTexture2D* UWorldLayersSubsystem::GetDebugTextureForLayer(FName LayerName, UTexture2D* InDebugTexture)
+{
+	UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(LayerName);
+	if (!DataLayer)
+	{
+		return nullptr;
+	}
 
-			int32 PixelIndex = (y * Width + x) * 4; // 4 bytes per pixel (BGRA)
-			MipData[PixelIndex] = MappedColor.B;
-			MipData[PixelIndex + 1] = MappedColor.G;
-			MipData[PixelIndex + 2] = MappedColor.R;
-			MipData[PixelIndex + 3] = MappedColor.A;
+	const int32 Width = DataLayer->Resolution.X;
+	const int32 Height = DataLayer->Resolution.Y;
+
+	// Create a new texture if one isn't provided or if the size is wrong
+	UTexture2D* DebugTexture = InDebugTexture;
+	if (!DebugTexture || DebugTexture->GetSizeX() != Width || DebugTexture->GetSizeY() != Height)
+	{
+		DebugTexture = UTexture2D::CreateTransient(Width, Height, PF_B8G8R8A8);
+		if (!DebugTexture)
+		{
+			return nullptr;
 		}
 	}
 
+	// Lock the texture for writing
+	uint8* MipData = static_cast<uint8*>(DebugTexture->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_WRITE));
+
+	UCurveLinearColor* ColorCurve = Cast<UCurveLinearColor>(DataLayer->Config->DebugVisualization.ColorCurve.LoadSynchronous());
+
+	// Copy data from our layer to the texture
+	VisitWorldLayerAccessor(*DataLayer, [&](const auto& Accessor)
+	{
+		for (int32 y = 0; y < Height; ++y)
+		{
+			for (int32 x = 0; x < Width; ++x)
+			{
+				FLinearColor PixelValue = Accessor.Get(x, y);
+				FColor MappedColor;
+
+				if (DataLayer->Config->DebugVisualization.VisualizationMode == EWorldDataLayerVisualizationMode::ColorRamp && ColorCurve)
+				{
+					float NormalizedValue = (PixelValue.R - DataLayer->Config->DebugValueRange.X) / (DataLayer->Config->DebugValueRange.Y - DataLayer->Config->DebugValueRange.X);
+					MappedColor = ColorCurve->GetLinearColorValue(FMath::Clamp(NormalizedValue, 0.f, 1.f)).ToFColor(true);
+				}
+				else // Grayscale
+				{
+					MappedColor = PixelValue.ToFColor(true); // to sRGB
+				}
+
+				int32 PixelIndex = (y * Width + x) * 4; // 4 bytes per pixel (BGRA)
+				MipData[PixelIndex] = MappedColor.B;
+				MipData[PixelIndex + 1] = MappedColor.G;
+				MipData[PixelIndex + 2] = MappedColor.R;
+				MipData[PixelIndex + 3] = MappedColor.A;
+			}
+		}
+	});
+
 	// Unlock the texture
 	DebugTexture->GetPlatformData()->Mips[0].BulkData.Unlock();
 	DebugTexture->UpdateResource();
@@ -691,42 +1627,47 @@ void UWorldLayersSubsystem::UpdateDebugRenderTarget(FName LayerName, UTextureRen
 		RenderTarget->UpdateResource();
 	}
 
-	TArray<FColor> ColorBuffer;
-	ColorBuffer.SetNumUninitialized(Width * Height);
+	FWorldLayerStagingBlock& Block = StagingPool.Acquire((int64)Width * Height * sizeof(FColor));
+	FColor* ColorBuffer = reinterpret_cast<FColor*>(Block.GetData());
 
 	UCurveLinearColor* ColorCurve = Cast<UCurveLinearColor>(DataLayer->Config->DebugVisualization.ColorCurve.LoadSynchronous());
 
-	for (int32 y = 0; y < Height; ++y)
+	VisitWorldLayerAccessor(*DataLayer, [&](const auto& Accessor)
 	{
-		for (int32 x = 0; x < Width; ++x)
+		for (int32 y = 0; y < Height; ++y)
 		{
-			FLinearColor PixelValue = DataLayer->GetValueAtPixel(FIntPoint(x, y));
-			FColor MappedColor;
-
-			if (DataLayer->Config->DebugVisualization.VisualizationMode == EWorldDataLayerVisualizationMode::ColorRamp && ColorCurve)
+			for (int32 x = 0; x < Width; ++x)
 			{
-				float NormalizedValue = (PixelValue.R - DataLayer->Config->DebugValueRange.X) / (DataLayer->Config->DebugValueRange.Y - DataLayer->Config->DebugValueRange.X);
-				MappedColor = ColorCurve->GetLinearColorValue(FMath::Clamp(NormalizedValue, 0.f, 1.f)).ToFColor(true);
-			}
-			else // Grayscale
-			{
-				MappedColor = PixelValue.ToFColor(true); // to sRGB
-			}
+				FLinearColor PixelValue = Accessor.Get(x, y);
+				FColor MappedColor;
 
-			ColorBuffer[y * Width + x] = MappedColor;
+				if (DataLayer->Config->DebugVisualization.VisualizationMode == EWorldDataLayerVisualizationMode::ColorRamp && ColorCurve)
+				{
+					float NormalizedValue = (PixelValue.R - DataLayer->Config->DebugValueRange.X) / (DataLayer->Config->DebugValueRange.Y - DataLayer->Config->DebugValueRange.X);
+					MappedColor = ColorCurve->GetLinearColorValue(FMath::Clamp(NormalizedValue, 0.f, 1.f)).ToFColor(true);
+				}
+				else // Grayscale
+				{
+					MappedColor = PixelValue.ToFColor(true); // to sRGB
+				}
+
+				ColorBuffer[y * Width + x] = MappedColor;
+			}
 		}
-	}
+	});
 
 	FTextureResource* TextureResource = RenderTarget->GetResource();
+	FWorldLayerStagingBlock* BlockPtr = &Block;
 	ENQUEUE_RENDER_COMMAND(UpdateDebugRenderTargetCommand)(
-		[TextureResource, Width, Height, ColorBuffer = MoveTemp(ColorBuffer)](FRHICommandListImmediate& RHICmdList)
+		[TextureResource, Width, Height, BlockPtr](FRHICommandListImmediate& RHICmdList)
 		{
 			FUpdateTextureRegion2D Region(0, 0, 0, 0, Width, Height);
 			FRHITexture* TextureRHI = TextureResource->GetTextureRHI();
 			if (TextureRHI)
 			{
-				RHICmdList.UpdateTexture2D(TextureRHI, 0, Region, Width * sizeof(FColor), (uint8*)ColorBuffer.GetData());
+				RHICmdList.UpdateTexture2D(TextureRHI, 0, Region, Width * sizeof(FColor), BlockPtr->GetData());
 			}
+			BlockPtr->Release();
 		}
 	);
 }
@@ -750,14 +1691,17 @@ void UWorldLayersSubsystem::ExportLayerToPNG(UWorldDataLayerAsset* LayerAsset, c
 	const int32 Height = DataLayer->Resolution.Y;
 	RawColorData.SetNumUninitialized(Width * Height);
 
-	for (int32 y = 0; y < Height; ++y)
+	VisitWorldLayerAccessor(*DataLayer, [&](const auto& Accessor)
 	{
-		for (int32 x = 0; x < Width; ++x)
+		for (int32 y = 0; y < Height; ++y)
 		{
-			const FLinearColor PixelValue = DataLayer->GetValueAtPixel(FIntPoint(x, y));
-			RawColorData[y * Width + x] = PixelValue.ToFColor(true);
+			for (int32 x = 0; x < Width; ++x)
+			{
+				const FLinearColor PixelValue = Accessor.Get(x, y);
+				RawColorData[y * Width + x] = PixelValue.ToFColor(true);
+			}
 		}
-	}
+	});
 
 	const FImageView ImageView(RawColorData.GetData(), Width, Height, ERawImageFormat::BGRA8);
 	TArray64<uint8> CompressedData;
@@ -792,6 +1736,7 @@ void UWorldLayersSubsystem::ImportLayerFromPNG(UWorldDataLayerAsset* LayerAsset,
 			}
 
 			ImportedTexture->GetPlatformData()->Mips[0].BulkData.Unlock();
+			DataLayer->Storage.Compact();
 			LayerAsset->Modify();
 		}
 	}
@@ -802,68 +1747,585 @@ void UWorldLayersSubsystem::UpdateDerivativeLayer(FName LayerName)
 	UWorldDataLayer* TargetLayer = WorldDataLayers.FindRef(LayerName);
 	if (!TargetLayer || TargetLayer->Config->Mutability != EWorldDataLayerMutability::Derivative) return;
 
-	// Search for any actor in the world that provides derivation logic
-	bool bHandled = false;
-	int32 CheckedActors = 0;
-	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	if (FWorldLayerBuiltInDerivations::IsBuiltIn(TargetLayer->Config->DerivationMethod))
 	{
-		CheckedActors++;
-		AActor* Actor = *It;
-		
-		IWorldLayersDerivationProvider* Provider = Cast<IWorldLayersDerivationProvider>(Actor);
-		if (Provider)
+		UpdateBuiltInDerivation(TargetLayer);
+		return;
+	}
+
+	const FName DerivationMethod = TargetLayer->Config->DerivationMethod;
+	if (const FDerivationRegistration* Registration = DerivationRegistry.Find(DerivationMethod))
+	{
+		if (Registration->Kernel)
 		{
-			UE_LOG(LogTemp, Log, TEXT("[RancWorldLayers] Found Provider: %s"), *Actor->GetName());
-			if (Provider->OnDeriveLayer(LayerName))
+			// Everything is recomputed, so the changes Tick would otherwise pick up are already covered
+			if (bDerivationGraphDirty)
 			{
-				bHandled = true;
-				break;
+				RebuildDerivationGraph();
+			}
+			if (FDerivationNode* Node = DerivationNodes.Find(LayerName))
+			{
+				ConsumeDerivationDirtyRect(*Node, TargetLayer->Resolution, 0);
+			}
+
+			FDerivationWork Work;
+			if (PrepareDerivationWork(TargetLayer, Registration->Kernel, FIntRect(FIntPoint::ZeroValue, TargetLayer->Resolution), Work))
+			{
+				ExecuteDerivationWork(MakeArrayView(&Work, 1));
 			}
+			return;
 		}
-		else if (Actor->GetName().Contains(TEXT("Procedural")))
+		if (UObject* Provider = Registration->Provider.Get())
 		{
-			// BP fallback if we ever add a BP implementation later
-			if (Actor->GetClass()->ImplementsInterface(UWorldLayersDerivationProvider::StaticClass()))
+			if (IWorldLayersDerivationProvider::Execute_OnDeriveLayer(Provider, LayerName))
 			{
-				UE_LOG(LogTemp, Log, TEXT("[RancWorldLayers] Found BP Provider: %s"), *Actor->GetName());
-				// For now, we only support native, but let's log the attempt
+				return;
 			}
 		}
 	}
 
-	if (!bHandled)
+	UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] No derivation kernel or provider registered for method '%s'. Target Layer: %s"), *DerivationMethod.ToString(), *LayerName.ToString());
+}
+
+void UWorldLayersSubsystem::RegisterDerivationKernel(FName DerivationMethod, FWorldLayerDerivationKernel Kernel, int32 Halo)
+{
+	Halo = FMath::Max(Halo, 0);
+	RegisterDerivationKernel(DerivationMethod, MoveTemp(Kernel), [Halo](const UWorldDataLayerAsset&) { return Halo; });
+}
+
+void UWorldLayersSubsystem::RegisterDerivationKernel(FName DerivationMethod, FWorldLayerDerivationKernel Kernel, FWorldLayerDerivationHalo GetHalo)
+{
+	if (FWorldLayerBuiltInDerivations::IsBuiltIn(DerivationMethod))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] No IWorldLayersDerivationProvider found in world. Checked %d actors. Target Layer: %s"), CheckedActors, *LayerName.ToString());
+		UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] '%s' is a built-in derivation and cannot be replaced."), *DerivationMethod.ToString());
+		return;
 	}
+	DerivationRegistry.Add(DerivationMethod, {MoveTemp(Kernel), MoveTemp(GetHalo), nullptr});
+	bDerivationGraphDirty = true;
 }
 
-FIntPoint UWorldLayersSubsystem::WorldLocationToPixel(const FVector2D& WorldLocation, const UWorldDataLayer* DataLayer) const
+void UWorldLayersSubsystem::RegisterDerivationProvider(FName DerivationMethod, TScriptInterface<IWorldLayersDerivationProvider> Provider)
+{
+	if (FWorldLayerBuiltInDerivations::IsBuiltIn(DerivationMethod))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] '%s' is a built-in derivation and cannot be replaced."), *DerivationMethod.ToString());
+		return;
+	}
+	UObject* ProviderObject = Provider.GetObject();
+	if (!ProviderObject || !ProviderObject->GetClass()->ImplementsInterface(UWorldLayersDerivationProvider::StaticClass()))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] Derivation provider for '%s' does not implement WorldLayersDerivationProvider."), *DerivationMethod.ToString());
+		return;
+	}
+	DerivationRegistry.Add(DerivationMethod, {nullptr, nullptr, ProviderObject});
+	bDerivationGraphDirty = true;
+}
+
+void UWorldLayersSubsystem::UnregisterDerivation(FName DerivationMethod)
 {
-	FVector2D RelativeLocation = WorldLocation - WorldGridOrigin;
+	DerivationRegistry.Remove(DerivationMethod);
+	bDerivationGraphDirty = true;
+}
 
-	int32 PixelX;
-	int32 PixelY;
+bool UWorldLayersSubsystem::PrepareDerivationWork(UWorldDataLayer* TargetLayer, const FWorldLayerDerivationKernel& Kernel, const FIntRect& Rect, FDerivationWork& OutWork) const
+{
+	const UWorldDataLayerAsset* Config = TargetLayer->Config;
 
-	FVector2D CellSize;
-	if (DataLayer->Config->ResolutionMode == EResolutionMode::RelativeToWorld)
+	OutWork.Inputs.TargetLayerName = Config->LayerName;
+	for (const FName& SourceName : Config->SourceLayerNames)
 	{
-		CellSize = DataLayer->Config->CellSize;
+		const UWorldDataLayer* SourceLayer = WorldDataLayers.FindRef(SourceName);
+		if (!SourceLayer)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] Derivative layer '%s' is missing its source layer '%s'."), *Config->LayerName.ToString(), *SourceName.ToString());
+			return false;
+		}
+		OutWork.Inputs.Sources.Add(MakeShared<FWorldLayerSnapshot, ESPMode::ThreadSafe>(*SourceLayer, GetPixelTransform(SourceLayer)));
 	}
-	else // Absolute Mode
+
+	// Kernels may not touch the asset, so they get a copy of its settings with the curve already sampled
+	OutWork.Inputs.ImageOp = Config->ImageOp;
+	if (Config->DerivationMethod == FWorldLayerImageOpDerivations::RemapCurve)
+	{
+		if (const UCurveFloat* Curve = Config->ImageOp.RemapCurve.LoadSynchronous())
+		{
+			constexpr int32 NumSamples = 1024;
+			OutWork.Inputs.RemapTable.SetNumUninitialized(NumSamples);
+			for (int32 Index = 0; Index < NumSamples; ++Index)
+			{
+				const float Input = FMath::Lerp(Config->ImageOp.RemapInputMin, Config->ImageOp.RemapInputMax, Index / (float)(NumSamples - 1));
+				OutWork.Inputs.RemapTable[Index] = Curve->GetFloatValue(Input);
+			}
+		}
+	}
+
+	OutWork.Target = TargetLayer;
+	OutWork.Kernel = &Kernel;
+	OutWork.Rect = Rect;
+
+	// Start from the default value, encoded once, so kernels may skip cells
+	const int32 BytesPerPixel = TargetLayer->GetBytesPerPixel();
+	uint8 DefaultPixel[16];
+	TargetLayer->EncodePixel(Config->DefaultValue, DefaultPixel);
+
+	OutWork.Stride = Rect.Width() * BytesPerPixel;
+	OutWork.Buffer.SetNumUninitialized(Rect.Height() * OutWork.Stride);
+	for (int32 Offset = 0; Offset < OutWork.Buffer.Num(); Offset += BytesPerPixel)
+	{
+		FMemory::Memcpy(OutWork.Buffer.GetData() + Offset, DefaultPixel, BytesPerPixel);
+	}
+	return true;
+}
+
+int32 UWorldLayersSubsystem::ExecuteDerivationWork(TArrayView<FDerivationWork> Work)
+{
+	struct FTileJob
+	{
+		int32 WorkIndex;
+		FIntRect Rect;
+	};
+
+	constexpr int32 TileSize = FWorldDataLayerTileStore::TileSize;
+	TArray<FTileJob> Jobs;
+	for (int32 WorkIndex = 0; WorkIndex < Work.Num(); ++WorkIndex)
+	{
+		const FIntRect& Rect = Work[WorkIndex].Rect;
+		for (int32 Y = Rect.Min.Y; Y < Rect.Max.Y; Y += TileSize)
+		{
+			for (int32 X = Rect.Min.X; X < Rect.Max.X; X += TileSize)
+			{
+				Jobs.Add({WorkIndex, FIntRect(X, Y, FMath::Min(X + TileSize, Rect.Max.X), FMath::Min(Y + TileSize, Rect.Max.Y))});
+			}
+		}
+	}
+
+	// Tiles of all layers in the batch are independent, so they all share one parallel pass
+	ParallelFor(Jobs.Num(), [&Work, &Jobs](int32 JobIndex)
+	{
+		FDerivationWork& Item = Work[Jobs[JobIndex].WorkIndex];
+		const FWorldLayerDerivationOutput Whole(Item.Target->Config->DataFormat, Item.Rect, Item.Buffer.GetData(), Item.Stride);
+		FWorldLayerDerivationOutput Output = Whole.Slice(Jobs[JobIndex].Rect);
+		(*Item.Kernel)(Item.Inputs, Output);
+	});
+
+	for (FDerivationWork& Item : Work)
+	{
+		Item.Target->WriteEncodedRect(Item.Rect, Item.Buffer.GetData(), Item.Stride);
+	}
+	return Jobs.Num();
+}
+
+void UWorldLayersSubsystem::ReleaseDerivationNode(FDerivationNode& Node)
+{
+	for (int32 Index = 0; Index < Node.Sources.Num(); ++Index)
+	{
+		if (UWorldDataLayer* Source = Node.Sources[Index].Get())
+		{
+			if (Node.SourceObserverSlots.IsValidIndex(Index))
+			{
+				Source->RemoveChangeObserver(Node.SourceObserverSlots[Index]);
+			}
+		}
+	}
+	Node.SourceObserverSlots.Reset();
+}
+
+void UWorldLayersSubsystem::RebuildDerivationGraph()
+{
+	bDerivationGraphDirty = false;
+
+	// Gather the layers Tick maintains: built-in derivations and registered kernels whose sources all exist
+	TMap<FName, FDerivationNode> NewNodes;
+	for (const auto& Elem : WorldDataLayers)
+	{
+		UWorldDataLayer* Layer = Elem.Value;
+		if (!Layer || !Layer->Config || Layer->Config->Mutability != EWorldDataLayerMutability::Derivative)
+		{
+			continue;
+		}
+
+		const FName DerivationMethod = Layer->Config->DerivationMethod;
+		const bool bBuiltIn = FWorldLayerBuiltInDerivations::IsBuiltIn(DerivationMethod);
+		const FDerivationRegistration* Registration = DerivationRegistry.Find(DerivationMethod);
+		if (!bBuiltIn && !(Registration && Registration->Kernel))
+		{
+			continue;
+		}
+
+		FDerivationNode Node;
+		Node.Target = Layer;
+		Node.TargetGeneration = Layer->GetGeneration();
+		bool bHasAllSources = true;
+		for (const FName& SourceName : Layer->Config->SourceLayerNames)
+		{
+			UWorldDataLayer* Source = WorldDataLayers.FindRef(SourceName);
+			bHasAllSources &= Source != nullptr;
+			Node.Sources.Add(Source);
+		}
+		if (bBuiltIn ? !GetBuiltInDerivationSource(Layer) : !bHasAllSources)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] Derivative layer '%s' is missing a valid source layer and will not be kept up to date."), *Elem.Key.ToString());
+			continue;
+		}
+
+		// Keep the observers of unchanged nodes, so a rebuild does not recompute everything. A reinitialized target holds
+		// only its default value again and needs fresh observers, which report every cell as changed
+		FDerivationNode* OldNode = DerivationNodes.Find(Elem.Key);
+		if (OldNode && OldNode->Target == Node.Target && OldNode->TargetGeneration == Node.TargetGeneration && OldNode->Sources == Node.Sources)
+		{
+			NewNodes.Add(Elem.Key, MoveTemp(*OldNode));
+			DerivationNodes.Remove(Elem.Key);
+			continue;
+		}
+
+		// Built-in derivations observe their source themselves
+		if (!bBuiltIn)
+		{
+			for (const TWeakObjectPtr<UWorldDataLayer>& Source : Node.Sources)
+			{
+				Node.SourceObserverSlots.Add(Source->AddChangeObserver());
+			}
+		}
+		NewNodes.Add(Elem.Key, MoveTemp(Node));
+	}
+
+	for (auto& Elem : DerivationNodes)
+	{
+		ReleaseDerivationNode(Elem.Value);
+	}
+	DerivationNodes = MoveTemp(NewNodes);
+
+	for (auto It = DistanceFieldStates.CreateIterator(); It; ++It)
+	{
+		if (!DerivationNodes.Contains(It.Key()))
+		{
+			if (UWorldDataLayer* Source = It.Value().Source.Get())
+			{
+				Source->RemoveChangeObserver(It.Value().SourceObserverSlot);
+			}
+			It.RemoveCurrent();
+		}
+	}
+
+	// Assign levels: a node goes one level above the deepest node among its sources. Whatever never resolves is in a cycle.
+	TMap<FName, int32> NodeLevels;
+	bool bProgress = true;
+	while (bProgress && NodeLevels.Num() < DerivationNodes.Num())
+	{
+		bProgress = false;
+		for (const auto& Elem : DerivationNodes)
+		{
+			if (NodeLevels.Contains(Elem.Key))
+			{
+				continue;
+			}
+
+			int32 Level = 0;
+			bool bResolved = true;
+			for (const FName& SourceName : Elem.Value.Target->Config->SourceLayerNames)
+			{
+				if (DerivationNodes.Contains(SourceName))
+				{
+					const int32* SourceLevel = NodeLevels.Find(SourceName);
+					if (!SourceLevel)
+					{
+						bResolved = false;
+						break;
+					}
+					Level = FMath::Max(Level, *SourceLevel + 1);
+				}
+			}
+
+			if (bResolved)
+			{
+				NodeLevels.Add(Elem.Key, Level);
+				bProgress = true;
+			}
+		}
+	}
+
+	DerivationLevels.Reset();
+	for (const auto& Elem : DerivationNodes)
+	{
+		const int32* Level = NodeLevels.Find(Elem.Key);
+		if (!Level)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] Derivative layer '%s' depends on itself through its sources and will not be kept up to date."), *Elem.Key.ToString());
+			continue;
+		}
+		if (DerivationLevels.Num() <= *Level)
+		{
+			DerivationLevels.SetNum(*Level + 1);
+		}
+		DerivationLevels[*Level].Add(Elem.Key);
+	}
+}
+
+FIntRect UWorldLayersSubsystem::ConsumeDerivationDirtyRect(FDerivationNode& Node, const FIntPoint& TargetResolution, int32 Halo)
+{
+	FIntRect Dirty;
+	for (int32 Index = 0; Index < Node.Sources.Num(); ++Index)
+	{
+		UWorldDataLayer* Source = Node.Sources[Index].Get();
+		if (!Source || !Node.SourceObserverSlots.IsValidIndex(Index))
+		{
+			continue;
+		}
+
+		const FIntRect Changed = Source->ConsumeChangedBounds(Node.SourceObserverSlots[Index]);
+		if (Changed.IsEmpty())
+		{
+			continue;
+		}
+
+		// Sources may have another resolution than the target; map outwards so every overlapped target cell is included
+		const FIntPoint SourceResolution = Source->Resolution.ComponentMax(FIntPoint(1, 1));
+		const FIntRect Mapped(
+			(int32)((int64)Changed.Min.X * TargetResolution.X / SourceResolution.X) - Halo,
+			(int32)((int64)Changed.Min.Y * TargetResolution.Y / SourceResolution.Y) - Halo,
+			(int32)FMath::DivideAndRoundUp((int64)Changed.Max.X * TargetResolution.X, (int64)SourceResolution.X) + Halo,
+			(int32)FMath::DivideAndRoundUp((int64)Changed.Max.Y * TargetResolution.Y, (int64)SourceResolution.Y) + Halo);
+
+		if (Dirty.IsEmpty())
+		{
+			Dirty = Mapped;
+		}
+		else
+		{
+			Dirty.Min = Dirty.Min.ComponentMin(Mapped.Min);
+			Dirty.Max = Dirty.Max.ComponentMax(Mapped.Max);
+		}
+	}
+
+	if (Dirty.IsEmpty())
+	{
+		return Dirty;
+	}
+
+	// Whole output tiles are recomputed, which is also the granularity the kernels are scheduled at
+	constexpr int32 Log2 = FWorldDataLayerTileStore::TileSizeLog2;
+	Dirty.Clip(FIntRect(FIntPoint::ZeroValue, TargetResolution));
+	if (Dirty.IsEmpty())
+	{
+		return Dirty;
+	}
+	Dirty.Min = FIntPoint(Dirty.Min.X >> Log2, Dirty.Min.Y >> Log2) * (1 << Log2);
+	Dirty.Max = FIntPoint(((Dirty.Max.X - 1) >> Log2) + 1, ((Dirty.Max.Y - 1) >> Log2) + 1) * (1 << Log2);
+	Dirty.Max = Dirty.Max.ComponentMin(TargetResolution);
+	return Dirty;
+}
+
+int32 UWorldLayersSubsystem::UpdateDerivedLayers()
+{
+	if (bDerivationGraphDirty)
+	{
+		RebuildDerivationGraph();
+	}
+
+	int32 NumTiles = 0;
+
+	// Layers of one level only depend on earlier levels, so each level runs as one parallel batch once the previous
+	// level's results are written; the writes mark the next level's sources as changed
+	for (const TArray<FName>& Level : DerivationLevels)
+	{
+		TArray<FDerivationWork> Work;
+		Work.Reserve(Level.Num());
+		for (const FName& LayerName : Level)
+		{
+			UWorldDataLayer* TargetLayer = WorldDataLayers.FindRef(LayerName);
+			FDerivationNode* Node = DerivationNodes.Find(LayerName);
+			if (!TargetLayer || !Node || Node->Target.Get() != TargetLayer)
+			{
+				bDerivationGraphDirty = true;
+				continue;
+			}
+
+			const FName DerivationMethod = TargetLayer->Config->DerivationMethod;
+			if (FWorldLayerBuiltInDerivations::IsBuiltIn(DerivationMethod))
+			{
+				UpdateBuiltInDerivation(TargetLayer);
+				continue;
+			}
+
+			const FDerivationRegistration* Registration = DerivationRegistry.Find(DerivationMethod);
+			if (!Registration || !Registration->Kernel)
+			{
+				continue;
+			}
+
+			const int32 Halo = Registration->GetHalo ? FMath::Max(Registration->GetHalo(*TargetLayer->Config), 0) : 0;
+			const FIntRect Dirty = ConsumeDerivationDirtyRect(*Node, TargetLayer->Resolution, Halo);
+			if (!Dirty.IsEmpty() && !PrepareDerivationWork(TargetLayer, Registration->Kernel, Dirty, Work.AddDefaulted_GetRef()))
+			{
+				Work.Pop();
+			}
+		}
+
+		NumTiles += ExecuteDerivationWork(Work);
+	}
+	return NumTiles;
+}
+
+UWorldDataLayer* UWorldLayersSubsystem::GetBuiltInDerivationSource(const UWorldDataLayer* TargetLayer) const
+{
+	const UWorldDataLayerAsset* Config = TargetLayer->Config;
+	UWorldDataLayer* SourceLayer = Config->SourceLayerNames.Num() > 0 ? WorldDataLayers.FindRef(Config->SourceLayerNames[0]) : nullptr;
+	if (!SourceLayer)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] Derivative layer '%s' has no registered source layer."), *Config->LayerName.ToString());
+		return nullptr;
+	}
+	if (SourceLayer->Resolution != TargetLayer->Resolution)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] Derivative layer '%s' must have the resolution of its source '%s'."), *Config->LayerName.ToString(), *SourceLayer->Config->LayerName.ToString());
+		return nullptr;
+	}
+	const bool bNearestFeature = Config->DerivationMethod == FWorldLayerBuiltInDerivations::NearestFeature;
+	if (bNearestFeature && (Config->DataFormat != EDataFormat::RGBA8 || TargetLayer->Resolution.GetMax() >= FWorldLayerNearestFeatureCodec::NoFeature))
 	{
-		CellSize = FVector2D(WorldGridSize.X / (float)DataLayer->Resolution.X, WorldGridSize.Y / (float)DataLayer->Resolution.Y);
+		UE_LOG(LogTemp, Warning, TEXT("[RancWorldLayers] NearestFeature layer '%s' must be RGBA8 and smaller than 65535 cells per side."), *Config->LayerName.ToString());
+		return nullptr;
+	}
+	return SourceLayer;
+}
+
+void UWorldLayersSubsystem::UpdateBuiltInDerivation(UWorldDataLayer* TargetLayer)
+{
+	const UWorldDataLayerAsset* Config = TargetLayer->Config;
+	const bool bNearestFeature = Config->DerivationMethod == FWorldLayerBuiltInDerivations::NearestFeature;
+	UWorldDataLayer* SourceLayer = GetBuiltInDerivationSource(TargetLayer);
+	if (!SourceLayer)
+	{
+		return;
+	}
+
+	// A new source, a new target or a resized source starts over with a full pass
+	FDistanceFieldState& State = DistanceFieldStates.FindOrAdd(Config->LayerName);
+	bool bFullUpdate = false;
+	if (State.Source.Get() != SourceLayer)
+	{
+		State.Source = SourceLayer;
+		State.SourceObserverSlot = SourceLayer->AddChangeObserver();
+		bFullUpdate = true;
+	}
+	if (State.Target.Get() != TargetLayer || State.TargetGeneration != TargetLayer->GetGeneration() || !State.Field || State.Field->GetResolution() != SourceLayer->Resolution)
+	{
+		State.Target = TargetLayer;
+		State.TargetGeneration = TargetLayer->GetGeneration();
+		State.Field = MakeShared<FWorldLayerDistanceField>(SourceLayer->Resolution);
+		bFullUpdate = true;
+	}
+
+	const FIntRect FullRect(FIntPoint::ZeroValue, SourceLayer->Resolution);
+	const FIntRect SourceChanges = SourceLayer->ConsumeChangedBounds(State.SourceObserverSlot);
+	if (!bFullUpdate && SourceChanges.IsEmpty())
+	{
+		return;
+	}
+
+	const FWorldDataLayerTrackedRange& FeatureRange = Config->DistanceField.FeatureRange;
+	FIntRect Changed = VisitWorldLayerAccessor(*SourceLayer, [&](const auto& Accessor)
+	{
+		return State.Field->Update(bFullUpdate ? FullRect : SourceChanges, [&](int32 X, TArrayView<uint8> OutIsFeature)
+		{
+			for (int32 Y = 0; Y < OutIsFeature.Num(); ++Y)
+			{
+				OutIsFeature[Y] = FeatureRange.Contains(Accessor.Get(X, Y)) ? 1 : 0;
+			}
+		});
+	});
+	if (bFullUpdate)
+	{
+		// Cells without any feature still need their first write
+		Changed = FullRect;
+	}
+	if (Changed.IsEmpty())
+	{
+		return;
+	}
+
+	// Encode the changed cells once, then write them as one rectangle
+	const int32 BytesPerPixel = TargetLayer->GetBytesPerPixel();
+	const int32 Stride = Changed.Width() * BytesPerPixel;
+	const float CellSize = GetPixelTransform(SourceLayer).CellSize.X;
+	const float MaxDistance = FMath::Max(Config->DistanceField.MaxDistance, UE_KINDA_SMALL_NUMBER);
+	const bool bNormalized = Config->DataFormat == EDataFormat::R8 || Config->DataFormat == EDataFormat::RGBA8;
+	const FWorldLayerDistanceField& Field = *State.Field;
+
+	TArray<uint8> Encoded;
+	Encoded.SetNumUninitialized(Changed.Height() * Stride);
+	ParallelFor(Changed.Height(), [&](int32 RowOffset)
+	{
+		const int32 Y = Changed.Min.Y + RowOffset;
+		uint8* Out = Encoded.GetData() + RowOffset * Stride;
+		for (int32 X = Changed.Min.X; X < Changed.Max.X; ++X, Out += BytesPerPixel)
+		{
+			const FIntPoint& Nearest = Field.GetNearestFeature(X, Y);
+			if (bNearestFeature)
+			{
+				FWorldLayerNearestFeatureCodec::Encode(Nearest, Out);
+				continue;
+			}
+
+			float Distance = MaxDistance;
+			if (Nearest.X != INDEX_NONE)
+			{
+				Distance = FMath::Min(FMath::Sqrt((float)(Nearest - FIntPoint(X, Y)).SizeSquared()) * CellSize, MaxDistance);
+			}
+			const float Stored = bNormalized ? Distance / MaxDistance : Distance;
+			TargetLayer->EncodePixel(FLinearColor(Stored, Stored, Stored, 1.0f), Out);
+		}
+	});
+
+	TargetLayer->WriteEncodedRect(Changed, Encoded.GetData(), Stride);
+}
+
+bool UWorldLayersSubsystem::FindNearestFeature(FName NearestFeatureLayerName, const FVector2D& SearchOrigin, FVector2D& OutWorldLocation) const
+{
+	const UWorldDataLayer* DataLayer = WorldDataLayers.FindRef(NearestFeatureLayerName);
+	if (!DataLayer || DataLayer->Config->DerivationMethod != FWorldLayerBuiltInDerivations::NearestFeature || DataLayer->Config->DataFormat != EDataFormat::RGBA8)
+	{
+		return false;
+	}
+
+	const FWorldLayerPixelTransform Transform = GetPixelTransform(DataLayer);
+	const FIntPoint Pixel = Transform.ToPixel(SearchOrigin);
+	if (!DataLayer->IsValidPixel(Pixel))
+	{
+		return false;
+	}
+
+	const FIntPoint Feature = FWorldLayerNearestFeatureCodec::Decode(DataLayer->Storage.GetPixel(Pixel.X, Pixel.Y));
+	if (Feature.X == INDEX_NONE)
+	{
+		return false;
 	}
+	OutWorldLocation = Transform.ToWorld(Feature);
+	return true;
+}
+
+FIntPoint UWorldLayersSubsystem::WorldLocationToPixel(const FVector2D& WorldLocation, const UWorldDataLayer* DataLayer) const
+{
+	return GetPixelTransform(DataLayer).ToPixel(WorldLocation);
+}
 
-	PixelX = FMath::FloorToInt(RelativeLocation.X / CellSize.X);
-	PixelY = FMath::FloorToInt(RelativeLocation.Y / CellSize.Y);
+FWorldLayerPixelTransform UWorldLayersSubsystem::GetPixelTransform(const UWorldDataLayer* DataLayer) const
+{
+	FWorldLayerPixelTransform Transform;
+	Transform.Origin = WorldGridOrigin;
+	Transform.Resolution = DataLayer->Resolution;
 
-	if (WorldDataVolume.IsValid() && WorldDataVolume->OutOfBoundsBehavior == EOutOfBoundsBehavior::ClampToEdge)
+	if (DataLayer->Config->ResolutionMode == EResolutionMode::RelativeToWorld)
+	{
+		Transform.CellSize = DataLayer->Config->CellSize;
+	}
+	else // Absolute Mode
 	{
-		PixelX = FMath::Clamp(PixelX, 0, DataLayer->Resolution.X - 1);
-		PixelY = FMath::Clamp(PixelY, 0, DataLayer->Resolution.Y - 1);
+		Transform.CellSize = FVector2D(WorldGridSize.X / (float)DataLayer->Resolution.X, WorldGridSize.Y / (float)DataLayer->Resolution.Y);
 	}
 
-	return FIntPoint(PixelX, PixelY);
+	Transform.bClampToEdge = WorldDataVolume.IsValid() && WorldDataVolume->OutOfBoundsBehavior == EOutOfBoundsBehavior::ClampToEdge;
+	return Transform;
 }
 
 FVector2D UWorldLayersSubsystem::PixelToWorldLocation(const FIntPoint& PixelLocation, const UWorldDataLayer* DataLayer) const
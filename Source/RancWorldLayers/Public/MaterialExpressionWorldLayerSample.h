@@ -3,15 +3,17 @@
 #include "CoreMinimal.h"
 #include "UObject/ObjectMacros.h"
 #include "MaterialExpressionIO.h"
-#include "Materials/MaterialExpressionTextureSampleParameter2D.h"
+#include "Materials/MaterialExpressionTextureSampleParameter.h"
 #include "MaterialExpressionWorldLayerSample.generated.h"
 
 /**
  * A material expression that samples a specific World Data Layer at a world location.
  * Automatically handles UV mapping based on the provided or global volume bounds.
+ * Layers packed into a texture array bind WL_TextureArray_<Array> and pick their slice with the WL_Slice_<Layer> parameter,
+ * so the texture parameter accepts Texture2DArrays as well as the 2D textures and render targets of unpacked layers.
  */
 UCLASS(collapsecategories, hidecategories = Object)
-class RANCWORLDLAYERS_API UMaterialExpressionWorldLayerSample : public UMaterialExpressionTextureSampleParameter2D
+class RANCWORLDLAYERS_API UMaterialExpressionWorldLayerSample : public UMaterialExpressionTextureSampleParameter
 {
 	GENERATED_UCLASS_BODY()
 
@@ -45,4 +47,11 @@ class RANCWORLDLAYERS_API UMaterialExpressionWorldLayerSample : public UMaterial
 	virtual EMaterialValueType GetInputValueType(int32 InputIndex) override;
 #endif
 	//~ End UMaterialExpression Interface
+
+	//~ Begin UMaterialExpressionTextureSampleParameter Interface
+#if WITH_EDITOR
+	virtual bool TextureIsValid(UTexture* InTexture, FString& OutMessage) override;
+	virtual void SetDefaultTexture() override;
+#endif
+	//~ End UMaterialExpressionTextureSampleParameter Interface
 };
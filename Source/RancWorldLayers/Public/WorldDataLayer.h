@@ -3,9 +3,13 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "WorldDataLayerAsset.h"
+#include "WorldDataLayerTileStore.h"
+#include "WorldLayerSpatialIndexStats.h"
 #include "WorldDataLayer.generated.h"
 
-class FQuadtree;
+class FWorldLayerSpatialIndex;
+class FWorldLayerSnapshotChannel;
+struct FWorldLayerPixelTransform;
 
 UCLASS()
 class RANCWORLDLAYERS_API UWorldDataLayer : public UObject
@@ -21,15 +25,22 @@ public:
 	UPROPERTY()
 	FIntPoint Resolution;
 
-	TArray<uint8> RawData;
+	/** Cell storage. Dense layers allocate every tile, sparse layers only the tiles that left the default value. */
+	FWorldDataLayerTileStore Storage;
 
-	bool bIsDirty;
 	bool bHasBeenInitializedFromTexture = false;
 
 	UPROPERTY()
 	UTexture* GpuRepresentation;
 
-	TMap<FLinearColor, TSharedPtr<FQuadtree>> SpatialIndices;
+	/** Slice of GpuRepresentation holding this layer when it is a shared texture array, INDEX_NONE otherwise. */
+	int32 GpuSlice = INDEX_NONE;
+
+	/** One index per tracked value, keyed by the value's encoded cell bytes (see GetPixelKey). */
+	TMap<uint64, TSharedPtr<FWorldLayerSpatialIndex>> SpatialIndices;
+
+	/** One index per entry of SpatialOptimization.RangesToTrack, in the same order. */
+	TArray<TSharedPtr<FWorldLayerSpatialIndex>> RangeIndices;
 
 	float LastReadbackTime;
 
@@ -37,9 +48,124 @@ public:
 	void Reinitialize(const FVector2D& InWorldGridSize);
 	FLinearColor GetValueAtPixel(const FIntPoint& PixelCoords) const;
 	void SetValueAtPixel(const FIntPoint& PixelCoords, const FLinearColor& NewValue);
+
+	/**
+	 * Writes one value into many cells. The value is encoded once, cells that already hold it are skipped without touching
+	 * the spatial indices, and the written cells are marked dirty as one rectangle. Out-of-bounds cells are ignored.
+	 */
+	void SetValueAtPixels(TConstArrayView<FIntPoint> Pixels, const FLinearColor& NewValue);
 	
 	int32 GetBytesPerPixel() const;
 
+	/** Encodes a value into the byte layout of this layer's DataFormat. OutPixel must hold GetBytesPerPixel() bytes. */
+	void EncodePixel(const FLinearColor& Value, uint8* OutPixel) const;
+	FLinearColor DecodePixel(const uint8* Pixel) const;
+
+	/** Packs the stored bytes of a cell into an integer. Equal keys mean bit-identical cells, so matching is exact after quantization. */
+	FORCEINLINE uint64 GetPixelKey(const uint8* Pixel) const
+	{
+		uint64 Key = 0;
+		FMemory::Memcpy(&Key, Pixel, Storage.GetBytesPerPixel());
+		return Key;
+	}
+
+	/** Key of the cell bytes Value encodes to in this layer's DataFormat. */
+	uint64 EncodeValueKey(const FLinearColor& Value) const;
+
+	/** Returns the spatial index tracking the cell value with the given key, or null if that value is not tracked. */
+	FWorldLayerSpatialIndex* FindSpatialIndexForKey(uint64 Key) const;
+
+	/** Returns the spatial index of the tracked range with the given name, or null if no such range is tracked. */
+	FWorldLayerSpatialIndex* FindSpatialIndexForRange(FName RangeName) const;
+
+	/** Bit I is set if the decoded cell lies inside SpatialOptimization.RangesToTrack[I]. */
+	uint64 GetRangeMask(const uint8* Pixel) const;
+
+	/** Number of storage tiles that own memory. */
+	int32 GetNumAllocatedTiles() const { return Storage.GetNumAllocatedTiles(); }
+
+	/** Number of storage tiles that still share the implicit default tile. */
+	int32 GetNumImplicitTiles() const { return Storage.GetNumImplicitTiles(); }
+
+	/** Combined stats of all spatial indices of this layer. */
+	FWorldLayerSpatialIndexStats GetSpatialIndexStats() const;
+
+	FORCEINLINE bool IsValidPixel(const FIntPoint& PixelCoords) const
+	{
+		return (uint32)PixelCoords.X < (uint32)Resolution.X && (uint32)PixelCoords.Y < (uint32)Resolution.Y;
+	}
+
+	/** Records that the cells inside Rect changed on the CPU, so the next GPU sync uploads them. */
+	void MarkDirty(const FIntRect& Rect);
+
+	/** Records that every cell changed, e.g. after reinitialization or a full readback. */
+	void MarkAllDirty();
+
+	/**
+	 * Writes already encoded cells into Rect and marks them dirty. Src holds Rect.Width() cells per row, SrcStride bytes apart.
+	 * Spatial indices, if any, are updated for the cells of Rect whose bytes change.
+	 */
+	void WriteEncodedRect(const FIntRect& Rect, const uint8* Src, int32 SrcStride);
+
+	/**
+	 * Registers a consumer of this layer's changes, such as a derivation, independent of the GPU dirty state.
+	 * Returns the slot to pass to ConsumeChangedBounds. Every cell starts out as changed for a new observer.
+	 */
+	int32 AddChangeObserver();
+
+	/** Returns the bounds of all cells changed since the last call for this observer slot, and resets them. Empty if nothing changed. */
+	FIntRect ConsumeChangedBounds(int32 ObserverSlot);
+
+	/** Releases a slot returned by AddChangeObserver. The slot may be handed out again. */
+	void RemoveChangeObserver(int32 ObserverSlot);
+
+	bool IsDirty() const { return bAllDirty || DirtyTiles.Num() > 0; }
+
+	/**
+	 * Returns the regions that changed since the last call and clears the dirty state.
+	 * Each dirty tile contributes the bounds of its changed cells; neighbouring tiles in a row are merged while that does
+	 * not inflate the upload much. Falls back to a single full-layer region once most of the layer is dirty.
+	 */
+	void ConsumeDirtyRegions(TArray<FIntRect>& OutRegions);
+
+	/** Incremented by every Reinitialize. Cached views of the layer (e.g. FWorldLayerHandle) compare it to detect stale data. */
+	uint32 GetGeneration() const { return Generation; }
+
+	/** Incremented on every change. Observers that must not consume the dirty state (e.g. debug views) compare revisions instead. */
+	uint32 GetRevision() const { return Revision; }
+
+	/** Channel through which worker threads acquire read snapshots of this layer. Stays the same across Reinitialize. */
+	TSharedPtr<FWorldLayerSnapshotChannel, ESPMode::ThreadSafe> GetSnapshotChannel() const { return SnapshotChannel; }
+
+	/** Publishes a new read snapshot if the cells, the generation or the world mapping changed since the last one. Game thread only. */
+	void PublishSnapshot(const FWorldLayerPixelTransform& Transform, uint32 LayoutGeneration);
+
 private:
-	int32 GetPixelIndex(const FIntPoint& PixelCoords) const;
+	/** Changed cell bounds per storage tile. An empty rect means the tile is clean. */
+	TArray<FIntRect> TileDirtyBounds;
+
+	/** Indices of the tiles with non-empty TileDirtyBounds. */
+	TArray<int32> DirtyTiles;
+
+	bool bAllDirty = false;
+	uint32 Revision = 0;
+
+	/** Bounds of the cells changed since each change observer last consumed them. */
+	TSparseArray<FIntRect> ObserverChangedBounds;
+	void NotifyChangeObservers(const FIntRect& Rect);
+	uint32 Generation = 0;
+
+	TSharedPtr<FWorldLayerSnapshotChannel, ESPMode::ThreadSafe> SnapshotChannel;
+	uint32 PublishedRevision = 0;
+	uint32 PublishedGeneration = 0;
+	uint32 PublishedLayoutGeneration = 0;
+
+	/** Recreates SpatialIndices and RangeIndices from the current cells. Cells are classified in parallel and each index is bulk-built. */
+	void RebuildSpatialIndices();
+
+	/** Moves a cell between range indices when the set of ranges its value lies in changed. */
+	void UpdateRangeIndices(const FIntPoint& PixelCoords, uint64 OldMask, uint64 NewMask);
+
+	/** Overwrites every cell from a BGRA8 or G8 image, resampled nearest-neighbour to the layer resolution. */
+	void PopulateFromPixels(const uint8* SrcData, int32 SrcWidth, int32 SrcHeight, bool bGrayscale);
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "WorldDataLayerAsset.generated.h"
 
 class UTexture2D;
+class UCurveFloat;
 
 UENUM()
 enum class EResolutionMode : uint8
@@ -43,7 +44,104 @@ struct FWorldDataLayerDebugVisualization
 UENUM()
 enum class EWorldDataLayerStructureType : uint8
 {
-	Quadtree
+	/** One point per matching cell. Best for values that cover few, scattered cells. */
+	Quadtree,
+
+	/** Hierarchical occupancy bitmask. Best for values that cover large connected regions. */
+	OccupancyPyramid
+};
+
+UENUM()
+enum class EWorldDataLayerChannel : uint8
+{
+	R,
+	G,
+	B,
+	A
+};
+
+/**
+ * An interval of one channel's value, e.g. R >= 0.7 or 0.2 <= R < 0.4. Cells whose stored value falls inside it are kept
+ * in an index of their own, maintained on every write, so ranges work for continuous formats such as R16F.
+ */
+USTRUCT(BlueprintType)
+struct FWorldDataLayerTrackedRange
+{
+	GENERATED_BODY()
+
+	/** Identifies the range in queries such as UWorldLayersSubsystem::FindNearestPointInRange. */
+	UPROPERTY(EditAnywhere, Category = "Tracked Range")
+	FName RangeName;
+
+	UPROPERTY(EditAnywhere, Category = "Tracked Range")
+	EWorldDataLayerChannel Channel = EWorldDataLayerChannel::R;
+
+	UPROPERTY(EditAnywhere, Category = "Tracked Range")
+	float Min = 0.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Tracked Range")
+	bool bIncludeMin = true;
+
+	/** For a range without upper bound, use a value above anything the format stores (16-bit floats end at 65504). */
+	UPROPERTY(EditAnywhere, Category = "Tracked Range")
+	float Max = 1.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Tracked Range")
+	bool bIncludeMax = false;
+
+	bool Contains(const FLinearColor& Value) const
+	{
+		const float ChannelValue = Value.Component((int32)Channel);
+		return (bIncludeMin ? ChannelValue >= Min : ChannelValue > Min) && (bIncludeMax ? ChannelValue <= Max : ChannelValue < Max);
+	}
+};
+
+/** Settings of the built-in DistanceField and NearestFeature derivations (see FWorldLayerBuiltInDerivations). */
+USTRUCT(BlueprintType)
+struct FWorldDataLayerDistanceFieldSettings
+{
+	GENERATED_BODY()
+
+	/** Cells of the source layer whose value lies in this range are the features that distances are measured to. */
+	UPROPERTY(EditAnywhere, Category = "Distance Field")
+	FWorldDataLayerTrackedRange FeatureRange;
+
+	/** Distances are clamped to this many world units, which is also stored while there is no feature. 8-bit layers store Distance / MaxDistance. */
+	UPROPERTY(EditAnywhere, Category = "Distance Field", meta = (ClampMin = "0.001"))
+	float MaxDistance = 65504.0f;
+};
+
+/** Settings of the image-processing derivations (see FWorldLayerImageOpDerivations). */
+USTRUCT(BlueprintType)
+struct FWorldDataLayerImageOpSettings
+{
+	GENERATED_BODY()
+
+	/** BoxBlur, GaussianBlur, Dilate and Erode: cells on each side of the center of the square window. */
+	UPROPERTY(EditAnywhere, Category = "Image Op", meta = (ClampMin = "0", ClampMax = "64"))
+	int32 Radius = 1;
+
+	/** GaussianBlur: standard deviation in cells. Zero uses half the Radius. */
+	UPROPERTY(EditAnywhere, Category = "Image Op", meta = (ClampMin = "0.0"))
+	float Sigma = 0.0f;
+
+	/** Threshold: channels at or above this become 1, the others 0. */
+	UPROPERTY(EditAnywhere, Category = "Image Op")
+	float Threshold = 0.5f;
+
+	/** RemapCurve: maps each channel of the source through this curve, sampled between RemapInputMin and RemapInputMax. */
+	UPROPERTY(EditAnywhere, Category = "Image Op")
+	TSoftObjectPtr<UCurveFloat> RemapCurve;
+
+	UPROPERTY(EditAnywhere, Category = "Image Op")
+	float RemapInputMin = 0.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Image Op")
+	float RemapInputMax = 1.0f;
+
+	/** WeightedSum: weight of each source layer, in SourceLayerNames order. Sources without a weight count once. */
+	UPROPERTY(EditAnywhere, Category = "Image Op")
+	TArray<float> Weights;
 };
 
 USTRUCT(BlueprintType)
@@ -59,6 +157,10 @@ struct FWorldDataLayerSpatialOptimization
 
 	UPROPERTY(EditAnywhere, Category = "Spatial Optimization", meta = (EditCondition = "bBuildAccelerationStructure"))
 	TArray<FLinearColor> ValuesToTrack;
+
+	/** Value ranges to index, matched against the decoded stored value of each cell. At most 64. */
+	UPROPERTY(EditAnywhere, Category = "Spatial Optimization", meta = (EditCondition = "bBuildAccelerationStructure"))
+	TArray<FWorldDataLayerTrackedRange> RangesToTrack;
 };
 
 UENUM()
@@ -86,6 +188,17 @@ struct FWorldDataLayerGPUConfiguration
 	UPROPERTY(EditAnywhere, Category = "GPU Configuration", meta = (EditCondition = "bIsGPUWritable"))
 	float PeriodicReadbackSeconds = 0.0f;
 
+	/** Uploads of layers with a higher priority go first when the per-frame upload budget is short, e.g. for layers that visible materials sample. */
+	UPROPERTY(EditAnywhere, Category = "GPU Configuration", meta = (EditCondition = "bKeepUpdatedOnGPU"))
+	int32 UploadPriority = 0;
+
+	/**
+	 * Layers naming the same texture array share one Texture2DArray, a slice each, so a material sampling many of them
+	 * binds one texture. Members must share resolution and format. GPU-writable layers always keep their own texture.
+	 */
+	UPROPERTY(EditAnywhere, Category = "GPU Configuration", meta = (EditCondition = "bKeepUpdatedOnGPU && !bIsGPUWritable"))
+	FName TextureArrayName;
+
 	UPROPERTY(EditAnywhere, Category = "GPU Configuration")
 	TSoftObjectPtr<class UNiagaraSystem> AssociatedNiagaraSystem;
 };
@@ -118,6 +231,14 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Core Identity|Derivative", meta = (EditCondition = "Mutability == EWorldDataLayerMutability::Derivative"))
 	FName DerivationMethod;
 
+	/** Used when DerivationMethod is one of the built-in DistanceField or NearestFeature derivations. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Core Identity|Derivative", meta = (EditCondition = "Mutability == EWorldDataLayerMutability::Derivative"))
+	FWorldDataLayerDistanceFieldSettings DistanceField;
+
+	/** Used when DerivationMethod is one of the built-in image-processing derivations, such as GaussianBlur or Threshold. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Core Identity|Derivative", meta = (EditCondition = "Mutability == EWorldDataLayerMutability::Derivative"))
+	FWorldDataLayerImageOpSettings ImageOp;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Data Representation")
 	EResolutionMode ResolutionMode;
 
@@ -133,6 +254,14 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Data Representation")
 	FLinearColor DefaultValue;
 
+	/** If true, cells are stored in 64x64 tiles and tiles that still hold DefaultValue are never allocated. Useful for large layers that stay mostly default. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Data Representation")
+	bool bUseSparseStorage = false;
+
+	/** If true, the subsystem publishes an immutable snapshot of this layer every tick it changed, which worker threads can sample without locks. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Data Representation")
+	bool bAllowConcurrentReads = false;
+
 	/** Optional texture to populate the layer with initial data. */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Data Representation")
 	TSoftObjectPtr<UTexture2D> InitialDataTexture;
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Memory of one storage tile. Shared with read snapshots, so it is never resized once allocated. */
+using FWorldDataLayerTileBuffer = TArray<uint8>;
+using FWorldDataLayerTileRef = TSharedPtr<FWorldDataLayerTileBuffer, ESPMode::ThreadSafe>;
+
+/**
+ * Tiled CPU storage for the cells of a World Data Layer.
+ * Cells are grouped into square tiles of TileSize x TileSize. In sparse mode, tiles that still hold the layer's
+ * default value are never allocated and instead all share one implicit constant tile.
+ * Tiles are reference counted and copy-on-write: a tile that is still referenced by a read snapshot is cloned before
+ * its first write, so snapshots never observe a change.
+ */
+class RANCWORLDLAYERS_API FWorldDataLayerTileStore
+{
+public:
+	static constexpr int32 TileSizeLog2 = 6;
+	static constexpr int32 TileSize = 1 << TileSizeLog2;
+	static constexpr int32 TileMask = TileSize - 1;
+	static constexpr int32 PixelsPerTile = TileSize * TileSize;
+
+	/** (Re)allocates the store for the given resolution. Every cell starts out holding DefaultPixel. */
+	void Initialize(const FIntPoint& InResolution, int32 InBytesPerPixel, const uint8* DefaultPixel, bool bInSparse);
+
+	/** Frees all tile memory. */
+	void Reset();
+
+	/** Returns the bytes of the cell at (X, Y). Coordinates must be in bounds. */
+	FORCEINLINE const uint8* GetPixel(int32 X, int32 Y) const
+	{
+		return TileData[GetTileIndex(X, Y)] + GetOffsetInTile(X, Y);
+	}
+
+	/** Returns the writable bytes of the cell at (X, Y), allocating its tile if it is still implicit. */
+	uint8* GetMutablePixel(int32 X, int32 Y);
+
+	/** Writes one cell. Writing the default value into an implicit tile does not allocate it. Returns true if the stored bytes changed. */
+	bool SetPixel(int32 X, int32 Y, const uint8* Pixel);
+
+	/** Copies a rectangle of cells into a tightly laid out destination buffer. */
+	void CopyRect(const FIntRect& Rect, uint8* Dest, int32 DestStride) const;
+
+	/** Writes a rectangle of cells from a source buffer. Parts that only hold the default value do not allocate implicit tiles. */
+	void WriteRect(const FIntRect& Rect, const uint8* Src, int32 SrcStride);
+
+	/**
+	 * Overwrites every cell, one row at a time. RowWriter must encode row Y into OutRow (Resolution.X cells).
+	 * Bands of one tile row are produced in parallel, so RowWriter has to be safe to call concurrently.
+	 * In sparse mode, tiles that come out all-default stay implicit.
+	 */
+	void FillRows(TFunctionRef<void(int32 Y, uint8* OutRow)> RowWriter);
+
+	/** Releases allocated tiles whose contents have returned to the default value. Returns the number of released tiles. */
+	int32 Compact();
+
+	FORCEINLINE int32 GetTileIndex(int32 X, int32 Y) const
+	{
+		return (Y >> TileSizeLog2) * NumTiles.X + (X >> TileSizeLog2);
+	}
+
+	FORCEINLINE int32 GetOffsetInTile(int32 X, int32 Y) const
+	{
+		return (((Y & TileMask) << TileSizeLog2) + (X & TileMask)) * BytesPerPixel;
+	}
+
+	const uint8* GetTileData(int32 TileIndex) const { return TileData[TileIndex]; }
+
+	/** Read pointer per tile, indexed by GetTileIndex. Valid until the store is reinitialized. */
+	const uint8* const* GetTileTable() const { return TileData.GetData(); }
+
+	bool IsTileAllocated(int32 TileIndex) const { return OwnedTiles[TileIndex].IsValid(); }
+
+	/** Shares the current tiles without copying them. Implicit tiles are returned as null references. */
+	const TArray<FWorldDataLayerTileRef>& GetTileRefs() const { return OwnedTiles; }
+	const FWorldDataLayerTileRef& GetDefaultTileRef() const { return DefaultTile; }
+
+	/** Returns the cell rectangle covered by a tile, clipped to the layer resolution. */
+	FIntRect GetTileRect(int32 TileIndex) const;
+
+	const uint8* GetDefaultPixel() const { return DefaultTile->GetData(); }
+	FIntPoint GetResolution() const { return Resolution; }
+	FIntPoint GetNumTilesXY() const { return NumTiles; }
+	int32 GetNumTiles() const { return NumTiles.X * NumTiles.Y; }
+	int32 GetNumAllocatedTiles() const { return NumAllocatedTiles; }
+	int32 GetNumImplicitTiles() const { return GetNumTiles() - NumAllocatedTiles; }
+	int32 GetBytesPerPixel() const { return BytesPerPixel; }
+	int32 GetTileBytes() const { return TileBytes; }
+	bool IsSparse() const { return bSparse; }
+
+	/** Bytes of tile memory currently allocated, including the shared default tile. */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	void AllocateTile(int32 TileIndex);
+	void ReleaseTile(int32 TileIndex);
+
+	/** Returns the tile's memory for writing, allocating an implicit tile or cloning one that a snapshot still shares. */
+	uint8* GetWritableTile(int32 TileIndex);
+	bool IsDefaultRow(const uint8* Row, int32 NumPixels) const;
+	int32 CountAllocatedTiles() const;
+
+	FIntPoint Resolution = FIntPoint::ZeroValue;
+	FIntPoint NumTiles = FIntPoint::ZeroValue;
+	int32 BytesPerPixel = 0;
+	int32 TileBytes = 0;
+	int32 NumAllocatedTiles = 0;
+	bool bSparse = false;
+
+	/** One full tile filled with the default pixel. Implicit tiles point here and must never be written through. */
+	FWorldDataLayerTileRef DefaultTile;
+
+	/** Backing memory per tile. Null for implicit tiles. */
+	TArray<FWorldDataLayerTileRef> OwnedTiles;
+
+	/** Read pointer per tile, either into OwnedTiles or into DefaultTile. */
+	TArray<uint8*> TileData;
+};
@@ -38,6 +38,13 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "World Data")
 	EOutOfBoundsBehavior OutOfBoundsBehavior = EOutOfBoundsBehavior::ReturnDefaultValue;
 
+	/**
+	 * Most bytes of layer data uploaded to the GPU per frame. Larger changes, such as a loaded save game, are spread
+	 * over several frames. Zero uploads every change in the frame it happens.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "World Data", meta = (ClampMin = "0", Units = "Kilobytes"))
+	int32 GpuUploadBudgetPerFrameKB = 16384;
+
 	/** Forces the WorldLayersSubsystem to sync with this volume and populate/initialize layers. */
 	UFUNCTION(BlueprintCallable, CallInEditor, Category = "World Data")
 	void InitializeSubsystem();
@@ -0,0 +1,282 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldDataLayer.h"
+
+/** Compile-time description of how an EDataFormat lays out and converts one cell. */
+template<EDataFormat Format>
+struct TWorldLayerFormatTraits;
+
+template<>
+struct TWorldLayerFormatTraits<EDataFormat::R8>
+{
+	using ChannelType = uint8;
+	static constexpr int32 NumChannels = 1;
+	static constexpr int32 BytesPerPixel = 1;
+
+	static FORCEINLINE float DecodeR(const uint8* Pixel)
+	{
+		return Pixel[0] / 255.0f;
+	}
+
+	static FORCEINLINE FLinearColor Decode(const uint8* Pixel)
+	{
+		return FLinearColor(DecodeR(Pixel), 0.0f, 0.0f, 0.0f);
+	}
+
+	static FORCEINLINE void Encode(const FLinearColor& Value, uint8* OutPixel)
+	{
+		OutPixel[0] = FMath::RoundToInt(Value.R * 255.0f);
+	}
+};
+
+template<>
+struct TWorldLayerFormatTraits<EDataFormat::R16F>
+{
+	using ChannelType = FFloat16;
+	static constexpr int32 NumChannels = 1;
+	static constexpr int32 BytesPerPixel = 2;
+
+	static FORCEINLINE float DecodeR(const uint8* Pixel)
+	{
+		return *((const FFloat16*)Pixel);
+	}
+
+	static FORCEINLINE FLinearColor Decode(const uint8* Pixel)
+	{
+		return FLinearColor(DecodeR(Pixel), 0.0f, 0.0f, 0.0f);
+	}
+
+	static FORCEINLINE void Encode(const FLinearColor& Value, uint8* OutPixel)
+	{
+		*((FFloat16*)OutPixel) = FFloat16(Value.R);
+	}
+};
+
+template<>
+struct TWorldLayerFormatTraits<EDataFormat::RGBA8>
+{
+	using ChannelType = uint8;
+	static constexpr int32 NumChannels = 4;
+	static constexpr int32 BytesPerPixel = 4;
+
+	static FORCEINLINE float DecodeR(const uint8* Pixel)
+	{
+		return Pixel[0] / 255.0f;
+	}
+
+	static FORCEINLINE FLinearColor Decode(const uint8* Pixel)
+	{
+		return FLinearColor(Pixel[0] / 255.0f, Pixel[1] / 255.0f, Pixel[2] / 255.0f, Pixel[3] / 255.0f);
+	}
+
+	static FORCEINLINE void Encode(const FLinearColor& Value, uint8* OutPixel)
+	{
+		OutPixel[0] = FMath::RoundToInt(Value.R * 255.0f);
+		OutPixel[1] = FMath::RoundToInt(Value.G * 255.0f);
+		OutPixel[2] = FMath::RoundToInt(Value.B * 255.0f);
+		OutPixel[3] = FMath::RoundToInt(Value.A * 255.0f);
+	}
+};
+
+template<>
+struct TWorldLayerFormatTraits<EDataFormat::RGBA16F>
+{
+	using ChannelType = FFloat16;
+	static constexpr int32 NumChannels = 4;
+	static constexpr int32 BytesPerPixel = 8;
+
+	static FORCEINLINE float DecodeR(const uint8* Pixel)
+	{
+		return *((const FFloat16*)Pixel);
+	}
+
+	static FORCEINLINE FLinearColor Decode(const uint8* Pixel)
+	{
+		const FFloat16* Channels = (const FFloat16*)Pixel;
+		return FLinearColor(Channels[0], Channels[1], Channels[2], Channels[3]);
+	}
+
+	static FORCEINLINE void Encode(const FLinearColor& Value, uint8* OutPixel)
+	{
+		FFloat16* Channels = (FFloat16*)OutPixel;
+		Channels[0] = FFloat16(Value.R);
+		Channels[1] = FFloat16(Value.G);
+		Channels[2] = FFloat16(Value.B);
+		Channels[3] = FFloat16(Value.A);
+	}
+};
+
+/**
+ * Read accessor for a layer whose DataFormat is known at compile time.
+ * Cell size, decoding and tile addressing are resolved statically, so sampling costs one bounds check and one tile lookup.
+ * The accessor caches the tile table; it must not outlive a Reinitialize of the layer.
+ */
+template<EDataFormat Format>
+class TWorldLayerAccessor
+{
+public:
+	using FormatTraits = TWorldLayerFormatTraits<Format>;
+	using ChannelType = typename FormatTraits::ChannelType;
+
+	explicit TWorldLayerAccessor(const UWorldDataLayer& Layer)
+		: Tiles(Layer.Storage.GetTileTable())
+		, TilesPerRow(Layer.Storage.GetNumTilesXY().X)
+		, Resolution(Layer.Resolution)
+		, DefaultValue(Layer.Config->DefaultValue)
+	{
+		check(Layer.Config->DataFormat == Format);
+	}
+
+	/** Reads from an explicit tile table, e.g. one held by an FWorldLayerSnapshot. */
+	TWorldLayerAccessor(const uint8* const* InTiles, int32 InTilesPerRow, const FIntPoint& InResolution, const FLinearColor& InDefaultValue)
+		: Tiles(InTiles)
+		, TilesPerRow(InTilesPerRow)
+		, Resolution(InResolution)
+		, DefaultValue(InDefaultValue)
+	{
+	}
+
+	FORCEINLINE bool IsValidPixel(int32 X, int32 Y) const
+	{
+		return (uint32)X < (uint32)Resolution.X && (uint32)Y < (uint32)Resolution.Y;
+	}
+
+	/** Returns the raw bytes of a cell. Coordinates must be in bounds. */
+	FORCEINLINE const uint8* GetPixelUnchecked(int32 X, int32 Y) const
+	{
+		constexpr int32 Log2 = FWorldDataLayerTileStore::TileSizeLog2;
+		constexpr int32 Mask = FWorldDataLayerTileStore::TileMask;
+		const uint8* Tile = Tiles[(Y >> Log2) * TilesPerRow + (X >> Log2)];
+		return Tile + (((Y & Mask) << Log2) + (X & Mask)) * FormatTraits::BytesPerPixel;
+	}
+
+	/** Returns the typed channels of a cell. Coordinates must be in bounds. */
+	FORCEINLINE const ChannelType* GetChannelsUnchecked(int32 X, int32 Y) const
+	{
+		return reinterpret_cast<const ChannelType*>(GetPixelUnchecked(X, Y));
+	}
+
+	FORCEINLINE FLinearColor Get(int32 X, int32 Y) const
+	{
+		return IsValidPixel(X, Y) ? FormatTraits::Decode(GetPixelUnchecked(X, Y)) : DefaultValue;
+	}
+
+	FORCEINLINE float GetR(int32 X, int32 Y) const
+	{
+		return IsValidPixel(X, Y) ? FormatTraits::DecodeR(GetPixelUnchecked(X, Y)) : DefaultValue.R;
+	}
+
+	/** Bilinear sample in continuous pixel space, where integer coordinates are cell centers. */
+	FORCEINLINE FLinearColor GetBilinear(float PixelX, float PixelY) const
+	{
+		const int32 X0 = FMath::FloorToInt(PixelX);
+		const int32 Y0 = FMath::FloorToInt(PixelY);
+		const float FracX = PixelX - (float)X0;
+		const float FracY = PixelY - (float)Y0;
+		return FMath::BiLerp(Get(X0, Y0), Get(X0 + 1, Y0), Get(X0, Y0 + 1), Get(X0 + 1, Y0 + 1), FracX, FracY);
+	}
+
+	FIntPoint GetResolution() const { return Resolution; }
+	const FLinearColor& GetDefaultValue() const { return DefaultValue; }
+
+private:
+	const uint8* const* Tiles;
+	int32 TilesPerRow;
+	FIntPoint Resolution;
+	FLinearColor DefaultValue;
+};
+
+/**
+ * World-to-pixel mapping of one layer, resolved once so hot loops skip the per-query layer lookup and cell size math.
+ * Uses the same division as UWorldLayersSubsystem::WorldLocationToPixel, so results match it bit for bit.
+ */
+struct FWorldLayerPixelTransform
+{
+	FVector2D Origin = FVector2D::ZeroVector;
+	FVector2D CellSize = FVector2D::UnitVector;
+	FIntPoint Resolution = FIntPoint::ZeroValue;
+	bool bClampToEdge = false;
+
+	/** Continuous pixel coordinates, where integer values are cell corners. */
+	FORCEINLINE FVector2D ToPixelContinuous(const FVector2D& WorldLocation) const
+	{
+		return FVector2D((WorldLocation.X - Origin.X) / CellSize.X, (WorldLocation.Y - Origin.Y) / CellSize.Y);
+	}
+
+	FORCEINLINE FIntPoint ClampIfNeeded(int32 PixelX, int32 PixelY) const
+	{
+		if (bClampToEdge)
+		{
+			PixelX = FMath::Clamp(PixelX, 0, Resolution.X - 1);
+			PixelY = FMath::Clamp(PixelY, 0, Resolution.Y - 1);
+		}
+		return FIntPoint(PixelX, PixelY);
+	}
+
+	FORCEINLINE FIntPoint ToPixel(const FVector2D& WorldLocation) const
+	{
+		const FVector2D Continuous = ToPixelContinuous(WorldLocation);
+		return ClampIfNeeded(FMath::FloorToInt(Continuous.X), FMath::FloorToInt(Continuous.Y));
+	}
+
+	/** World location of the center of a cell. */
+	FORCEINLINE FVector2D ToWorld(const FIntPoint& Pixel) const
+	{
+		return FVector2D((Pixel.X + 0.5) * CellSize.X + Origin.X, (Pixel.Y + 0.5) * CellSize.Y + Origin.Y);
+	}
+};
+
+/**
+ * Converts world locations to continuous pixel coordinates in chunks and hands each chunk to Func.
+ * FVector2D is two packed doubles, so one vector register holds two locations.
+ */
+template<typename FuncType>
+void ForEachPixelCoordinateChunk(const FWorldLayerPixelTransform& Transform, TConstArrayView<FVector2D> Locations, FuncType&& Func)
+{
+	constexpr int32 ChunkSize = 256;
+	alignas(16) double PixelCoords[ChunkSize * 2];
+
+	const VectorRegister4Double Origin = MakeVectorRegisterDouble(Transform.Origin.X, Transform.Origin.Y, Transform.Origin.X, Transform.Origin.Y);
+	const VectorRegister4Double CellSize = MakeVectorRegisterDouble(Transform.CellSize.X, Transform.CellSize.Y, Transform.CellSize.X, Transform.CellSize.Y);
+	const double* Source = reinterpret_cast<const double*>(Locations.GetData());
+
+	for (int32 ChunkStart = 0; ChunkStart < Locations.Num(); ChunkStart += ChunkSize)
+	{
+		const int32 ChunkNum = FMath::Min(ChunkSize, Locations.Num() - ChunkStart);
+		const double* ChunkSource = Source + ChunkStart * 2;
+
+		int32 Index = 0;
+		for (; Index + 1 < ChunkNum; Index += 2)
+		{
+			const VectorRegister4Double World = VectorLoad(ChunkSource + Index * 2);
+			VectorStore(VectorDivide(VectorSubtract(World, Origin), CellSize), PixelCoords + Index * 2);
+		}
+		if (Index < ChunkNum)
+		{
+			const FVector2D Continuous = Transform.ToPixelContinuous(Locations[ChunkStart + Index]);
+			PixelCoords[Index * 2] = Continuous.X;
+			PixelCoords[Index * 2 + 1] = Continuous.Y;
+		}
+
+		Func(ChunkStart, ChunkNum, PixelCoords);
+	}
+}
+
+/** Resolves the layer's DataFormat once and invokes Func with the matching TWorldLayerAccessor. */
+template<typename FuncType>
+FORCEINLINE decltype(auto) VisitWorldLayerAccessor(const UWorldDataLayer& Layer, FuncType&& Func)
+{
+	switch (Layer.Config->DataFormat)
+	{
+		case EDataFormat::R16F:
+			return Func(TWorldLayerAccessor<EDataFormat::R16F>(Layer));
+		case EDataFormat::RGBA8:
+			return Func(TWorldLayerAccessor<EDataFormat::RGBA8>(Layer));
+		case EDataFormat::RGBA16F:
+			return Func(TWorldLayerAccessor<EDataFormat::RGBA16F>(Layer));
+		case EDataFormat::R8:
+		default:
+			return Func(TWorldLayerAccessor<EDataFormat::R8>(Layer));
+	}
+}
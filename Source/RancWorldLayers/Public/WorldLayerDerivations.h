@@ -0,0 +1,207 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldLayerSnapshot.h"
+#include "WorldDataLayerAsset.h"
+
+/** DerivationMethod names that the subsystem computes itself, without a registered kernel or provider. */
+struct RANCWORLDLAYERS_API FWorldLayerBuiltInDerivations
+{
+	/**
+	 * Distance in world units from each cell to the nearest feature cell of SourceLayerNames[0], where features are the
+	 * cells inside FWorldDataLayerDistanceFieldSettings::FeatureRange. Kept up to date incrementally as the source changes.
+	 */
+	static const FName DistanceField;
+
+	/** Coordinates of the nearest feature cell, packed by FWorldLayerNearestFeatureCodec. The layer must be RGBA8. */
+	static const FName NearestFeature;
+
+	static bool IsBuiltIn(FName DerivationMethod)
+	{
+		return DerivationMethod == DistanceField || DerivationMethod == NearestFeature;
+	}
+};
+
+/**
+ * Image-processing derivations, configured by the layer's ImageOp settings. Unlike FWorldLayerBuiltInDerivations they are
+ * ordinary kernels that every subsystem registers on Initialize, so a project may replace one with
+ * RegisterDerivationKernel or remove it with UnregisterDerivation.
+ * They process every channel of the layer's format and read sources at the layer's cell coordinates. Blurs, Dilate,
+ * Erode and GradientMagnitude clamp reads at the layer border.
+ */
+struct RANCWORLDLAYERS_API FWorldLayerImageOpDerivations
+{
+	static const FName BoxBlur;
+	static const FName GaussianBlur;
+
+	/** Maximum (Dilate) or minimum (Erode) over the square window. */
+	static const FName Dilate;
+	static const FName Erode;
+
+	static const FName Threshold;
+	static const FName RemapCurve;
+
+	/** Weighted sum, minimum and maximum over all source layers. */
+	static const FName WeightedSum;
+	static const FName Minimum;
+	static const FName Maximum;
+
+	/** Length of the central-difference gradient of the first source, in value per world unit. */
+	static const FName GradientMagnitude;
+
+	/**
+	 * The three heaviest of the biome-weight source layers, packed by FWorldLayerDominant3Codec for
+	 * UMaterialExpressionWorldLayerDominant3Sample. A biome's ID is the index of its source. The layer must be RGBA8.
+	 */
+	static const FName Dominant3;
+};
+
+/** Packs cell coordinates into an RGBA8 cell: X into R (low byte) and G (high byte), Y into B and A. */
+struct FWorldLayerNearestFeatureCodec
+{
+	/** Stored in both coordinates while the source has no feature at all. Coordinates must stay below it. */
+	static constexpr int32 NoFeature = 0xFFFF;
+
+	static FORCEINLINE void Encode(const FIntPoint& Cell, uint8* OutPixel)
+	{
+		const int32 X = Cell.X == INDEX_NONE ? NoFeature : Cell.X;
+		const int32 Y = Cell.Y == INDEX_NONE ? NoFeature : Cell.Y;
+		OutPixel[0] = (uint8)(X & 0xFF);
+		OutPixel[1] = (uint8)(X >> 8);
+		OutPixel[2] = (uint8)(Y & 0xFF);
+		OutPixel[3] = (uint8)(Y >> 8);
+	}
+
+	/** Returns (INDEX_NONE, INDEX_NONE) if the cell records no feature. */
+	static FORCEINLINE FIntPoint Decode(const uint8* Pixel)
+	{
+		const int32 X = Pixel[0] | (Pixel[1] << 8);
+		const int32 Y = Pixel[2] | (Pixel[3] << 8);
+		return X == NoFeature ? FIntPoint(INDEX_NONE, INDEX_NONE) : FIntPoint(X, Y);
+	}
+
+	/** Decodes a value read through the generic FLinearColor path. */
+	static FORCEINLINE FIntPoint Decode(const FLinearColor& Value)
+	{
+		const uint8 Pixel[4] = {
+			(uint8)FMath::RoundToInt(Value.R * 255.0f), (uint8)FMath::RoundToInt(Value.G * 255.0f),
+			(uint8)FMath::RoundToInt(Value.B * 255.0f), (uint8)FMath::RoundToInt(Value.A * 255.0f)};
+		return Decode(Pixel);
+	}
+};
+
+/** Three biomes of a Dominant3 cell, heaviest first, with weights that sum to one. */
+struct FWorldLayerDominant3Sample
+{
+	uint8 Biomes[3] = {0, 0, 0};
+	float Weights[3] = {1.0f, 0.0f, 0.0f};
+};
+
+/**
+ * Cell format of the Dominant3 derivation, matching UMaterialExpressionWorldLayerDominant3Sample: biome IDs in R, G and
+ * B, and the first two weights in fifteenths in the high and low nibble of A. The third weight is what remains of one.
+ */
+struct FWorldLayerDominant3Codec
+{
+	/** Weights must be sorted heaviest first and sum to one. Biomes without weight take the ID of the first biome. */
+	static FORCEINLINE void Encode(const uint8 Biomes[3], const float Weights[3], uint8* OutPixel)
+	{
+		const int32 Q1 = FMath::Clamp(FMath::RoundToInt(Weights[0] * 15.0f), 0, 15);
+		const int32 Q2 = FMath::Clamp(FMath::RoundToInt(Weights[1] * 15.0f), 0, 15 - Q1);
+		const int32 Q3 = 15 - Q1 - Q2;
+		OutPixel[0] = Biomes[0];
+		OutPixel[1] = Q2 > 0 ? Biomes[1] : Biomes[0];
+		OutPixel[2] = Q3 > 0 ? Biomes[2] : Biomes[0];
+		OutPixel[3] = (uint8)((Q1 << 4) | Q2);
+	}
+
+	static FORCEINLINE FWorldLayerDominant3Sample Decode(const uint8* Pixel)
+	{
+		FWorldLayerDominant3Sample Sample;
+		Sample.Biomes[0] = Pixel[0];
+		Sample.Biomes[1] = Pixel[1];
+		Sample.Biomes[2] = Pixel[2];
+		Sample.Weights[0] = (Pixel[3] >> 4) / 15.0f;
+		Sample.Weights[1] = (Pixel[3] & 0x0F) / 15.0f;
+		Sample.Weights[2] = 1.0f - Sample.Weights[0] - Sample.Weights[1];
+		return Sample;
+	}
+
+	/** Decodes a value read through the generic FLinearColor path. */
+	static FORCEINLINE FWorldLayerDominant3Sample Decode(const FLinearColor& Value)
+	{
+		uint8 Pixel[4];
+		TWorldLayerFormatTraits<EDataFormat::RGBA8>::Encode(Value, Pixel);
+		return Decode(Pixel);
+	}
+};
+
+/**
+ * Inputs of a derivation kernel. Sources are immutable snapshots taken when the derivation started, in the order of
+ * SourceLayerNames, so a kernel can read them from any thread. Use VisitWorldLayerAccessor or MakeAccessor for typed reads.
+ */
+struct FWorldLayerDerivationInputs
+{
+	FName TargetLayerName;
+	TArray<FWorldLayerSnapshotPtr> Sources;
+
+	/** Copy of the target's ImageOp settings. Its RemapCurve is already sampled into RemapTable, evenly over the input range. */
+	FWorldDataLayerImageOpSettings ImageOp;
+	TArray<float> RemapTable;
+};
+
+/**
+ * View of the encoded cells of a rectangle of a derivative layer, filled by a derivation kernel and written to the layer
+ * by the subsystem afterwards. Cells start out holding the layer's default value. Coordinates are cells of the layer.
+ * Views of disjoint rectangles of one buffer can be filled concurrently.
+ */
+class RANCWORLDLAYERS_API FWorldLayerDerivationOutput
+{
+public:
+	/** Data holds InRect.Height() rows of InRect.Width() cells, Stride bytes apart. */
+	FWorldLayerDerivationOutput(EDataFormat InDataFormat, const FIntRect& InRect, uint8* InData, int32 InStride);
+
+	static int32 GetBytesPerPixel(EDataFormat DataFormat);
+
+	EDataFormat GetDataFormat() const { return DataFormat; }
+	const FIntRect& GetRect() const { return Rect; }
+	int32 GetBytesPerPixel() const { return BytesPerPixel; }
+	int32 GetStride() const { return Stride; }
+
+	/** Returns a view of the cells of SubRect, which must lie inside GetRect(). */
+	FWorldLayerDerivationOutput Slice(const FIntRect& SubRect) const;
+
+	/** Returns the bytes of a cell. The cell must be inside GetRect(). */
+	FORCEINLINE uint8* GetPixel(int32 X, int32 Y) const
+	{
+		checkSlow(Rect.Contains(FIntPoint(X, Y)));
+		return Data + (SIZE_T)(Y - Rect.Min.Y) * Stride + (X - Rect.Min.X) * BytesPerPixel;
+	}
+
+	/** Encodes a value for an output whose DataFormat is known at compile time. */
+	template<EDataFormat Format>
+	FORCEINLINE void Set(int32 X, int32 Y, const FLinearColor& Value) const
+	{
+		checkSlow(DataFormat == Format);
+		TWorldLayerFormatTraits<Format>::Encode(Value, GetPixel(X, Y));
+	}
+
+	void SetValue(int32 X, int32 Y, const FLinearColor& Value) const;
+
+private:
+	EDataFormat DataFormat;
+	FIntRect Rect;
+	int32 BytesPerPixel;
+	int32 Stride;
+	uint8* Data;
+};
+
+/**
+ * Native derivation, registered with UWorldLayersSubsystem::RegisterDerivationKernel for a DerivationMethod.
+ * Must compute every cell of the output from the inputs alone, without touching UObjects, as it may run on any thread
+ * and concurrently with other parts of the same layer. The output usually covers only the tiles that a change affected.
+ */
+using FWorldLayerDerivationKernel = TFunction<void(const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)>;
+
+/** Returns how many cells around an output cell a kernel reads from its sources, for a given target layer. */
+using FWorldLayerDerivationHalo = TFunction<int32(const UWorldDataLayerAsset& Config)>;
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldDataLayerAsset.h"
+
+/**
+ * Texel layout of a layer's GPU texture. R8, R16F and RGBA16F texels hold the same bytes as the CPU cells; RGBA8 layers
+ * live in PF_B8G8R8A8 textures, so red and blue swap places on the way up and back down.
+ */
+struct RANCWORLDLAYERS_API FWorldLayerGpuFormat
+{
+	static EPixelFormat GetPixelFormat(EDataFormat DataFormat);
+
+	/** Bytes per texel, equal to the bytes per cell of the layer format. */
+	static int32 GetBytesPerTexel(EDataFormat DataFormat);
+
+	/** Converts Size texels, SrcPitch bytes per row apart, into cells in the layer encoding, DstStride bytes per row apart. */
+	static void ConvertFromGpu(EDataFormat DataFormat, const uint8* Src, int64 SrcPitch, const FIntPoint& Size, uint8* Dst, int64 DstStride);
+
+	/** True if the texels differ from the layer encoding, so uploads cannot read the layer's cells in place. */
+	static bool NeedsConversion(EDataFormat DataFormat) { return DataFormat == EDataFormat::RGBA8; }
+
+	/** Converts NumCells cells in the layer encoding into texels, in place. */
+	static void ConvertToGpu(EDataFormat DataFormat, uint8* Data, int64 NumCells);
+};
+
+/** Cells read back from a layer's GPU texture. */
+struct RANCWORLDLAYERS_API FWorldLayerReadbackResult
+{
+	bool bSucceeded = false;
+
+	/** Requested cells, clipped to the layer. */
+	FIntRect Rect;
+
+	EDataFormat DataFormat = EDataFormat::R8;
+
+	/** Cells in the layer's CPU encoding, Rect.Width() per row, packed back to back. */
+	TArray64<uint8> Data;
+
+	/** Decodes the cell at Pixel, in layer coordinates. Pixel must lie inside Rect. Returns black if the readback failed. */
+	FLinearColor GetValue(const FIntPoint& Pixel) const;
+};
+
+/** GPU texels of a finished transfer, RowPitch bytes per row apart. */
+struct FWorldLayerReadbackTexels
+{
+	TArray64<uint8> Data;
+	int64 RowPitch = 0;
+};
+
+enum class EWorldLayerReadbackPoll : uint8
+{
+	Pending,
+	Ready,
+	Failed
+};
+
+/**
+ * One copy of a texture region into CPU memory, in flight. The subsystem polls it once per tick on the game thread and
+ * converts the texels to the layer format itself, so a transfer only moves bytes.
+ */
+class IWorldLayerReadbackTransfer
+{
+public:
+	virtual ~IWorldLayerReadbackTransfer() = default;
+
+	/** Returns Ready once OutTexels holds the region, in the layout of FWorldLayerGpuFormat. Never blocks. */
+	virtual EWorldLayerReadbackPoll Poll(FWorldLayerReadbackTexels& OutTexels) = 0;
+};
+
+/** Starts a transfer of Rect of a layer's GPU texture, or returns null if the layer has nothing to read back from. */
+using FWorldLayerReadbackTransferFactory = TFunction<TUniquePtr<IWorldLayerReadbackTransfer>(const class UWorldDataLayer& Layer, const FIntRect& Rect)>;
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldLayerAccessor.h"
+#include <atomic>
+
+/**
+ * Epoch-based reclamation for objects that lock-free readers may still be looking at.
+ * Readers bracket their access with Enter/Exit (see FWorldLayerEpochScope), which only stores the current epoch into a
+ * per-thread record. Writers hand replaced objects to Retire; Reclaim frees them once every thread that could have
+ * observed them has left its read section. Readers never block and never wait for writers.
+ */
+class RANCWORLDLAYERS_API FWorldLayerEpochDomain
+{
+public:
+	static FWorldLayerEpochDomain& Get();
+
+	/** Starts a read section on the calling thread. Sections nest. */
+	void Enter();
+
+	/** Ends the innermost read section on the calling thread. */
+	void Exit();
+
+	/** Schedules Deleter to run once no read section that started before this call is still active. */
+	void Retire(TUniqueFunction<void()>&& Deleter);
+
+	/** Runs the deleters of retired objects that no reader can reach anymore. Returns how many ran. */
+	int32 Reclaim();
+
+	/** Number of retired objects still waiting for readers to leave. */
+	int32 GetNumPendingRetired() const;
+
+	~FWorldLayerEpochDomain();
+
+private:
+	struct FThreadRecord
+	{
+		/** Epoch observed when the outermost read section started. 0 while the thread is outside any read section. */
+		std::atomic<uint64> Epoch{0};
+		std::atomic<bool> bInUse{false};
+		int32 Depth = 0;
+		FThreadRecord* Next = nullptr;
+	};
+
+	struct FRetired
+	{
+		uint64 Epoch;
+		TUniqueFunction<void()> Deleter;
+	};
+
+	FWorldLayerEpochDomain() = default;
+
+	FThreadRecord& GetThreadRecord();
+	uint64 GetOldestActiveEpoch() const;
+
+	std::atomic<uint64> GlobalEpoch{1};
+
+	/** Records are pushed once and never unlinked; a thread that exits releases its record for reuse. */
+	std::atomic<FThreadRecord*> Records{nullptr};
+
+	mutable FCriticalSection RetiredLock;
+	TArray<FRetired> Retired;
+
+	friend struct FWorldLayerThreadRecordOwner;
+};
+
+/** Keeps the calling thread inside a read section of the epoch domain for its lifetime. */
+struct FWorldLayerEpochScope
+{
+	FWorldLayerEpochScope() { FWorldLayerEpochDomain::Get().Enter(); }
+	~FWorldLayerEpochScope() { FWorldLayerEpochDomain::Get().Exit(); }
+
+	UE_NONCOPYABLE(FWorldLayerEpochScope);
+};
+
+/**
+ * Immutable copy of a layer's cells and world mapping at one revision, safe to sample from any thread.
+ * Tiles are shared with the layer rather than copied; the layer clones a tile before writing to it while a snapshot
+ * still holds it, so a snapshot never changes after it was published.
+ */
+class RANCWORLDLAYERS_API FWorldLayerSnapshot
+{
+public:
+	FWorldLayerSnapshot(const UWorldDataLayer& Layer, const FWorldLayerPixelTransform& InTransform);
+
+	FName GetLayerName() const { return LayerName; }
+	EDataFormat GetDataFormat() const { return DataFormat; }
+	FIntPoint GetResolution() const { return Resolution; }
+	const FWorldLayerPixelTransform& GetPixelTransform() const { return Transform; }
+
+	/** Layer revision the snapshot was taken at. */
+	uint32 GetRevision() const { return Revision; }
+
+	/** Layer generation the snapshot was taken at. */
+	uint32 GetGeneration() const { return Generation; }
+
+	FLinearColor GetValueAtPixel(const FIntPoint& PixelCoords) const;
+	bool GetValueAtLocation(const FVector2D& WorldLocation, FLinearColor& OutValue) const;
+	float GetFloatValueAtLocation(const FVector2D& WorldLocation) const;
+
+	/** Batched GetValueAtLocation. OutValues must have the same length as Locations. */
+	void GetValuesAtLocations(TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const;
+
+	template<EDataFormat Format>
+	TWorldLayerAccessor<Format> MakeAccessor() const
+	{
+		check(DataFormat == Format);
+		return TWorldLayerAccessor<Format>(TileTable.GetData(), NumTilesX, Resolution, DefaultValue);
+	}
+
+private:
+	FName LayerName;
+	EDataFormat DataFormat;
+	FIntPoint Resolution;
+	int32 NumTilesX;
+	FLinearColor DefaultValue;
+	FWorldLayerPixelTransform Transform;
+	uint32 Revision;
+	uint32 Generation;
+
+	/** Keeps the shared tiles alive. Implicit tiles are null and read from DefaultTile. */
+	TArray<FWorldDataLayerTileRef> Tiles;
+	FWorldDataLayerTileRef DefaultTile;
+
+	/** Read pointer per tile, into Tiles or DefaultTile. */
+	TArray<const uint8*> TileTable;
+};
+
+/** Resolves the snapshot's DataFormat once and invokes Func with the matching TWorldLayerAccessor. */
+template<typename FuncType>
+FORCEINLINE decltype(auto) VisitWorldLayerAccessor(const FWorldLayerSnapshot& Snapshot, FuncType&& Func)
+{
+	switch (Snapshot.GetDataFormat())
+	{
+		case EDataFormat::R16F:
+			return Func(Snapshot.MakeAccessor<EDataFormat::R16F>());
+		case EDataFormat::RGBA8:
+			return Func(Snapshot.MakeAccessor<EDataFormat::RGBA8>());
+		case EDataFormat::RGBA16F:
+			return Func(Snapshot.MakeAccessor<EDataFormat::RGBA16F>());
+		case EDataFormat::R8:
+		default:
+			return Func(Snapshot.MakeAccessor<EDataFormat::R8>());
+	}
+}
+
+using FWorldLayerSnapshotPtr = TSharedPtr<const FWorldLayerSnapshot, ESPMode::ThreadSafe>;
+
+/**
+ * The most recently published snapshot of one layer. Owned by the layer and shared with worker threads, which keep a
+ * reference to the channel and call Acquire whenever they want the latest data.
+ * Acquire is lock-free: it reads the current snapshot inside an epoch read section and takes a reference to it.
+ * Publish swaps the snapshot in and retires the previous one through FWorldLayerEpochDomain.
+ */
+class RANCWORLDLAYERS_API FWorldLayerSnapshotChannel
+{
+public:
+	FWorldLayerSnapshotChannel() = default;
+	~FWorldLayerSnapshotChannel();
+
+	UE_NONCOPYABLE(FWorldLayerSnapshotChannel);
+
+	/** Returns the latest snapshot, or null if none was published yet. Safe to call from any thread. */
+	FWorldLayerSnapshotPtr Acquire() const;
+
+	/** Replaces the current snapshot. Must only be called by the owning layer's thread (the game thread). */
+	void Publish(FWorldLayerSnapshotPtr Snapshot);
+
+private:
+	std::atomic<FWorldLayerSnapshotPtr*> Current{nullptr};
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Size and health of spatial indices, for monitoring. Counts add up when reported for several indices. */
+struct FWorldLayerSpatialIndexStats
+{
+	/** Cells held by the indices. */
+	int32 NumPoints = 0;
+
+	/** Structural units in use: tree nodes for quadtrees, allocated 64x64 cell pages for occupancy pyramids. */
+	int32 NumNodes = 0;
+
+	/** Structural units released by removals and pooled for reuse. */
+	int32 NumFreeNodes = 0;
+
+	SIZE_T AllocatedBytes = 0;
+
+	FWorldLayerSpatialIndexStats& operator+=(const FWorldLayerSpatialIndexStats& Other)
+	{
+		NumPoints += Other.NumPoints;
+		NumNodes += Other.NumNodes;
+		NumFreeNodes += Other.NumFreeNodes;
+		AllocatedBytes += Other.AllocatedBytes;
+		return *this;
+	}
+};
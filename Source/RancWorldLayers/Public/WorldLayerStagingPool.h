@@ -0,0 +1,93 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldDataLayerTileStore.h"
+#include "WorldDataLayerAsset.h"
+#include <atomic>
+
+/** One rectangle of texels to upload and where the render command reads it from. */
+struct FWorldLayerStagingRegion
+{
+	FIntRect Rect;
+	const uint8* Data = nullptr;
+	int32 Pitch = 0;
+};
+
+/**
+ * Staging memory handed from the game thread to a render command. The game thread fills it, the render command reads it
+ * and calls Release once it is done, after which the pool hands the block out again.
+ * Regions may also point into shared layer tiles instead of the block's own memory; SharedTiles keeps those alive and
+ * unchanged until Release, since the tile store clones a shared tile before writing to it.
+ */
+class FWorldLayerStagingBlock
+{
+public:
+	uint8* GetData() { return Memory.GetData(); }
+	const uint8* GetData() const { return Memory.GetData(); }
+
+	/** Bytes requested by the last Acquire. The block may hold more. */
+	int64 GetSize() const { return Size; }
+
+	/** Regions to upload and the tiles they read from. Emptied by Acquire and Release, keeping their capacity. */
+	TArray<FWorldLayerStagingRegion> Regions;
+	TArray<FWorldDataLayerTileRef> SharedTiles;
+
+	/** Signals the pool that the consumer no longer reads the block. Safe to call from any thread. */
+	void Release()
+	{
+		SharedTiles.Reset();
+		bInFlight.store(false, std::memory_order_release);
+	}
+
+	bool IsInFlight() const { return bInFlight.load(std::memory_order_acquire); }
+
+private:
+	friend class FWorldLayerStagingPool;
+
+	TArray64<uint8> Memory;
+	int64 Size = 0;
+	std::atomic<bool> bInFlight{false};
+};
+
+struct FWorldLayerStagingStats
+{
+	int32 NumBlocks = 0;
+	int32 BlocksInFlight = 0;
+	int64 ReservedBytes = 0;
+
+	/** Times a block was created or grown. Stays put once uploads reach a steady state. */
+	int32 NumAllocations = 0;
+};
+
+/**
+ * Recycles staging blocks for CPU to GPU copies so steady-state uploads do not touch the heap. Acquire hands out the
+ * smallest released block that fits, grows a released one when none fits, and only creates a block when every block
+ * is still in flight. Acquire and Reset belong to the game thread; Release may come from the render thread.
+ */
+class RANCWORLDLAYERS_API FWorldLayerStagingPool
+{
+public:
+	~FWorldLayerStagingPool();
+
+	/** Returns a block of at least Bytes, marked in flight until its consumer calls Release. */
+	FWorldLayerStagingBlock& Acquire(int64 Bytes);
+
+	/**
+	 * Acquires a block holding Regions of Storage in the GPU layout of DataFormat. Formats the GPU stores as-is are not
+	 * copied: the regions point into the tiles, which the block shares until Release. Others are packed back to back
+	 * into the block's memory and converted there.
+	 */
+	FWorldLayerStagingBlock& Stage(const FWorldDataLayerTileStore& Storage, EDataFormat DataFormat, TConstArrayView<FIntRect> Regions);
+
+	bool HasBlocksInFlight() const;
+
+	/** Frees every block. No block may be in flight, so flush the render commands first. */
+	void Reset();
+
+	FWorldLayerStagingStats GetStats() const;
+
+private:
+	/** Owned through pointers so blocks stay put while render commands hold them. */
+	TArray<TUniquePtr<FWorldLayerStagingBlock>> Blocks;
+	int32 NumAllocations = 0;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Receives the regions the upload scheduler releases. The subsystem's sink copies them to the layers' GPU textures. */
+class IWorldLayerUploadSink
+{
+public:
+	virtual ~IWorldLayerUploadSink() = default;
+
+	virtual void Upload(FName LayerName, const FIntRect& Region) = 0;
+};
+
+struct FWorldLayerUploadStats
+{
+	/** Regions and bytes still waiting for upload. */
+	int32 QueuedRegions = 0;
+	int64 QueuedBytes = 0;
+
+	/** Released by the last Flush. */
+	int32 RegionsLastFrame = 0;
+	int64 BytesLastFrame = 0;
+};
+
+/**
+ * Spreads CPU to GPU uploads over frames under a byte budget. Each Flush releases queued regions in priority order
+ * until the budget is spent, splitting a region into bands of rows when it does not fit. A region's priority rises by
+ * one for every frame it waits, so busy high-priority layers delay lower ones but never starve them; equal priorities
+ * go oldest first. The first region of a frame always releases at least one row, so every frame makes progress.
+ */
+class RANCWORLDLAYERS_API FWorldLayerUploadScheduler
+{
+public:
+	/** Bytes released per Flush. Zero or less releases everything. */
+	void SetBudget(int64 InBytesPerFrame) { BytesPerFrame = InBytesPerFrame; }
+	int64 GetBudget() const { return BytesPerFrame; }
+
+	/**
+	 * Queues Region of a layer. Higher priorities go first. A region inside one already queued for the layer is dropped,
+	 * and queued regions inside the new one are absorbed by it, keeping the oldest wait time.
+	 */
+	void Enqueue(FName LayerName, const FIntRect& Region, int32 BytesPerPixel, int32 Priority);
+
+	/** Drops everything queued for a layer, e.g. when it is reinitialized or removed. */
+	void RemoveLayer(FName LayerName);
+
+	void Reset();
+
+	/** Releases queued regions to Sink within the budget. Call once per frame. Returns the bytes released. */
+	int64 Flush(IWorldLayerUploadSink& Sink);
+
+	/** Whether a layer has regions waiting, i.e. its GPU texture is behind its CPU data. */
+	bool IsLayerQueued(FName LayerName) const;
+
+	/** Releases everything queued for a layer to Sink, ignoring the budget. Returns the bytes released. */
+	int64 FlushLayer(FName LayerName, IWorldLayerUploadSink& Sink);
+
+	FWorldLayerUploadStats GetStats() const;
+
+private:
+	struct FEntry
+	{
+		FName LayerName;
+		FIntRect Region;
+		int32 BytesPerPixel = 0;
+		int32 Priority = 0;
+
+		/** Frame of the first enqueue, for aging, and a sequence number that orders equal priorities. */
+		uint64 EnqueueFrame = 0;
+		uint64 Sequence = 0;
+
+		int64 GetBytes() const { return (int64)Region.Width() * Region.Height() * BytesPerPixel; }
+	};
+
+	TArray<FEntry> Queue;
+	int64 BytesPerFrame = 0;
+	uint64 Frame = 0;
+	uint64 NextSequence = 0;
+	int32 RegionsLastFrame = 0;
+	int64 BytesLastFrame = 0;
+};
@@ -96,6 +96,7 @@ private:
 	// Optimization tracking for 3D visualization
 	FName LastLayerName;
 	EWorldLayers3DMode LastLoggedMode = EWorldLayers3DMode::None;
+	uint32 LastLayerRevision = 0;
 
 	void HandleDebugInput();
 	void PositionActor();
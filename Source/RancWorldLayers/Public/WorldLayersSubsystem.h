@@ -3,14 +3,22 @@
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "WorldDataLayer.h"
+#include "WorldLayerAccessor.h"
+#include "WorldLayerDerivations.h"
+#include "WorldLayerReadback.h"
+#include "WorldLayerStagingPool.h"
+#include "WorldLayerUploadScheduler.h"
 
 #include "Async/Async.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
 #include "RenderGraphUtils.h"
 #include "RHI.h"
 #include "RHICommandList.h"
 #include "RHIResources.h"
 
 class UWorldDataLayerAsset;
+class FWorldLayerSnapshotChannel;
 class AWorldDataVolume;
 class AWorldLayersDebugActor;
 
@@ -18,7 +26,30 @@ class AWorldLayersDebugActor;
 
 DECLARE_MULTICAST_DELEGATE(FOnWorldLayersRequestUpdate);
 
-/** Generic interface for project-level actors to provide logic for Derivative layers. */
+/** Layers of one resolution and format packed into the slices of one texture. */
+USTRUCT()
+struct FWorldLayerTextureArray
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<class UTexture2DArray> Texture;
+
+	/** Uploads land here and are copied into their slice, as the RHI cannot update a region of one array slice. */
+	UPROPERTY()
+	TObjectPtr<class UTexture2D> Scratch;
+
+	EDataFormat DataFormat = EDataFormat::R8;
+	FIntPoint Resolution = FIntPoint::ZeroValue;
+
+	/** Member layers, by slice. NAME_None marks a free slice, left by a layer that moved out and reused by the next to join. */
+	TArray<FName> Slices;
+};
+
+/**
+ * Generic interface for project-level objects to provide logic for Derivative layers on the game thread.
+ * Providers are registered per DerivationMethod with UWorldLayersSubsystem::RegisterDerivationProvider.
+ */
 UINTERFACE(MinimalAPI, Blueprintable)
 class UWorldLayersDerivationProvider : public UInterface
 {
@@ -31,7 +62,52 @@ class RANCWORLDLAYERS_API IWorldLayersDerivationProvider
 
 public:
 	/** Called by the subsystem to allow this provider to populate a derivative layer. Return true if handled. */
-	virtual bool OnDeriveLayer(FName LayerName) { return false; }
+	UFUNCTION(BlueprintNativeEvent, Category = "RancWorldLayers")
+	bool OnDeriveLayer(FName LayerName);
+	virtual bool OnDeriveLayer_Implementation(FName LayerName) { return false; }
+};
+
+/**
+ * Persistent reference to a registered layer for hot paths, obtained once from UWorldLayersSubsystem::GetLayerHandle.
+ * Caches the layer and its world-to-pixel mapping so queries skip the FName lookup and the cell size math. The cache
+ * refreshes itself when the layer is reinitialized or the subsystem's layers are re-registered, so a handle can be
+ * kept for the lifetime of its owner. The refresh writes to the handle, so every thread should use its own copy.
+ */
+struct RANCWORLDLAYERS_API FWorldLayerHandle
+{
+	FWorldLayerHandle() = default;
+
+	FName GetLayerName() const { return LayerName; }
+
+	/** True if the handle was obtained for a layer name. Does not guarantee that the layer is still registered. */
+	bool IsSet() const { return !LayerName.IsNone(); }
+
+private:
+	friend class UWorldLayersSubsystem;
+
+	explicit FWorldLayerHandle(FName InLayerName)
+		: LayerName(InLayerName)
+	{
+	}
+
+	FName LayerName;
+
+	mutable UWorldDataLayer* Layer = nullptr;
+	mutable FWorldLayerPixelTransform Transform;
+	mutable uint32 LayerGeneration = 0;
+	mutable uint32 LayoutGeneration = 0;
+};
+
+/** A deferred write recorded by UWorldLayersSubsystem::EnqueueSetValue or EnqueueStamp. */
+struct FWorldLayerWriteCommand
+{
+	FName LayerName;
+	FVector2D WorldLocation = FVector2D::ZeroVector;
+
+	/** World-space radius of a stamp. Zero writes only the cell containing WorldLocation. */
+	float Radius = 0.0f;
+
+	FLinearColor Value = FLinearColor::Black;
 };
 
 UCLASS()
@@ -60,31 +136,165 @@ public:
 	UFUNCTION(BlueprintPure, Category = "RancWorldLayers")
 	AWorldDataVolume* GetWorldDataVolume() const { return WorldDataVolume.Get(); }
 
+	/**
+	 * Query and modification functions of the subsystem, including the handle overloads, are game-thread only.
+	 * Worker threads sample layers through read snapshots instead: layers whose asset sets bAllowConcurrentReads publish
+	 * an immutable FWorldLayerSnapshot every tick they changed. Get the channel once on the game thread, then call
+	 * FWorldLayerSnapshotChannel::Acquire from any thread; it never blocks and never observes a partial write.
+	 */
+	TSharedPtr<FWorldLayerSnapshotChannel, ESPMode::ThreadSafe> GetLayerSnapshotChannel(FName LayerName) const;
+	TSharedPtr<FWorldLayerSnapshotChannel, ESPMode::ThreadSafe> GetLayerSnapshotChannel(const FWorldLayerHandle& Handle) const;
+
+	/** Publishes new read snapshots of concurrently readable layers that changed and frees snapshots no reader can reach anymore. Called every tick. */
+	void PublishReadSnapshots();
+
+	/** Returns a handle for repeated queries on a layer. The layer does not have to be registered yet. */
+	FWorldLayerHandle GetLayerHandle(FName LayerName) const;
+
 	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
 	bool GetValueAtLocation(FName LayerName, const FVector2D& WorldLocation, FLinearColor& OutValue) const;
+	bool GetValueAtLocation(const FWorldLayerHandle& Handle, const FVector2D& WorldLocation, FLinearColor& OutValue) const;
 
 	/** Samples the layer at the given world location using bilinear interpolation. */
 	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
 	bool GetValueAtLocationInterpolated(FName LayerName, const FVector2D& WorldLocation, FLinearColor& OutValue) const;
+	bool GetValueAtLocationInterpolated(const FWorldLayerHandle& Handle, const FVector2D& WorldLocation, FLinearColor& OutValue) const;
 
 	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
 	float GetFloatValueAtLocation(FName LayerName, const FVector2D& WorldLocation) const; // Convenience for single-channel float layers
+	float GetFloatValueAtLocation(const FWorldLayerHandle& Handle, const FVector2D& WorldLocation) const;
+
+	/**
+	 * Batched GetValueAtLocation. The layer, its format and its cell size are resolved once per call, and the world-to-pixel
+	 * math runs two locations per vector register. OutValues must have the same length as Locations.
+	 */
+	bool GetValuesAtLocations(FName LayerName, TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const;
+	bool GetValuesAtLocations(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const;
+
+	/** Batched GetValueAtLocationInterpolated. OutValues must have the same length as Locations. */
+	bool GetValuesAtLocationsInterpolated(FName LayerName, TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const;
+	bool GetValuesAtLocationsInterpolated(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const;
+
+	/** Batched GetFloatValueAtLocation. Decodes only the first channel. OutValues must have the same length as Locations. */
+	bool GetFloatValuesAtLocations(FName LayerName, TConstArrayView<FVector2D> Locations, TArrayView<float> OutValues) const;
+	bool GetFloatValuesAtLocations(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Locations, TArrayView<float> OutValues) const;
+
+	/**
+	 * Batched sampling of a Dominant3 layer (see FWorldLayerImageOpDerivations::Dominant3), decoded the way the material
+	 * node decodes it. The layer must be RGBA8. OutSamples must have the same length as Locations.
+	 */
+	bool GetDominant3AtLocations(FName LayerName, TConstArrayView<FVector2D> Locations, TArrayView<FWorldLayerDominant3Sample> OutSamples) const;
+	bool GetDominant3AtLocations(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Locations, TArrayView<FWorldLayerDominant3Sample> OutSamples) const;
+
+	/** Reports how many storage tiles of a layer own memory and how many still share the implicit default tile. */
+	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
+	bool GetLayerTileCounts(FName LayerName, int32& OutAllocatedTiles, int32& OutImplicitTiles) const;
 
 	// Generic Data Modification (CPU)
 	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
 	void SetValueAtLocation(FName LayerName, const FVector2D& WorldLocation, const FLinearColor& NewValue);
+	void SetValueAtLocation(const FWorldLayerHandle& Handle, const FVector2D& WorldLocation, const FLinearColor& NewValue);
+
+	/**
+	 * Deferred writes that may be enqueued from any thread. Commands go into a lock-free multi-producer queue and are
+	 * applied by the next Tick, in enqueue order per producer, before snapshots are published and the GPU is synced.
+	 * Only the handle's layer name is read, so a handle shared between threads is fine here.
+	 */
+	void EnqueueSetValue(const FWorldLayerHandle& Handle, const FVector2D& WorldLocation, const FLinearColor& NewValue);
+
+	/** Deferred write of NewValue into every cell whose center lies within Radius world units of WorldLocation. */
+	void EnqueueStamp(const FWorldLayerHandle& Handle, const FVector2D& WorldLocation, float Radius, const FLinearColor& NewValue);
+
+	/** Applies all queued write commands, batched per layer. Called by Tick; game thread only. Returns the number of commands applied. */
+	int32 ProcessWriteCommands();
+
+	/**
+	 * Recomputes the output tiles of kernel and built-in derivative layers that changes of their sources affected, in
+	 * dependency order, running independent layers in parallel. Called by Tick; game thread only.
+	 * Returns the number of kernel output tiles recomputed.
+	 */
+	int32 UpdateDerivedLayers();
 
 	void RegisterDataLayer(UWorldDataLayerAsset* LayerAsset);
 
 	// GPU Methods
+	/** The layer's GPU texture. For layers packed into a texture array this is the shared Texture2DArray. */
 	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
 	UTexture* GetLayerGpuTexture(FName LayerName) const;
 
+	/** Finds the texture array a layer is packed into and its slice. Returns false if the layer has its own texture. */
+	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
+	bool GetLayerTextureArraySlice(FName LayerName, FName& OutTextureArrayName, int32& OutSlice) const;
+
+	/**
+	 * Reads Rect, in cells of the layer, back from the layer's GPU texture without stalling the game or render thread.
+	 * The copy is polled on later ticks, and the future is fulfilled on the game thread once the cells arrive, converted
+	 * to the layer's CPU encoding. GPU-writable layers with ReadbackBehavior OnDemand also get the cells written back.
+	 * Never wait on the future on the game thread: Tick fulfills it.
+	 */
+	TFuture<FWorldLayerReadbackResult> RequestReadback(FName LayerName, const FIntRect& Rect);
+	TFuture<FWorldLayerReadbackResult> RequestReadback(const FWorldLayerHandle& Handle, const FIntRect& Rect);
+
+	/** Polls the readbacks in flight and completes those whose cells arrived. Called by Tick; game thread only. Returns the number completed. */
+	int32 PollReadbacks();
+
+	/** Replaces how readbacks copy from the GPU, e.g. with a CPU-side transfer in tests. An empty factory restores the RHI path. */
+	void SetReadbackTransferFactory(FWorldLayerReadbackTransferFactory Factory);
+
+	/** Most bytes uploaded to the GPU per frame; zero or less uploads everything at once. Set from the volume. */
+	void SetUploadBudget(int64 BytesPerFrame);
+
+	/** Queue depth and bytes per frame of the GPU upload scheduler. */
+	FWorldLayerUploadStats GetUploadStats() const;
+
+	/** Blocks, bytes and allocations of the staging memory behind uploads. */
+	FWorldLayerStagingStats GetStagingStats() const;
+
 	void SpawnDebugActor();
 
 	// Optimized Spatial Queries
 	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
 	bool FindNearestPointWithValue(FName LayerName, const FVector2D& SearchOrigin, float MaxSearchRadius, const FLinearColor& TargetValue, FVector2D& OutWorldLocation) const;
+	bool FindNearestPointWithValue(const FWorldLayerHandle& Handle, const FVector2D& SearchOrigin, float MaxSearchRadius, const FLinearColor& TargetValue, FVector2D& OutWorldLocation) const;
+
+	/** Finds the cell closest to SearchOrigin whose value lies in the tracked range RangeName (see FWorldDataLayerSpatialOptimization::RangesToTrack). */
+	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
+	bool FindNearestPointInRange(FName LayerName, FName RangeName, const FVector2D& SearchOrigin, float MaxSearchRadius, FVector2D& OutWorldLocation) const;
+	bool FindNearestPointInRange(const FWorldLayerHandle& Handle, FName RangeName, const FVector2D& SearchOrigin, float MaxSearchRadius, FVector2D& OutWorldLocation) const;
+
+	/**
+	 * Finds up to MaxResults cells with TargetValue closest to SearchOrigin and strictly within MaxSearchRadius,
+	 * nearest first. OutWorldLocations is replaced with their centers. Returns how many were found.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
+	int32 FindKNearestPointsWithValue(FName LayerName, const FVector2D& SearchOrigin, float MaxSearchRadius, const FLinearColor& TargetValue, int32 MaxResults, TArray<FVector2D>& OutWorldLocations) const;
+
+	/** Fills OutWorldLocations nearest first, up to its size. Does not allocate for up to 64 results. */
+	int32 FindKNearestPointsWithValue(const FWorldLayerHandle& Handle, const FVector2D& SearchOrigin, float MaxSearchRadius, const FLinearColor& TargetValue, TArrayView<FVector2D> OutWorldLocations) const;
+
+	/**
+	 * K-nearest search from each of Origins. Results for origin I go to OutWorldLocations[I * K, I * K + OutCounts[I]),
+	 * where K = OutWorldLocations.Num() / Origins.Num(). OutCounts must have one entry per origin.
+	 */
+	void FindKNearestPointsWithValueBatch(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Origins, float MaxSearchRadius, const FLinearColor& TargetValue, TArrayView<FVector2D> OutWorldLocations, TArrayView<int32> OutCounts) const;
+
+	/** Replaces OutWorldLocations with the centers of all cells with TargetValue strictly within Radius of Center, in no particular order. */
+	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
+	int32 FindPointsWithValueInRadius(FName LayerName, const FVector2D& Center, float Radius, const FLinearColor& TargetValue, TArray<FVector2D>& OutWorldLocations) const;
+
+	/** Calls Visitor with the center of every cell with TargetValue strictly within Radius of Center. Returns the number of cells visited. */
+	int32 ForEachPointWithValueInRadius(const FWorldLayerHandle& Handle, const FVector2D& Center, float Radius, const FLinearColor& TargetValue, TFunctionRef<void(const FVector2D&)> Visitor) const;
+
+	/** Radius enumeration around each of Origins. Visitor receives the index of the origin along with each location. */
+	void ForEachPointWithValueInRadiusBatch(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Origins, float Radius, const FLinearColor& TargetValue, TFunctionRef<void(int32, const FVector2D&)> Visitor) const;
+
+	/** Counts the cells with TargetValue strictly within Radius of Center. Cheaper than enumerating them. */
+	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
+	int32 CountPointsWithValueInRadius(FName LayerName, const FVector2D& Center, float Radius, const FLinearColor& TargetValue) const;
+	int32 CountPointsWithValueInRadius(const FWorldLayerHandle& Handle, const FVector2D& Center, float Radius, const FLinearColor& TargetValue) const;
+
+	/** Radius count around each of Origins. OutCounts must have one entry per origin. */
+	void CountPointsWithValueInRadiusBatch(const FWorldLayerHandle& Handle, TConstArrayView<FVector2D> Origins, float Radius, const FLinearColor& TargetValue, TArrayView<int32> OutCounts) const;
 
 	// Editor Utility and Debugging
 	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
@@ -96,16 +306,49 @@ public:
 	void ExportLayerToPNG(UWorldDataLayerAsset* LayerAsset, const FString& FilePath);
 	void ImportLayerFromPNG(UWorldDataLayerAsset* LayerAsset, const FString& FilePath);
 
-	/** Recomputes a derivative layer based on its sources. */
+	/**
+	 * Recomputes a whole derivative layer based on its sources, with the kernel or provider registered for its
+	 * DerivationMethod. Layers computed by a built-in derivation or a kernel do not need this: Tick keeps them up to date,
+	 * recomputing only the tiles that changes of their sources affect, in dependency order.
+	 */
 	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
 	void UpdateDerivativeLayer(FName LayerName);
 
+	/**
+	 * Registers the native kernel that computes derivative layers with DerivationMethod, replacing whatever was registered
+	 * for it. The kernel reads snapshots of the sources and fills an output buffer, so it does not need the game thread.
+	 * Halo is how many cells around an output cell the kernel reads from its sources, e.g. 1 for a 3x3 filter; a change
+	 * to a source cell recomputes the output tiles within that distance of it.
+	 */
+	void RegisterDerivationKernel(FName DerivationMethod, FWorldLayerDerivationKernel Kernel, int32 Halo = 0);
+
+	/** Registers a kernel whose halo depends on the settings of the layer it computes, e.g. a blur radius. */
+	void RegisterDerivationKernel(FName DerivationMethod, FWorldLayerDerivationKernel Kernel, FWorldLayerDerivationHalo GetHalo);
+
+	/** Registers an object whose OnDeriveLayer computes derivative layers with DerivationMethod on the game thread. */
+	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
+	void RegisterDerivationProvider(FName DerivationMethod, TScriptInterface<IWorldLayersDerivationProvider> Provider);
+
+	/** Removes the kernel or provider registered for DerivationMethod. */
+	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
+	void UnregisterDerivation(FName DerivationMethod);
+
+	/**
+	 * Looks up the nearest feature recorded by a NearestFeature derivative layer at SearchOrigin. This is a single cell
+	 * read instead of a search. Returns false if the layer is not a NearestFeature layer or its source has no feature.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "RancWorldLayers")
+	bool FindNearestFeature(FName NearestFeatureLayerName, const FVector2D& SearchOrigin, FVector2D& OutWorldLocation) const;
+
 	// Public access for external tools (e.g. PCG nodes)
 	const UWorldDataLayer* GetDataLayer(FName LayerName) const;
 	TArray<FName> GetActiveLayerNames() const;
 	FIntPoint WorldLocationToPixel(const FVector2D& WorldLocation, const UWorldDataLayer* Layer) const;
 	FVector2D PixelToWorldLocation(const FIntPoint& PixelLocation, const UWorldDataLayer* Layer) const;
 
+	/** Captures the current world-to-pixel mapping of a layer for repeated sampling. */
+	FWorldLayerPixelTransform GetPixelTransform(const UWorldDataLayer* Layer) const;
+
 	FVector2D GetWorldGridOrigin() const { return WorldGridOrigin; }
 	FVector2D GetWorldGridSize() const { return WorldGridSize; }
 
@@ -132,10 +375,170 @@ private:
 	FVector2D WorldGridOrigin;
 	FVector2D WorldGridSize;
 
+	/** Changes whenever layers may have been replaced or the world grid moved. Unique across subsystems. */
+	uint32 LayoutGeneration = 0;
+	void BumpLayoutGeneration();
+
+	/** Returns the layer behind a handle, refreshing the handle's cache first if it went stale. */
+	UWorldDataLayer* ResolveHandle(const FWorldLayerHandle& Handle) const;
+
+	bool SampleLayer(const UWorldDataLayer* DataLayer, const FWorldLayerPixelTransform& Transform, TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const;
+	bool SampleLayerInterpolated(const UWorldDataLayer* DataLayer, const FWorldLayerPixelTransform& Transform, TConstArrayView<FVector2D> Locations, TArrayView<FLinearColor> OutValues) const;
+	bool SampleLayerFloat(const UWorldDataLayer* DataLayer, const FWorldLayerPixelTransform& Transform, TConstArrayView<FVector2D> Locations, TArrayView<float> OutValues) const;
+	bool SampleLayerDominant3(const UWorldDataLayer* DataLayer, const FWorldLayerPixelTransform& Transform, TConstArrayView<FVector2D> Locations, TArrayView<FWorldLayerDominant3Sample> OutSamples) const;
+	static bool FindNearestPointInIndex(const FWorldLayerSpatialIndex* Index, const FWorldLayerPixelTransform& Transform, const FVector2D& SearchOrigin, float MaxSearchRadius, FVector2D& OutWorldLocation);
+
+	/** Returns the spatial index tracking TargetValue in a layer, or null if the layer does not track it. */
+	static const FWorldLayerSpatialIndex* FindSpatialIndexInLayer(const UWorldDataLayer* DataLayer, const FLinearColor& TargetValue);
+
+	/** Returns the spatial index of a tracked range in a layer, or null if the layer does not track it. */
+	static const FWorldLayerSpatialIndex* FindSpatialIndexInLayer(const UWorldDataLayer* DataLayer, FName RangeName);
+
+	/** K-nearest search from one origin using Scratch as the heap. Scratch.Num() is K; OutWorldLocations needs at least as many entries. */
+	static int32 FindKNearestInIndex(const FWorldLayerSpatialIndex& Index, const FWorldLayerPixelTransform& Transform, const FVector2D& SearchOrigin, float MaxSearchRadius, TArrayView<FIntPoint> Scratch, TArrayView<FVector2D> OutWorldLocations);
+
+	TQueue<FWorldLayerWriteCommand, EQueueMode::Mpsc> PendingWriteCommands;
+
+	/** Reused by ProcessWriteCommands to avoid reallocating every tick. */
+	TArray<FWorldLayerWriteCommand> WriteCommandBatch;
+	TArray<FIntPoint> WritePixelScratch;
+
+	/** What computes a DerivationMethod: a native kernel, or else a provider object. */
+	struct FDerivationRegistration
+	{
+		FWorldLayerDerivationKernel Kernel;
+		FWorldLayerDerivationHalo GetHalo;
+		/** Held as an object so providers implemented in Blueprint, which have no native interface pointer, work too. */
+		TWeakObjectPtr<UObject> Provider;
+	};
+	TMap<FName, FDerivationRegistration> DerivationRegistry;
+
+	/** A derivative layer that Tick keeps up to date, with one change observer per source for kernel derivations. */
+	struct FDerivationNode
+	{
+		TWeakObjectPtr<UWorldDataLayer> Target;
+		TArray<TWeakObjectPtr<UWorldDataLayer>> Sources;
+		TArray<int32> SourceObserverSlots;
+
+		/** Target generation the node was built for. Re-registering the target resets its cells, so the node starts over. */
+		uint32 TargetGeneration = 0;
+	};
+	TMap<FName, FDerivationNode> DerivationNodes;
+
+	/** Names of DerivationNodes by dependency level. Every derivative source of a layer is in an earlier level. */
+	TArray<TArray<FName>> DerivationLevels;
+	bool bDerivationGraphDirty = true;
+
+	/** Rebuilds the dependency graph from SourceLayerNames. Nodes whose layers were neither replaced nor reinitialized keep their observers. */
+	void RebuildDerivationGraph();
+
+	/** Releases the change observers of a node. */
+	static void ReleaseDerivationNode(FDerivationNode& Node);
+
+	/** Returns the tile-aligned cells of the target that changes to the node's sources affect, and resets the changes. */
+	static FIntRect ConsumeDerivationDirtyRect(FDerivationNode& Node, const FIntPoint& TargetResolution, int32 Halo);
+
+	/** A kernel run over a rect of a derivative layer, prepared on the game thread and executed on any thread. */
+	struct FDerivationWork
+	{
+		UWorldDataLayer* Target = nullptr;
+		const FWorldLayerDerivationKernel* Kernel = nullptr;
+		FWorldLayerDerivationInputs Inputs;
+		FIntRect Rect;
+		int32 Stride = 0;
+		TArray<uint8> Buffer;
+	};
+
+	/** Snapshots the sources and allocates a default-filled output for Rect. Returns false if a source is missing. */
+	bool PrepareDerivationWork(UWorldDataLayer* TargetLayer, const FWorldLayerDerivationKernel& Kernel, const FIntRect& Rect, FDerivationWork& OutWork) const;
+
+	/**
+	 * Runs the kernels of all work items in parallel, one task per output tile, then writes the results to the layers.
+	 * Returns the number of tiles computed.
+	 */
+	static int32 ExecuteDerivationWork(TArrayView<FDerivationWork> Work);
+
+	/** Incremental state of a built-in distance field derivation, per derivative layer. */
+	struct FDistanceFieldState
+	{
+		TWeakObjectPtr<UWorldDataLayer> Target;
+		TWeakObjectPtr<UWorldDataLayer> Source;
+		int32 SourceObserverSlot = INDEX_NONE;
+		uint32 TargetGeneration = 0;
+		TSharedPtr<class FWorldLayerDistanceField> Field;
+	};
+	TMap<FName, FDistanceFieldState> DistanceFieldStates;
+
+	/** Returns the source of a built-in derivative layer, or null with a warning if the pair cannot be derived. */
+	UWorldDataLayer* GetBuiltInDerivationSource(const UWorldDataLayer* TargetLayer) const;
+
+	/** Brings a built-in derivative layer up to date with the changes of its source since its last update. */
+	void UpdateBuiltInDerivation(UWorldDataLayer* TargetLayer);
+
+	/** Appends the cells covered by a command to OutPixels. */
+	static void GatherCommandPixels(const FWorldLayerWriteCommand& Command, const FWorldLayerPixelTransform& Transform, TArray<FIntPoint>& OutPixels);
+
 	FTSTicker::FDelegateHandle TickHandle;
 
 	TSharedPtr<class FWorldLayersInputProcessor> InputProcessor;
 
+	/** Queues the dirty regions of a layer for upload. */
 	void SyncCPUToGPU(UWorldDataLayer* DataLayer);
+
+	/** Uploads what the scheduler releases this frame, one render command per layer. */
+	void FlushUploads();
+
+	/**
+	 * Syncs and uploads everything pending for one layer right away, ignoring the budget. A readback that writes into the
+	 * layer calls this first, so its GPU texels already include every CPU edit and cannot overwrite a newer one.
+	 */
+	void FlushLayerUploads(UWorldDataLayer* DataLayer);
+
+	/** Copies regions of a layer to its GPU texture. Formats the GPU stores as-is are read straight from the shared tiles. */
+	void UploadRegions(UWorldDataLayer* DataLayer, TConstArrayView<FIntRect> Regions);
+
+	FWorldLayerUploadScheduler UploadScheduler;
+
+	/** Texture arrays that pack layers by FWorldDataLayerGPUConfiguration::TextureArrayName. */
+	UPROPERTY()
+	TMap<FName, FWorldLayerTextureArray> TextureArrays;
+
+	/**
+	 * Moves a layer into the named texture array, or out of any array for NAME_None. The other members keep their slices
+	 * and the array its texture object, as materials bake both: leaving frees the slice, and joining fills a free slice or
+	 * grows the texture in place. Returns false, leaving the layer to its own texture, if it does not fit.
+	 */
+	bool AssignTextureArray(UWorldDataLayer* DataLayer, FName TextureArrayName);
+
+	/** Reallocates the array's texture in place for its current slices and queues every member layer for a full upload. */
+	void RebuildTextureArray(FWorldLayerTextureArray& TextureArray);
+
+	const FWorldLayerTextureArray* FindTextureArray(const UWorldDataLayer* DataLayer) const;
+
+	/** Staging memory for uploads and debug render target updates, recycled once the render thread has copied it. */
+	FWorldLayerStagingPool StagingPool;
+
+	/** Starts a periodic readback of the whole layer, unless the previous one is still in flight. */
 	void ReadbackTexture(UWorldDataLayer* DataLayer);
+
+	struct FPendingReadback
+	{
+		FName LayerName;
+		uint32 LayerGeneration = 0;
+		FIntRect Rect;
+		EDataFormat DataFormat = EDataFormat::R8;
+		bool bWriteToLayer = false;
+		TUniquePtr<IWorldLayerReadbackTransfer> Transfer;
+
+		/** Null for periodic readbacks, which nobody waits for. */
+		TUniquePtr<TPromise<FWorldLayerReadbackResult>> Promise;
+	};
+	TArray<FPendingReadback> PendingReadbacks;
+	FWorldLayerReadbackTransferFactory ReadbackTransferFactory;
+
+	/** Starts a readback of Rect clipped to the layer. Returns null if there is nothing to read back from. */
+	FPendingReadback* StartReadback(UWorldDataLayer* DataLayer, const FIntRect& Rect, bool bWriteToLayer);
+
+	/** Converts the texels of a finished readback and writes them to its layer if requested. */
+	FWorldLayerReadbackResult CompleteReadback(const FPendingReadback& Readback, EWorldLayerReadbackPoll Status, const FWorldLayerReadbackTexels& Texels);
 };
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "RancWorldLayersTestSetup.cpp"
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "Framework/DebugTestResult.h"
+#include "WorldLayerSnapshot.h"
+#include "Async/ParallelFor.h"
 
 #if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
 
@@ -219,6 +221,190 @@ public:
 
 		return Res;
 	}
+
+	bool TestLayerHandleSurvivesReinitialize() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersCoreTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		const FName LayerName("HandleLayer");
+
+		// A handle can be taken before the layer exists and picks it up once registered
+		const FWorldLayerHandle Handle = Subsystem->GetLayerHandle(LayerName);
+		Res &= Test->TestTrue("Handle should be set", Handle.IsSet());
+		FLinearColor OutValue;
+		Res &= Test->TestFalse("Querying an unregistered layer through a handle should fail", Subsystem->GetValueAtLocation(Handle, FVector2D::ZeroVector, OutValue));
+
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = LayerName;
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(10, 10);
+		LayerAsset->DataFormat = EDataFormat::R16F;
+		Subsystem->RegisterDataLayer(LayerAsset);
+
+		const FVector2D Location(1234.0f, -2345.0f);
+		Subsystem->SetValueAtLocation(Handle, Location, FLinearColor(0.75f, 0.0f, 0.0f, 0.0f));
+		Res &= Test->TestTrue("Handle should resolve after registration", Subsystem->GetValueAtLocation(Handle, Location, OutValue));
+		Res &= Test->TestEqual("Handle write should be visible through the handle", OutValue.R, 0.75f, KINDA_SMALL_NUMBER);
+		Res &= Test->TestEqual("Handle write should be visible by name", Subsystem->GetFloatValueAtLocation(LayerName, Location), 0.75f, KINDA_SMALL_NUMBER);
+
+		// Re-registering with a different resolution reinitializes the layer; the handle must pick up the new mapping
+		LayerAsset->Resolution = FIntPoint(40, 40);
+		Subsystem->RegisterDataLayer(LayerAsset);
+		Subsystem->SetValueAtLocation(LayerName, Location, FLinearColor(0.25f, 0.0f, 0.0f, 0.0f));
+		Res &= Test->TestEqual("Handle should follow the reinitialized layer", Subsystem->GetFloatValueAtLocation(Handle, Location), 0.25f, KINDA_SMALL_NUMBER);
+		Res &= Test->TestTrue("Handle and name lookups should map to the same cell", Subsystem->WorldLocationToPixel(Location, Subsystem->GetDataLayer(LayerName)) == FIntPoint(24, 10));
+
+		// Clearing the subsystem invalidates the cached layer
+		Subsystem->ClearAllLayers();
+		Res &= Test->TestFalse("Handle should fail after all layers are cleared", Subsystem->GetValueAtLocation(Handle, Location, OutValue));
+
+		return Res;
+	}
+
+	bool TestSnapshotsIsolateConcurrentReaders() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersCoreTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = FName("SnapshotLayer");
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(128, 128);
+		LayerAsset->DataFormat = EDataFormat::R8;
+		LayerAsset->bAllowConcurrentReads = true;
+		Subsystem->RegisterDataLayer(LayerAsset);
+
+		const TSharedPtr<FWorldLayerSnapshotChannel, ESPMode::ThreadSafe> Channel = Subsystem->GetLayerSnapshotChannel(LayerAsset->LayerName);
+		Res &= Test->TestTrue("Concurrently readable layers should expose a channel", Channel.IsValid());
+		if (!Channel.IsValid())
+		{
+			return Res;
+		}
+
+		// A snapshot is published on registration and keeps its values when the layer is written afterwards
+		const FWorldLayerSnapshotPtr Before = Channel->Acquire();
+		Res &= Test->TestTrue("Registration should publish a snapshot", Before.IsValid());
+		const FVector2D Location(100.0f, 100.0f);
+		Subsystem->SetValueAtLocation(LayerAsset->LayerName, Location, FLinearColor::White);
+
+		FLinearColor OutValue;
+		Before->GetValueAtLocation(Location, OutValue);
+		Res &= Test->TestEqual("An acquired snapshot should not see later writes", OutValue.R, 0.0f);
+		Res &= Test->TestTrue("Acquiring before publishing should return the same snapshot", Channel->Acquire() == Before);
+
+		Subsystem->PublishReadSnapshots();
+		const FWorldLayerSnapshotPtr After = Channel->Acquire();
+		After->GetValueAtLocation(Location, OutValue);
+		Res &= Test->TestEqual("A published snapshot should see the write", OutValue.R, 1.0f);
+		Res &= Test->TestTrue("Snapshot and layer should map the location to the same cell", After->GetPixelTransform().ToPixel(Location) == Subsystem->WorldLocationToPixel(Location, Subsystem->GetDataLayer(LayerAsset->LayerName)));
+
+		// Workers sample while the game thread keeps writing and publishing; every snapshot must stay self-consistent
+		const FIntPoint Resolution = LayerAsset->Resolution;
+		std::atomic<bool> bStop{false};
+		std::atomic<int32> NumTornReads{0};
+		TFuture<void> Readers = Async(EAsyncExecution::ThreadPool, [&]()
+		{
+			ParallelFor(4, [&](int32)
+			{
+				while (!bStop.load())
+				{
+					const FWorldLayerSnapshotPtr Snapshot = Channel->Acquire();
+					// Every write below fills a whole row with one value, so a row holding two values was torn
+					const int32 Row = FMath::RandRange(0, Resolution.Y - 1);
+					const FLinearColor First = Snapshot->GetValueAtPixel(FIntPoint(0, Row));
+					const FLinearColor Last = Snapshot->GetValueAtPixel(FIntPoint(Resolution.X - 1, Row));
+					if (First != Last)
+					{
+						++NumTornReads;
+					}
+				}
+			});
+		});
+
+		UWorldDataLayer* DataLayer = const_cast<UWorldDataLayer*>(Subsystem->GetDataLayer(LayerAsset->LayerName));
+		for (int32 Iteration = 0; Iteration < 200; ++Iteration)
+		{
+			const FLinearColor Value(((Iteration % 250) + 1) / 255.0f, 0.0f, 0.0f, 0.0f);
+			const int32 Row = Iteration % Resolution.Y;
+			for (int32 X = 0; X < Resolution.X; ++X)
+			{
+				DataLayer->SetValueAtPixel(FIntPoint(X, Row), Value);
+			}
+			Subsystem->PublishReadSnapshots();
+		}
+		bStop.store(true);
+		Readers.Wait();
+
+		Res &= Test->TestEqual("No reader should observe a partially written row", NumTornReads.load(), 0);
+
+		// Once readers are gone, retired snapshots can be freed
+		FWorldLayerEpochDomain::Get().Reclaim();
+		Res &= Test->TestEqual("All retired snapshots should be reclaimed", FWorldLayerEpochDomain::Get().GetNumPendingRetired(), 0);
+
+		return Res;
+	}
+
+	bool TestQueuedWritesFromWorkerThreads() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersCoreTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = FName("QueuedWriteLayer");
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(100, 100);
+		LayerAsset->DataFormat = EDataFormat::R8;
+		Subsystem->RegisterDataLayer(LayerAsset);
+		const UWorldDataLayer* DataLayer = Subsystem->GetDataLayer(LayerAsset->LayerName);
+
+		// Every worker writes its own column of cells through one shared handle; nothing lands before the drain
+		const FWorldLayerHandle Handle = Subsystem->GetLayerHandle(LayerAsset->LayerName);
+		ParallelFor(8, [&](int32 Worker)
+		{
+			for (int32 Y = 0; Y < 100; ++Y)
+			{
+				Subsystem->EnqueueSetValue(Handle, Subsystem->PixelToWorldLocation(FIntPoint(Worker, Y), DataLayer), FLinearColor::White);
+			}
+		});
+		Res &= Test->TestEqual("Queued writes should not apply before the drain", DataLayer->GetValueAtPixel(FIntPoint(3, 50)).R, 0.0f);
+		Res &= Test->TestEqual("Every queued command should be applied once", Subsystem->ProcessWriteCommands(), 800);
+
+		bool bAllWritten = true;
+		for (int32 Worker = 0; Worker < 8; ++Worker)
+		{
+			for (int32 Y = 0; Y < 100; ++Y)
+			{
+				bAllWritten &= DataLayer->GetValueAtPixel(FIntPoint(Worker, Y)).R == 1.0f;
+			}
+		}
+		Res &= Test->TestTrue("Every queued cell should be written", bAllWritten);
+		Res &= Test->TestEqual("Neighbouring cells should stay untouched", DataLayer->GetValueAtPixel(FIntPoint(8, 50)).R, 0.0f);
+
+		// A stamp covers the cells whose centers fall inside its radius, and later commands overwrite earlier ones
+		const FVector2D Center = Subsystem->PixelToWorldLocation(FIntPoint(50, 50), DataLayer);
+		Subsystem->EnqueueStamp(Handle, Center, 250.0f, FLinearColor::White);
+		Subsystem->EnqueueSetValue(Handle, Center, FLinearColor::Black);
+		Subsystem->ProcessWriteCommands();
+
+		int32 NumStamped = 0;
+		for (int32 Y = 40; Y < 60; ++Y)
+		{
+			for (int32 X = 40; X < 60; ++X)
+			{
+				NumStamped += DataLayer->GetValueAtPixel(FIntPoint(X, Y)).R == 1.0f ? 1 : 0;
+			}
+		}
+		// 100 world units per cell, so the stamp is a disc of radius 2.5 cells: 21 cell centers, minus the overwritten center
+		Res &= Test->TestEqual("Stamp should cover the cells inside its radius", NumStamped, 20);
+		Res &= Test->TestEqual("The later SetValue should win over the stamp", DataLayer->GetValueAtPixel(FIntPoint(50, 50)).R, 0.0f);
+		Res &= Test->TestEqual("Draining an empty queue should apply nothing", Subsystem->ProcessWriteCommands(), 0);
+
+		return Res;
+	}
 };
 
 bool FRancWorldLayersCoreTest::RunTest(const FString& Parameters)
@@ -234,6 +420,9 @@ bool FRancWorldLayersCoreTest::RunTest(const FString& Parameters)
 	bResult &= Scenarios.TestMultipleVolumeWarning();
 	bResult &= Scenarios.TestOutOfBoundsDefaultValue();
 	bResult &= Scenarios.TestImmutableLayerWrite();
+	bResult &= Scenarios.TestLayerHandleSurvivesReinitialize();
+	bResult &= Scenarios.TestSnapshotsIsolateConcurrentReaders();
+	bResult &= Scenarios.TestQueuedWritesFromWorkerThreads();
 
 	return bResult;
 }
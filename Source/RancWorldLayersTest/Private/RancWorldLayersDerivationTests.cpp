@@ -0,0 +1,657 @@
+// Copyright Rancorous Games, 2025
+
+#include "RancWorldLayersTestSetup.cpp"
+#include "Framework/DebugTestResult.h"
+#include "WorldDataLayerAsset.h"
+#include "WorldLayerDerivations.h"
+#include "Curves/CurveFloat.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#define TestName_Derivation "GameTests.RancWorldLayers.Derivation"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancWorldLayersDerivationTest, TestName_Derivation,
+								 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Context class for setting up the test environment
+class WorldDataLayersDerivationTestContext
+{
+public:
+	WorldDataLayersDerivationTestContext(FRancWorldLayersDerivationTest* InTest)
+		: Test(InTest),
+		  TestFixture(FName(*FString(TestName_Derivation)), FVector2D(100.0f, 100.0f)) // One world unit per cell
+	{
+		Subsystem = TestFixture.GetSubsystem();
+		Test->TestNotNull("Subsystem should not be null", Subsystem);
+	}
+
+	UWorldLayersSubsystem* GetSubsystem() const { return Subsystem; }
+
+	UWorldDataLayerAsset* RegisterLayer(FName LayerName, EDataFormat Format) const
+	{
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = LayerName;
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(100, 100);
+		LayerAsset->DataFormat = Format;
+		LayerAsset->DefaultValue = FLinearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		Subsystem->RegisterDataLayer(LayerAsset);
+		return LayerAsset;
+	}
+
+private:
+	FRancWorldLayersDerivationTest* Test;
+	FRancWorldLayersTestFixture TestFixture;
+	UWorldLayersSubsystem* Subsystem;
+};
+
+// Class containing individual test scenarios
+class FWorldDataLayersDerivationTestScenarios
+{
+public:
+	FRancWorldLayersDerivationTest* Test;
+
+	FWorldDataLayersDerivationTestScenarios(FRancWorldLayersDerivationTest* InTest)
+		: Test(InTest)
+	{
+	}
+
+	bool TestDistanceFieldMatchesBruteForce() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersDerivationTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		const UWorldDataLayerAsset* SourceAsset = Context.RegisterLayer(FName("Walls"), EDataFormat::R8);
+		const UWorldDataLayer* SourceLayer = Subsystem->GetDataLayer(SourceAsset->LayerName);
+
+		// Walls are cells at or above one half
+		FWorldDataLayerTrackedRange WallRange;
+		WallRange.Min = 0.5f;
+		WallRange.Max = 1.0f;
+		WallRange.bIncludeMax = true;
+
+		UWorldDataLayerAsset* DistanceAsset = NewObject<UWorldDataLayerAsset>();
+		DistanceAsset->LayerName = FName("WallDistance");
+		DistanceAsset->ResolutionMode = EResolutionMode::Absolute;
+		DistanceAsset->Resolution = FIntPoint(100, 100);
+		DistanceAsset->DataFormat = EDataFormat::R16F;
+		DistanceAsset->Mutability = EWorldDataLayerMutability::Derivative;
+		DistanceAsset->DerivationMethod = FWorldLayerBuiltInDerivations::DistanceField;
+		DistanceAsset->SourceLayerNames = {SourceAsset->LayerName};
+		DistanceAsset->DistanceField.FeatureRange = WallRange;
+		DistanceAsset->DistanceField.MaxDistance = 1000.0f;
+		Subsystem->RegisterDataLayer(DistanceAsset);
+
+		UWorldDataLayerAsset* NearestAsset = NewObject<UWorldDataLayerAsset>();
+		NearestAsset->LayerName = FName("NearestWall");
+		NearestAsset->ResolutionMode = EResolutionMode::Absolute;
+		NearestAsset->Resolution = FIntPoint(100, 100);
+		NearestAsset->DataFormat = EDataFormat::RGBA8;
+		NearestAsset->Mutability = EWorldDataLayerMutability::Derivative;
+		NearestAsset->DerivationMethod = FWorldLayerBuiltInDerivations::NearestFeature;
+		NearestAsset->SourceLayerNames = {SourceAsset->LayerName};
+		NearestAsset->DistanceField.FeatureRange = WallRange;
+		Subsystem->RegisterDataLayer(NearestAsset);
+
+		TSet<FIntPoint> Walls;
+		auto SetWall = [&](const FIntPoint& Pixel, bool bWall)
+		{
+			Subsystem->SetValueAtLocation(SourceAsset->LayerName, Subsystem->PixelToWorldLocation(Pixel, SourceLayer), FLinearColor(bWall ? 1.0f : 0.0f, 0.0f, 0.0f, 0.0f));
+			if (bWall)
+			{
+				Walls.Add(Pixel);
+			}
+			else
+			{
+				Walls.Remove(Pixel);
+			}
+		};
+
+		// Compares every cell of both derived layers with a scan over all walls, allowing for 16-bit float rounding of the
+		// distances. Ties may resolve to any equally near wall.
+		auto MatchesBruteForce = [&](const TCHAR* Stage)
+		{
+			int32 NumMismatches = 0;
+			for (int32 Y = 0; Y < 100; ++Y)
+			{
+				for (int32 X = 0; X < 100; ++X)
+				{
+					int32 BestDistSq = MAX_int32;
+					for (const FIntPoint& Wall : Walls)
+					{
+						BestDistSq = FMath::Min(BestDistSq, (Wall - FIntPoint(X, Y)).SizeSquared());
+					}
+
+					const FVector2D Location = Subsystem->PixelToWorldLocation(FIntPoint(X, Y), SourceLayer);
+					const float Expected = Walls.Num() > 0 ? FMath::Sqrt((float)BestDistSq) : 1000.0f;
+					const float Distance = Subsystem->GetFloatValueAtLocation(DistanceAsset->LayerName, Location);
+
+					FVector2D NearestLocation;
+					const bool bFound = Subsystem->FindNearestFeature(NearestAsset->LayerName, Location, NearestLocation);
+					const FIntPoint Nearest = Subsystem->WorldLocationToPixel(NearestLocation, SourceLayer);
+					const bool bNearestMatches = bFound ? (Walls.Contains(Nearest) && (Nearest - FIntPoint(X, Y)).SizeSquared() == BestDistSq) : Walls.Num() == 0;
+
+					NumMismatches += (!FMath::IsNearlyEqual(Distance, Expected, Expected * 1e-3f + 1e-3f) || !bNearestMatches) ? 1 : 0;
+				}
+			}
+			return Test->TestEqual(FString::Printf(TEXT("Derived layers should match brute force %s"), Stage), NumMismatches, 0);
+		};
+
+		Subsystem->UpdateDerivativeLayer(DistanceAsset->LayerName);
+		Subsystem->UpdateDerivativeLayer(NearestAsset->LayerName);
+		Res &= MatchesBruteForce(TEXT("without any wall"));
+
+		// A corridor with a gap, plus some isolated walls
+		for (int32 X = 10; X < 90; ++X)
+		{
+			if (X < 45 || X > 55)
+			{
+				SetWall(FIntPoint(X, 40), true);
+			}
+		}
+		SetWall(FIntPoint(3, 97), true);
+		SetWall(FIntPoint(80, 5), true);
+		SetWall(FIntPoint(50, 75), true);
+
+		Subsystem->UpdateDerivativeLayer(DistanceAsset->LayerName);
+		Subsystem->UpdateDerivativeLayer(NearestAsset->LayerName);
+		Res &= MatchesBruteForce(TEXT("after the first pass"));
+
+		// Incremental edits: close the gap, drop a wall far away, and remove one whose region must fall back to others
+		for (int32 X = 45; X <= 55; ++X)
+		{
+			SetWall(FIntPoint(X, 40), true);
+		}
+		SetWall(FIntPoint(50, 75), false);
+		SetWall(FIntPoint(97, 97), true);
+
+		Subsystem->UpdateDerivativeLayer(DistanceAsset->LayerName);
+		Subsystem->UpdateDerivativeLayer(NearestAsset->LayerName);
+		Res &= MatchesBruteForce(TEXT("after incremental edits"));
+
+		// A format that cannot hold coordinates is rejected rather than written with garbage
+		UWorldDataLayerAsset* BadAsset = NewObject<UWorldDataLayerAsset>();
+		BadAsset->LayerName = FName("BadNearestWall");
+		BadAsset->ResolutionMode = EResolutionMode::Absolute;
+		BadAsset->Resolution = FIntPoint(100, 100);
+		BadAsset->DataFormat = EDataFormat::R8;
+		BadAsset->Mutability = EWorldDataLayerMutability::Derivative;
+		BadAsset->DerivationMethod = FWorldLayerBuiltInDerivations::NearestFeature;
+		BadAsset->SourceLayerNames = {SourceAsset->LayerName};
+		Subsystem->RegisterDataLayer(BadAsset);
+		Subsystem->UpdateDerivativeLayer(BadAsset->LayerName);
+
+		FVector2D Unused;
+		Res &= Test->TestFalse("A NearestFeature layer in the wrong format should not answer queries", Subsystem->FindNearestFeature(BadAsset->LayerName, FVector2D::ZeroVector, Unused));
+
+		return Res;
+	}
+
+	bool TestRegisteredKernelDerivesLayer() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersDerivationTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		const UWorldDataLayerAsset* HeightAsset = Context.RegisterLayer(FName("Height"), EDataFormat::R16F);
+		const UWorldDataLayerAsset* WaterAsset = Context.RegisterLayer(FName("Water"), EDataFormat::R8);
+
+		UWorldDataLayerAsset* DepthAsset = NewObject<UWorldDataLayerAsset>();
+		DepthAsset->LayerName = FName("WaterDepth");
+		DepthAsset->ResolutionMode = EResolutionMode::Absolute;
+		DepthAsset->Resolution = FIntPoint(100, 100);
+		DepthAsset->DataFormat = EDataFormat::R16F;
+		DepthAsset->Mutability = EWorldDataLayerMutability::Derivative;
+		DepthAsset->DerivationMethod = FName("TestWaterDepth");
+		DepthAsset->SourceLayerNames = {HeightAsset->LayerName, WaterAsset->LayerName};
+		DepthAsset->DefaultValue = FLinearColor(-1.0f, 0.0f, 0.0f, 0.0f);
+		Subsystem->RegisterDataLayer(DepthAsset);
+
+		// Depth where there is water, the default elsewhere. Reads typed accessors of both sources.
+		int32 NumKernelRuns = 0;
+		Subsystem->RegisterDerivationKernel(DepthAsset->DerivationMethod, [&NumKernelRuns](const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+		{
+			++NumKernelRuns;
+			const TWorldLayerAccessor<EDataFormat::R16F> Height = Inputs.Sources[0]->MakeAccessor<EDataFormat::R16F>();
+			const TWorldLayerAccessor<EDataFormat::R8> Water = Inputs.Sources[1]->MakeAccessor<EDataFormat::R8>();
+			const FIntRect& Rect = Output.GetRect();
+			for (int32 Y = Rect.Min.Y; Y < Rect.Max.Y; ++Y)
+			{
+				for (int32 X = Rect.Min.X; X < Rect.Max.X; ++X)
+				{
+					if (Water.GetR(X, Y) > 0.5f)
+					{
+						Output.Set<EDataFormat::R16F>(X, Y, FLinearColor(2.0f - Height.GetR(X, Y), 0.0f, 0.0f, 0.0f));
+					}
+				}
+			}
+		});
+
+		const FVector2D WetLocation(10.5f, 10.5f);
+		const FVector2D DryLocation(-20.5f, 30.5f);
+		Subsystem->SetValueAtLocation(HeightAsset->LayerName, WetLocation, FLinearColor(0.5f, 0.0f, 0.0f, 0.0f));
+		Subsystem->SetValueAtLocation(WaterAsset->LayerName, WetLocation, FLinearColor(1.0f, 0.0f, 0.0f, 0.0f));
+
+		Subsystem->UpdateDerivativeLayer(DepthAsset->LayerName);
+		Res &= Test->TestEqual("The registered kernel should run once", NumKernelRuns, 1);
+		Res &= Test->TestEqual("Wet cells should hold the derived depth", Subsystem->GetFloatValueAtLocation(DepthAsset->LayerName, WetLocation), 1.5f);
+		Res &= Test->TestEqual("Cells the kernel skips should hold the default", Subsystem->GetFloatValueAtLocation(DepthAsset->LayerName, DryLocation), -1.0f);
+
+		// Without a registration the layer is left as it is
+		Subsystem->UnregisterDerivation(DepthAsset->DerivationMethod);
+		Subsystem->SetValueAtLocation(HeightAsset->LayerName, WetLocation, FLinearColor(1.0f, 0.0f, 0.0f, 0.0f));
+		Subsystem->UpdateDerivativeLayer(DepthAsset->LayerName);
+		Res &= Test->TestEqual("An unregistered kernel should not run", NumKernelRuns, 1);
+		Res &= Test->TestEqual("An unregistered method should leave the layer untouched", Subsystem->GetFloatValueAtLocation(DepthAsset->LayerName, WetLocation), 1.5f);
+
+		return Res;
+	}
+
+	bool TestReregisteredDerivativeIsRecomputed() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersDerivationTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		const UWorldDataLayerAsset* SourceAsset = Context.RegisterLayer(FName("CopySource"), EDataFormat::R16F);
+
+		UWorldDataLayerAsset* CopyAsset = NewObject<UWorldDataLayerAsset>();
+		CopyAsset->LayerName = FName("CopyTarget");
+		CopyAsset->ResolutionMode = EResolutionMode::Absolute;
+		CopyAsset->Resolution = FIntPoint(100, 100);
+		CopyAsset->DataFormat = EDataFormat::R16F;
+		CopyAsset->Mutability = EWorldDataLayerMutability::Derivative;
+		CopyAsset->DerivationMethod = FName("TestCopy");
+		CopyAsset->SourceLayerNames = {SourceAsset->LayerName};
+		Subsystem->RegisterDataLayer(CopyAsset);
+
+		Subsystem->RegisterDerivationKernel(CopyAsset->DerivationMethod, [](const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+		{
+			const TWorldLayerAccessor<EDataFormat::R16F> Source = Inputs.Sources[0]->MakeAccessor<EDataFormat::R16F>();
+			const FIntRect& Rect = Output.GetRect();
+			for (int32 Y = Rect.Min.Y; Y < Rect.Max.Y; ++Y)
+			{
+				for (int32 X = Rect.Min.X; X < Rect.Max.X; ++X)
+				{
+					Output.Set<EDataFormat::R16F>(X, Y, Source.Get(X, Y));
+				}
+			}
+		});
+
+		const FVector2D Location(10.5f, 10.5f);
+		Subsystem->SetValueAtLocation(SourceAsset->LayerName, Location, FLinearColor(0.75f, 0.0f, 0.0f, 0.0f));
+		Subsystem->UpdateDerivedLayers();
+		Res &= Test->TestEqual("The copy should follow its source", Subsystem->GetFloatValueAtLocation(CopyAsset->LayerName, Location), 0.75f);
+
+		// Re-registering resets the target to its default while its source stays unchanged
+		Subsystem->RegisterDataLayer(CopyAsset);
+		Res &= Test->TestEqual("Re-registering should reset the copy", Subsystem->GetFloatValueAtLocation(CopyAsset->LayerName, Location), 0.0f);
+		Res &= Test->TestTrue("The reset copy should be recomputed in full", Subsystem->UpdateDerivedLayers() > 0);
+		Res &= Test->TestEqual("The recomputed copy should follow its source again", Subsystem->GetFloatValueAtLocation(CopyAsset->LayerName, Location), 0.75f);
+
+		return Res;
+	}
+
+	bool TestDirtyTilesPropagateThroughGraph() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersDerivationTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		// 256x256 cells are 4x4 tiles of 64 cells
+		auto RegisterLayer = [&](FName LayerName, FName DerivationMethod, TArray<FName> SourceLayerNames)
+		{
+			UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+			LayerAsset->LayerName = LayerName;
+			LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+			LayerAsset->Resolution = FIntPoint(256, 256);
+			LayerAsset->DataFormat = EDataFormat::R16F;
+			LayerAsset->DefaultValue = FLinearColor(0.0f, 0.0f, 0.0f, 0.0f);
+			if (!DerivationMethod.IsNone())
+			{
+				LayerAsset->Mutability = EWorldDataLayerMutability::Derivative;
+				LayerAsset->DerivationMethod = DerivationMethod;
+				LayerAsset->SourceLayerNames = SourceLayerNames;
+			}
+			Subsystem->RegisterDataLayer(LayerAsset);
+			return Subsystem->GetDataLayer(LayerName);
+		};
+
+		// Biome depends on Wet, which depends on Moisture; registered out of order on purpose
+		const UWorldDataLayer* Biome = RegisterLayer(FName("Biome"), FName("TestBiome"), {FName("Height"), FName("Wet")});
+		const UWorldDataLayer* Wet = RegisterLayer(FName("Wet"), FName("TestWet"), {FName("Moisture")});
+		const UWorldDataLayer* Height = RegisterLayer(FName("Height"), NAME_None, {});
+		const UWorldDataLayer* Moisture = RegisterLayer(FName("Moisture"), NAME_None, {});
+
+		// Wet is the 3x3 maximum of moisture, so it reads one cell of halo
+		Subsystem->RegisterDerivationKernel(FName("TestWet"), [](const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+		{
+			const TWorldLayerAccessor<EDataFormat::R16F> Source = Inputs.Sources[0]->MakeAccessor<EDataFormat::R16F>();
+			const FIntRect& Rect = Output.GetRect();
+			for (int32 Y = Rect.Min.Y; Y < Rect.Max.Y; ++Y)
+			{
+				for (int32 X = Rect.Min.X; X < Rect.Max.X; ++X)
+				{
+					float Max = 0.0f;
+					for (int32 DY = -1; DY <= 1; ++DY)
+					{
+						for (int32 DX = -1; DX <= 1; ++DX)
+						{
+							Max = FMath::Max(Max, Source.GetR(X + DX, Y + DY));
+						}
+					}
+					Output.Set<EDataFormat::R16F>(X, Y, FLinearColor(Max, 0.0f, 0.0f, 0.0f));
+				}
+			}
+		}, 1);
+
+		Subsystem->RegisterDerivationKernel(FName("TestBiome"), [](const FWorldLayerDerivationInputs& Inputs, FWorldLayerDerivationOutput& Output)
+		{
+			const TWorldLayerAccessor<EDataFormat::R16F> HeightSource = Inputs.Sources[0]->MakeAccessor<EDataFormat::R16F>();
+			const TWorldLayerAccessor<EDataFormat::R16F> WetSource = Inputs.Sources[1]->MakeAccessor<EDataFormat::R16F>();
+			const FIntRect& Rect = Output.GetRect();
+			for (int32 Y = Rect.Min.Y; Y < Rect.Max.Y; ++Y)
+			{
+				for (int32 X = Rect.Min.X; X < Rect.Max.X; ++X)
+				{
+					Output.Set<EDataFormat::R16F>(X, Y, FLinearColor(HeightSource.GetR(X, Y) * WetSource.GetR(X, Y), 0.0f, 0.0f, 0.0f));
+				}
+			}
+		});
+
+		auto SetPixel = [&](const UWorldDataLayer* Layer, const FIntPoint& Pixel, float Value)
+		{
+			Subsystem->SetValueAtLocation(Layer->Config->LayerName, Subsystem->PixelToWorldLocation(Pixel, Layer), FLinearColor(Value, 0.0f, 0.0f, 0.0f));
+		};
+		auto GetPixel = [&](const UWorldDataLayer* Layer, const FIntPoint& Pixel)
+		{
+			return Layer->GetValueAtPixel(Pixel).R;
+		};
+
+		Res &= Test->TestEqual("The first update should compute every tile of both layers", Subsystem->UpdateDerivedLayers(), 32);
+		Res &= Test->TestEqual("Nothing changed, so nothing should be recomputed", Subsystem->UpdateDerivedLayers(), 0);
+
+		// An interior edit touches one tile of Wet, whose write touches one tile of Biome, in the same update
+		SetPixel(Height, FIntPoint(70, 70), 0.5f);
+		SetPixel(Height, FIntPoint(71, 71), 0.25f);
+		SetPixel(Moisture, FIntPoint(70, 70), 1.0f);
+		Res &= Test->TestEqual("An interior edit should recompute one tile per layer", Subsystem->UpdateDerivedLayers(), 2);
+		Res &= Test->TestEqual("Wet should spread moisture to its neighbours", GetPixel(Wet, FIntPoint(71, 71)), 1.0f);
+		Res &= Test->TestEqual("Biome should see the new Wet in the same update", GetPixel(Biome, FIntPoint(70, 70)), 0.5f);
+		Res &= Test->TestEqual("Biome should combine both sources", GetPixel(Biome, FIntPoint(71, 71)), 0.25f);
+
+		// An edit on a tile border reaches into the neighbouring tile through the halo
+		SetPixel(Height, FIntPoint(63, 10), 1.0f);
+		SetPixel(Moisture, FIntPoint(64, 10), 0.5f);
+		Res &= Test->TestEqual("A border edit should recompute both tiles the halo reaches, per layer", Subsystem->UpdateDerivedLayers(), 4);
+		Res &= Test->TestEqual("The halo should carry moisture across the tile border", GetPixel(Biome, FIntPoint(63, 10)), 0.5f);
+
+		return Res;
+	}
+
+	bool TestImageOpsMatchBruteForce() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersDerivationTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		const UWorldDataLayerAsset* FieldAsset = Context.RegisterLayer(FName("Field"), EDataFormat::R16F);
+		const UWorldDataLayerAsset* OtherAsset = Context.RegisterLayer(FName("Other"), EDataFormat::R16F);
+		const UWorldDataLayer* Field = Subsystem->GetDataLayer(FieldAsset->LayerName);
+		const UWorldDataLayer* Other = Subsystem->GetDataLayer(OtherAsset->LayerName);
+
+		auto RegisterOp = [&](FName LayerName, FName DerivationMethod, TArray<FName> SourceLayerNames)
+		{
+			UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+			LayerAsset->LayerName = LayerName;
+			LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+			LayerAsset->Resolution = FIntPoint(100, 100);
+			LayerAsset->DataFormat = EDataFormat::R16F;
+			LayerAsset->Mutability = EWorldDataLayerMutability::Derivative;
+			LayerAsset->DerivationMethod = DerivationMethod;
+			LayerAsset->SourceLayerNames = SourceLayerNames;
+			return LayerAsset;
+		};
+
+		UWorldDataLayerAsset* BlurAsset = RegisterOp(FName("Blurred"), FWorldLayerImageOpDerivations::BoxBlur, {FieldAsset->LayerName});
+		BlurAsset->ImageOp.Radius = 2;
+		Subsystem->RegisterDataLayer(BlurAsset);
+		UWorldDataLayerAsset* DilateAsset = RegisterOp(FName("Dilated"), FWorldLayerImageOpDerivations::Dilate, {FieldAsset->LayerName});
+		DilateAsset->ImageOp.Radius = 1;
+		Subsystem->RegisterDataLayer(DilateAsset);
+		UWorldDataLayerAsset* ThresholdAsset = RegisterOp(FName("Thresholded"), FWorldLayerImageOpDerivations::Threshold, {FieldAsset->LayerName});
+		ThresholdAsset->ImageOp.Threshold = 0.5f;
+		Subsystem->RegisterDataLayer(ThresholdAsset);
+		UWorldDataLayerAsset* SumAsset = RegisterOp(FName("Summed"), FWorldLayerImageOpDerivations::WeightedSum, {FieldAsset->LayerName, OtherAsset->LayerName});
+		SumAsset->ImageOp.Weights = {2.0f, -1.0f};
+		Subsystem->RegisterDataLayer(SumAsset);
+		UWorldDataLayerAsset* GradientAsset = RegisterOp(FName("Gradient"), FWorldLayerImageOpDerivations::GradientMagnitude, {FieldAsset->LayerName});
+		Subsystem->RegisterDataLayer(GradientAsset);
+		UWorldDataLayerAsset* GaussianAsset = RegisterOp(FName("Gaussian"), FWorldLayerImageOpDerivations::GaussianBlur, {FieldAsset->LayerName});
+		GaussianAsset->ImageOp.Radius = 2;
+		GaussianAsset->ImageOp.Sigma = 1.0f;
+		Subsystem->RegisterDataLayer(GaussianAsset);
+		UWorldDataLayerAsset* ErodeAsset = RegisterOp(FName("Eroded"), FWorldLayerImageOpDerivations::Erode, {FieldAsset->LayerName});
+		ErodeAsset->ImageOp.Radius = 1;
+		Subsystem->RegisterDataLayer(ErodeAsset);
+
+		// Falls linearly from 1 at the input minimum to 0 at the maximum
+		UCurveFloat* InvertCurve = NewObject<UCurveFloat>();
+		InvertCurve->FloatCurve.AddKey(0.0f, 1.0f);
+		InvertCurve->FloatCurve.AddKey(1.0f, 0.0f);
+		UWorldDataLayerAsset* RemapAsset = RegisterOp(FName("Remapped"), FWorldLayerImageOpDerivations::RemapCurve, {FieldAsset->LayerName});
+		RemapAsset->ImageOp.RemapCurve = InvertCurve;
+		Subsystem->RegisterDataLayer(RemapAsset);
+
+		UWorldDataLayerAsset* MinimumAsset = RegisterOp(FName("Minimum"), FWorldLayerImageOpDerivations::Minimum, {FieldAsset->LayerName, OtherAsset->LayerName});
+		Subsystem->RegisterDataLayer(MinimumAsset);
+		UWorldDataLayerAsset* MaximumAsset = RegisterOp(FName("Maximum"), FWorldLayerImageOpDerivations::Maximum, {FieldAsset->LayerName, OtherAsset->LayerName});
+		Subsystem->RegisterDataLayer(MaximumAsset);
+
+		FRandomStream Random(19);
+		for (int32 Index = 0; Index < 300; ++Index)
+		{
+			const FIntPoint Pixel(Random.RandRange(0, 99), Random.RandRange(0, 99));
+			Subsystem->SetValueAtLocation(FieldAsset->LayerName, Subsystem->PixelToWorldLocation(Pixel, Field), FLinearColor(Random.FRand(), 0.0f, 0.0f, 0.0f));
+			Subsystem->SetValueAtLocation(OtherAsset->LayerName, Subsystem->PixelToWorldLocation(Pixel, Other), FLinearColor(Random.FRand(), 0.0f, 0.0f, 0.0f));
+		}
+		Subsystem->UpdateDerivedLayers();
+
+		// Windowed ops read the nearest border cell outside the layer
+		auto GetClamped = [](const UWorldDataLayer* Layer, int32 X, int32 Y)
+		{
+			return Layer->GetValueAtPixel(FIntPoint(FMath::Clamp(X, 0, 99), FMath::Clamp(Y, 0, 99))).R;
+		};
+
+		// Compares every cell of a derived layer with Reference, allowing for 16-bit float rounding
+		auto MatchesBruteForce = [&](const UWorldDataLayerAsset* Asset, TFunctionRef<float(int32, int32)> Reference)
+		{
+			const UWorldDataLayer* Layer = Subsystem->GetDataLayer(Asset->LayerName);
+			int32 NumMismatches = 0;
+			for (int32 Y = 0; Y < 100; ++Y)
+			{
+				for (int32 X = 0; X < 100; ++X)
+				{
+					const float Expected = Reference(X, Y);
+					if (!FMath::IsNearlyEqual(Layer->GetValueAtPixel(FIntPoint(X, Y)).R, Expected, FMath::Abs(Expected) * 2e-3f + 2e-3f))
+					{
+						++NumMismatches;
+					}
+				}
+			}
+			return Test->TestEqual(*FString::Printf(TEXT("%s should match the brute force reference"), *Asset->LayerName.ToString()), NumMismatches, 0);
+		};
+
+		auto BoxBlurReference = [&](int32 X, int32 Y)
+		{
+			float Sum = 0.0f;
+			for (int32 DY = -2; DY <= 2; ++DY)
+			{
+				for (int32 DX = -2; DX <= 2; ++DX)
+				{
+					Sum += GetClamped(Field, X + DX, Y + DY);
+				}
+			}
+			return Sum / 25.0f;
+		};
+
+		Res &= MatchesBruteForce(BlurAsset, BoxBlurReference);
+		Res &= MatchesBruteForce(DilateAsset, [&](int32 X, int32 Y)
+		{
+			float Max = -MAX_flt;
+			for (int32 DY = -1; DY <= 1; ++DY)
+			{
+				for (int32 DX = -1; DX <= 1; ++DX)
+				{
+					Max = FMath::Max(Max, GetClamped(Field, X + DX, Y + DY));
+				}
+			}
+			return Max;
+		});
+		Res &= MatchesBruteForce(ThresholdAsset, [&](int32 X, int32 Y)
+		{
+			return GetClamped(Field, X, Y) >= 0.5f ? 1.0f : 0.0f;
+		});
+		Res &= MatchesBruteForce(SumAsset, [&](int32 X, int32 Y)
+		{
+			return GetClamped(Field, X, Y) * 2.0f - GetClamped(Other, X, Y);
+		});
+		Res &= MatchesBruteForce(GradientAsset, [&](int32 X, int32 Y)
+		{
+			const float GX = (GetClamped(Field, X + 1, Y) - GetClamped(Field, X - 1, Y)) * 0.5f;
+			const float GY = (GetClamped(Field, X, Y + 1) - GetClamped(Field, X, Y - 1)) * 0.5f;
+			return FMath::Sqrt(GX * GX + GY * GY);
+		});
+
+		float GaussianWeights[5];
+		float GaussianSum = 0.0f;
+		for (int32 Tap = 0; Tap < 5; ++Tap)
+		{
+			GaussianWeights[Tap] = FMath::Exp(-(Tap - 2) * (Tap - 2) / 2.0f);
+			GaussianSum += GaussianWeights[Tap];
+		}
+		Res &= MatchesBruteForce(GaussianAsset, [&](int32 X, int32 Y)
+		{
+			float Sum = 0.0f;
+			for (int32 DY = -2; DY <= 2; ++DY)
+			{
+				for (int32 DX = -2; DX <= 2; ++DX)
+				{
+					Sum += GetClamped(Field, X + DX, Y + DY) * GaussianWeights[DX + 2] * GaussianWeights[DY + 2];
+				}
+			}
+			return Sum / (GaussianSum * GaussianSum);
+		});
+		Res &= MatchesBruteForce(ErodeAsset, [&](int32 X, int32 Y)
+		{
+			float Min = MAX_flt;
+			for (int32 DY = -1; DY <= 1; ++DY)
+			{
+				for (int32 DX = -1; DX <= 1; ++DX)
+				{
+					Min = FMath::Min(Min, GetClamped(Field, X + DX, Y + DY));
+				}
+			}
+			return Min;
+		});
+		Res &= MatchesBruteForce(RemapAsset, [&](int32 X, int32 Y)
+		{
+			return 1.0f - GetClamped(Field, X, Y);
+		});
+		Res &= MatchesBruteForce(MinimumAsset, [&](int32 X, int32 Y)
+		{
+			return FMath::Min(GetClamped(Field, X, Y), GetClamped(Other, X, Y));
+		});
+		Res &= MatchesBruteForce(MaximumAsset, [&](int32 X, int32 Y)
+		{
+			return FMath::Max(GetClamped(Field, X, Y), GetClamped(Other, X, Y));
+		});
+
+		// An edit recomputes only the tiles the blur radius reaches
+		Subsystem->SetValueAtLocation(FieldAsset->LayerName, Subsystem->PixelToWorldLocation(FIntPoint(10, 10), Field), FLinearColor(1.0f, 0.0f, 0.0f, 0.0f));
+		Subsystem->UpdateDerivedLayers();
+		Res &= MatchesBruteForce(BlurAsset, BoxBlurReference);
+
+		return Res;
+	}
+
+	bool TestDominant3PacksHeaviestBiomes() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersDerivationTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		TArray<FName> BiomeNames;
+		for (int32 Biome = 0; Biome < 5; ++Biome)
+		{
+			BiomeNames.Add(Context.RegisterLayer(FName(*FString::Printf(TEXT("Biome%d"), Biome)), EDataFormat::R8)->LayerName);
+		}
+
+		UWorldDataLayerAsset* PackedAsset = NewObject<UWorldDataLayerAsset>();
+		PackedAsset->LayerName = FName("Dom3");
+		PackedAsset->ResolutionMode = EResolutionMode::Absolute;
+		PackedAsset->Resolution = FIntPoint(100, 100);
+		PackedAsset->DataFormat = EDataFormat::RGBA8;
+		PackedAsset->Mutability = EWorldDataLayerMutability::Derivative;
+		PackedAsset->DerivationMethod = FWorldLayerImageOpDerivations::Dominant3;
+		PackedAsset->SourceLayerNames = BiomeNames;
+		Subsystem->RegisterDataLayer(PackedAsset);
+
+		// Four biomes overlap at the first location; the lightest one is dropped. Only one biome covers the second.
+		const FVector2D MixedLocation(10.5f, 10.5f);
+		const FVector2D PureLocation(-30.5f, 20.5f);
+		Subsystem->SetValueAtLocation(BiomeNames[1], MixedLocation, FLinearColor(0.2f, 0.0f, 0.0f, 0.0f));
+		Subsystem->SetValueAtLocation(BiomeNames[2], MixedLocation, FLinearColor(0.6f, 0.0f, 0.0f, 0.0f));
+		Subsystem->SetValueAtLocation(BiomeNames[3], MixedLocation, FLinearColor(0.05f, 0.0f, 0.0f, 0.0f));
+		Subsystem->SetValueAtLocation(BiomeNames[4], MixedLocation, FLinearColor(0.2f, 0.0f, 0.0f, 0.0f));
+		Subsystem->SetValueAtLocation(BiomeNames[3], PureLocation, FLinearColor(1.0f, 0.0f, 0.0f, 0.0f));
+		Subsystem->UpdateDerivedLayers();
+
+		const FVector2D Locations[3] = {MixedLocation, PureLocation, FVector2D(0.5f, 0.5f)};
+		FWorldLayerDominant3Sample Samples[3];
+		Res &= Test->TestTrue("Batch decode should succeed on an RGBA8 layer", Subsystem->GetDominant3AtLocations(PackedAsset->LayerName, Locations, Samples));
+
+		// Weights of the three heaviest, renormalized and rounded to fifteenths; ties keep the lower ID first
+		Res &= Test->TestEqual("The heaviest biome should come first", (int32)Samples[0].Biomes[0], 2);
+		Res &= Test->TestEqual("Tied biomes should keep the lower ID second", (int32)Samples[0].Biomes[1], 1);
+		Res &= Test->TestEqual("Tied biomes should keep the higher ID third", (int32)Samples[0].Biomes[2], 4);
+		Res &= Test->TestEqual("The first weight should be the heaviest share", Samples[0].Weights[0], 9.0f / 15.0f, KINDA_SMALL_NUMBER);
+		Res &= Test->TestEqual("The second weight should be its share", Samples[0].Weights[1], 3.0f / 15.0f, KINDA_SMALL_NUMBER);
+		Res &= Test->TestEqual("The third weight should be the rest", Samples[0].Weights[2], 3.0f / 15.0f, KINDA_SMALL_NUMBER);
+
+		Res &= Test->TestEqual("A single biome should fill the first slot", (int32)Samples[1].Biomes[0], 3);
+		Res &= Test->TestEqual("A single biome should carry all weight", Samples[1].Weights[0], 1.0f, KINDA_SMALL_NUMBER);
+		Res &= Test->TestEqual("Slots without weight should repeat the first biome", (int32)Samples[1].Biomes[2], 3);
+		Res &= Test->TestEqual("Cells without any biome should decode to biome 0", (int32)Samples[2].Biomes[0], 0);
+		Res &= Test->TestEqual("Cells without any biome should give biome 0 all weight", Samples[2].Weights[0], 1.0f, KINDA_SMALL_NUMBER);
+
+		// The stored cell decodes like the material node: IDs are round(channel * 255), weights are alpha nibbles over 15
+		FLinearColor Packed;
+		Subsystem->GetValueAtLocation(PackedAsset->LayerName, MixedLocation, Packed);
+		const int32 Alpha = FMath::RoundToInt(Packed.A * 255.0f);
+		Res &= Test->TestEqual("R should hold the first biome ID", FMath::RoundToInt(Packed.R * 255.0f), 2);
+		Res &= Test->TestEqual("The alpha high nibble should hold the first weight", Alpha >> 4, 9);
+		Res &= Test->TestEqual("The alpha low nibble should hold the second weight", Alpha & 0x0F, 3);
+
+		return Res;
+	}
+};
+
+bool FRancWorldLayersDerivationTest::RunTest(const FString& Parameters)
+{
+	FWorldDataLayersDerivationTestScenarios Scenarios(this);
+
+	bool bResult = true;
+
+	bResult &= Scenarios.TestDistanceFieldMatchesBruteForce();
+	bResult &= Scenarios.TestRegisteredKernelDerivesLayer();
+	bResult &= Scenarios.TestReregisteredDerivativeIsRecomputed();
+	bResult &= Scenarios.TestDirtyTilesPropagateThroughGraph();
+	bResult &= Scenarios.TestImageOpsMatchBruteForce();
+	bResult &= Scenarios.TestDominant3PacksHeaviestBiomes();
+
+	return bResult;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -4,6 +4,14 @@
 #include "Framework/DebugTestResult.h"
 #include "WorldDataLayerAsset.h"
 #include "Engine/TextureRenderTarget2D.h"
+#include "Engine/Texture2DArray.h"
+#include "WorldLayerReadback.h"
+#include "WorldDataLayerTileStore.h"
+#include "WorldLayerStagingPool.h"
+#include "WorldLayerUploadScheduler.h"
+#include "MaterialExpressionWorldLayerSample.h"
+#include "Materials/Material.h"
+#include "MaterialShared.h"
 
 #if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
 
@@ -34,6 +42,53 @@ private:
 	UWorldLayersSubsystem* Subsystem;
 };
 
+// Serves texels prepared on the CPU after a number of polls, like a GPU copy in flight. Runs under NullRHI.
+class FMockReadbackTransfer : public IWorldLayerReadbackTransfer
+{
+public:
+	FMockReadbackTransfer(FWorldLayerReadbackTexels&& InTexels, int32 InPollsUntilReady)
+		: Texels(MoveTemp(InTexels)),
+		  PollsUntilReady(InPollsUntilReady)
+	{
+	}
+
+	virtual EWorldLayerReadbackPoll Poll(FWorldLayerReadbackTexels& OutTexels) override
+	{
+		if (--PollsUntilReady > 0)
+		{
+			return EWorldLayerReadbackPoll::Pending;
+		}
+		OutTexels = MoveTemp(Texels);
+		return EWorldLayerReadbackPoll::Ready;
+	}
+
+private:
+	FWorldLayerReadbackTexels Texels;
+	int32 PollsUntilReady;
+};
+
+// Records what the upload scheduler releases instead of touching the GPU
+class FMockUploadSink : public IWorldLayerUploadSink
+{
+public:
+	virtual void Upload(FName LayerName, const FIntRect& Region) override
+	{
+		Uploads.Emplace(LayerName, Region);
+	}
+
+	int32 CountRows(FName LayerName) const
+	{
+		int32 Rows = 0;
+		for (const TPair<FName, FIntRect>& Upload : Uploads)
+		{
+			Rows += Upload.Key == LayerName ? Upload.Value.Height() : 0;
+		}
+		return Rows;
+	}
+
+	TArray<TPair<FName, FIntRect>> Uploads;
+};
+
 // Class containing individual test scenarios
 class FWorldDataLayersGPUIntegrationTestScenarios
 {
@@ -101,6 +156,419 @@ public:
 
 		return Res;
 	}
+
+	bool TestDirtyRegionsCoverOnlyChangedCells() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersGPUIntegrationTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = FName("DirtyRegionLayer");
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(256, 256);
+		LayerAsset->DataFormat = EDataFormat::R8;
+		Subsystem->RegisterDataLayer(LayerAsset);
+
+		UWorldDataLayer* DataLayer = const_cast<UWorldDataLayer*>(Subsystem->GetDataLayer(LayerAsset->LayerName));
+		TArray<FIntRect> Regions;
+
+		// A fresh layer uploads everything once
+		Res &= Test->TestTrue("A new layer should be dirty", DataLayer->IsDirty());
+		DataLayer->ConsumeDirtyRegions(Regions);
+		Res &= Test->TestEqual("A new layer should upload as one region", Regions.Num(), 1);
+		Res &= Test->TestTrue("The region should cover the whole layer", Regions[0] == FIntRect(0, 0, 256, 256));
+		Res &= Test->TestFalse("Consuming should clear the dirty state", DataLayer->IsDirty());
+
+		// Two cells in the same tile collapse to their bounds
+		const uint32 RevisionBefore = DataLayer->GetRevision();
+		DataLayer->SetValueAtPixel(FIntPoint(3, 4), FLinearColor::White);
+		DataLayer->SetValueAtPixel(FIntPoint(10, 6), FLinearColor::White);
+		Res &= Test->TestTrue("Writes should bump the revision", DataLayer->GetRevision() != RevisionBefore);
+		DataLayer->ConsumeDirtyRegions(Regions);
+		Res &= Test->TestEqual("Cells in one tile should yield one region", Regions.Num(), 1);
+		Res &= Test->TestTrue("The region should be the bounds of the written cells", Regions[0] == FIntRect(3, 4, 11, 7));
+
+		// Cells in distant tiles stay separate uploads
+		DataLayer->SetValueAtPixel(FIntPoint(0, 0), FLinearColor::White);
+		DataLayer->SetValueAtPixel(FIntPoint(200, 200), FLinearColor::White);
+		DataLayer->ConsumeDirtyRegions(Regions);
+		Res &= Test->TestEqual("Distant cells should yield two regions", Regions.Num(), 2);
+		Res &= Test->TestTrue("First region", Regions[0] == FIntRect(0, 0, 1, 1));
+		Res &= Test->TestTrue("Second region", Regions[1] == FIntRect(200, 200, 201, 201));
+
+		// Writing the value a cell already holds changes nothing, so nothing uploads
+		const uint32 RevisionUnchanged = DataLayer->GetRevision();
+		DataLayer->SetValueAtPixel(FIntPoint(0, 0), FLinearColor::White);
+		Res &= Test->TestFalse("Rewriting a cell's value should not dirty the layer", DataLayer->IsDirty());
+		Res &= Test->TestEqual("Rewriting a cell's value should not bump the revision", DataLayer->GetRevision(), RevisionUnchanged);
+
+		// Neighbouring tiles in a row merge when the merged rect stays tight
+		DataLayer->MarkDirty(FIntRect(60, 10, 70, 12));
+		DataLayer->ConsumeDirtyRegions(Regions);
+		Res &= Test->TestEqual("A rect straddling a tile border should merge back into one region", Regions.Num(), 1);
+		Res &= Test->TestTrue("Merged region", Regions[0] == FIntRect(60, 10, 70, 12));
+
+		return Res;
+	}
+
+	bool TestReadbackConvertsEveryFormat() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersGPUIntegrationTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		// The mock copies what the upload would have put on the GPU, with padded rows like a staging buffer
+		Subsystem->SetReadbackTransferFactory([](const UWorldDataLayer& Layer, const FIntRect& Rect)
+		{
+			const EDataFormat DataFormat = Layer.Config->DataFormat;
+			const int64 RowBytes = (int64)Rect.Width() * FWorldLayerGpuFormat::GetBytesPerTexel(DataFormat);
+			FWorldLayerReadbackTexels Texels;
+			Texels.RowPitch = RowBytes + 12;
+			Texels.Data.SetNumZeroed(Texels.RowPitch * Rect.Height());
+			for (int32 Y = 0; Y < Rect.Height(); ++Y)
+			{
+				uint8* Row = Texels.Data.GetData() + Y * Texels.RowPitch;
+				Layer.Storage.CopyRect(FIntRect(Rect.Min.X, Rect.Min.Y + Y, Rect.Max.X, Rect.Min.Y + Y + 1), Row, (int32)RowBytes);
+				FWorldLayerGpuFormat::ConvertToGpu(DataFormat, Row, Rect.Width());
+			}
+			return TUniquePtr<IWorldLayerReadbackTransfer>(new FMockReadbackTransfer(MoveTemp(Texels), 2));
+		});
+
+		const FIntPoint Cell(5, 6);
+		const FLinearColor GpuValue(0.75f, 0.5f, 0.25f, 1.0f);
+		const EDataFormat Formats[] = {EDataFormat::R8, EDataFormat::R16F, EDataFormat::RGBA8, EDataFormat::RGBA16F};
+		for (const EDataFormat Format : Formats)
+		{
+			UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+			LayerAsset->LayerName = FName(*FString::Printf(TEXT("ReadbackLayer%d"), (int32)Format));
+			LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+			LayerAsset->Resolution = FIntPoint(16, 16);
+			LayerAsset->DataFormat = Format;
+			LayerAsset->GPUConfiguration.bIsGPUWritable = true;
+			LayerAsset->GPUConfiguration.ReadbackBehavior = EWorldDataLayerReadbackBehavior::OnDemand;
+			Subsystem->RegisterDataLayer(LayerAsset);
+			UWorldDataLayer* DataLayer = const_cast<UWorldDataLayer*>(Subsystem->GetDataLayer(LayerAsset->LayerName));
+			const FString Name = LayerAsset->LayerName.ToString();
+
+			// The CPU value changes after the copy was taken; the readback brings the GPU value back
+			DataLayer->SetValueAtPixel(Cell, GpuValue);
+			const FLinearColor Expected = DataLayer->GetValueAtPixel(Cell);
+			TFuture<FWorldLayerReadbackResult> Future = Subsystem->RequestReadback(LayerAsset->LayerName, FIntRect(4, 4, 12, 10));
+			DataLayer->SetValueAtPixel(Cell, FLinearColor::Black);
+
+			Subsystem->PollReadbacks();
+			Res &= Test->TestFalse(*(Name + ": the readback should still be in flight after one poll"), Future.IsReady());
+			Res &= Test->TestEqual(*(Name + ": the second poll should complete the readback"), Subsystem->PollReadbacks(), 1);
+			Res &= Test->TestTrue(*(Name + ": the future should be fulfilled"), Future.IsReady());
+
+			const FWorldLayerReadbackResult& Result = Future.Get();
+			Res &= Test->TestTrue(*(Name + ": the readback should succeed"), Result.bSucceeded);
+			Res &= Test->TestTrue(*(Name + ": the result should cover the requested rect"), Result.Rect == FIntRect(4, 4, 12, 10));
+			Res &= Test->TestTrue(*(Name + ": the result should hold the GPU value in the layer encoding"), Result.GetValue(Cell).Equals(Expected));
+			Res &= Test->TestTrue(*(Name + ": OnDemand should write the GPU value back into the layer"), DataLayer->GetValueAtPixel(Cell).Equals(Expected));
+		}
+
+		// RGBA8 texels are BGRA on the GPU
+		uint8 Pixel[4] = {10, 20, 30, 40};
+		FWorldLayerGpuFormat::ConvertToGpu(EDataFormat::RGBA8, Pixel, 1);
+		Res &= Test->TestEqual("RGBA8 cells should upload with red and blue swapped", (int32)Pixel[0], 30);
+
+		// Requests outside the layer fail at once instead of waiting for a tick
+		TFuture<FWorldLayerReadbackResult> Outside = Subsystem->RequestReadback(FName("ReadbackLayer0"), FIntRect(100, 100, 110, 110));
+		Res &= Test->TestTrue("A request outside the layer should be fulfilled immediately", Outside.IsReady());
+		Res &= Test->TestFalse("A request outside the layer should fail", Outside.Get().bSucceeded);
+
+		return Res;
+	}
+
+	bool TestUploadSchedulerSplitsByBudgetAndPriority() const
+	{
+		FDebugTestResult Res = true;
+		const FName Terrain("Terrain");
+		const FName Fog("Fog");
+
+		// 64 R8 rows of 64 cells per frame
+		FWorldLayerUploadScheduler Scheduler;
+		Scheduler.SetBudget(64 * 64);
+		Scheduler.Enqueue(Fog, FIntRect(0, 0, 64, 64), 1, 0);
+		Scheduler.Enqueue(Terrain, FIntRect(0, 0, 64, 128), 1, 10);
+		Scheduler.Enqueue(Terrain, FIntRect(8, 8, 16, 16), 1, 10);
+		Res &= Test->TestEqual("A region inside a queued one should not queue again", Scheduler.GetStats().QueuedRegions, 2);
+		Res &= Test->TestEqual("Queued bytes should cover both layers", Scheduler.GetStats().QueuedBytes, (int64)64 * 192);
+
+		FMockUploadSink Sink;
+		Res &= Test->TestEqual("The first frame should spend the whole budget", Scheduler.Flush(Sink), (int64)64 * 64);
+		Res &= Test->TestEqual("The higher priority layer should go first", Sink.CountRows(Terrain), 64);
+		Res &= Test->TestEqual("The lower priority layer should wait", Sink.CountRows(Fog), 0);
+		Res &= Test->TestEqual("Bytes per frame should be reported", Scheduler.GetStats().BytesLastFrame, (int64)64 * 64);
+
+		Scheduler.Flush(Sink);
+		Res &= Test->TestEqual("The second frame should finish the split region", Sink.CountRows(Terrain), 128);
+		Res &= Test->TestTrue("The split should continue where it stopped", Sink.Uploads.Last().Value == FIntRect(0, 64, 64, 128));
+		Scheduler.Flush(Sink);
+		Res &= Test->TestEqual("The third frame should upload the lower priority layer", Sink.CountRows(Fog), 64);
+		Res &= Test->TestEqual("The queue should be empty", Scheduler.GetStats().QueuedRegions, 0);
+
+		// A budget below one row still moves one row per frame
+		Scheduler.SetBudget(16);
+		Scheduler.Enqueue(Fog, FIntRect(0, 0, 64, 2), 1, 0);
+		Scheduler.Flush(Sink);
+		Res &= Test->TestEqual("A tiny budget should still release one row", Scheduler.GetStats().RegionsLastFrame, 1);
+		Res &= Test->TestEqual("One row should remain", Scheduler.GetStats().QueuedBytes, (int64)64);
+
+		// No budget releases everything
+		Scheduler.SetBudget(0);
+		Scheduler.Enqueue(Terrain, FIntRect(0, 0, 256, 256), 4, 0);
+		Scheduler.Flush(Sink);
+		Res &= Test->TestEqual("An unlimited budget should empty the queue", Scheduler.GetStats().QueuedRegions, 0);
+
+		// A readback flushes its layer past the budget and leaves the others queued
+		Scheduler.SetBudget(64);
+		Scheduler.Enqueue(Terrain, FIntRect(0, 0, 64, 64), 1, 0);
+		Scheduler.Enqueue(Fog, FIntRect(0, 0, 64, 64), 1, 0);
+		Res &= Test->TestTrue("A layer with queued regions should report them", Scheduler.IsLayerQueued(Fog));
+		Res &= Test->TestEqual("Flushing one layer should release all of it", Scheduler.FlushLayer(Fog, Sink), (int64)64 * 64);
+		Res &= Test->TestFalse("The flushed layer should have nothing queued", Scheduler.IsLayerQueued(Fog));
+		Res &= Test->TestTrue("Other layers should stay queued", Scheduler.IsLayerQueued(Terrain));
+
+		return Res;
+	}
+
+	bool TestUploadSchedulerDoesNotStarveLowPriority() const
+	{
+		FDebugTestResult Res = true;
+		const FName Busy("Busy");
+		const FName Quiet("Quiet");
+		const FName Other("Other");
+
+		FWorldLayerUploadScheduler Scheduler;
+		Scheduler.SetBudget(64 * 64);
+		Scheduler.Enqueue(Quiet, FIntRect(0, 0, 64, 64), 1, 0);
+
+		// The busy layer changes every frame by a full budget, with a priority five above the quiet one
+		FMockUploadSink Sink;
+		int32 QuietFrame = INDEX_NONE;
+		for (int32 Frame = 0; Frame < 20 && QuietFrame == INDEX_NONE; ++Frame)
+		{
+			Scheduler.Enqueue(Busy, FIntRect(0, 0, 64, 64), 1, 5);
+			Scheduler.Flush(Sink);
+			if (Sink.CountRows(Quiet) > 0)
+			{
+				QuietFrame = Frame;
+			}
+		}
+		Res &= Test->TestTrue("The quiet layer should wait while the busy layer has priority", QuietFrame > 0);
+		Res &= Test->TestTrue("Waiting should lift the quiet layer past the priority gap", QuietFrame != INDEX_NONE && QuietFrame <= 6);
+
+		// Equal priorities go in the order they were queued
+		Scheduler.Reset();
+		Sink.Uploads.Reset();
+		Scheduler.Enqueue(Other, FIntRect(0, 0, 64, 64), 1, 0);
+		Scheduler.Enqueue(Quiet, FIntRect(0, 0, 64, 64), 1, 0);
+		Scheduler.Flush(Sink);
+		Res &= Test->TestTrue("The older of two equal priorities should go first", Sink.Uploads.Num() == 1 && Sink.Uploads[0].Key == Other);
+
+		return Res;
+	}
+
+	bool TestStagingPoolRecyclesReleasedBlocks() const
+	{
+		FDebugTestResult Res = true;
+		FWorldLayerStagingPool Pool;
+
+		// Two uploads in flight at once need two blocks
+		FWorldLayerStagingBlock& First = Pool.Acquire(4096);
+		FWorldLayerStagingBlock& Second = Pool.Acquire(1024);
+		Res &= Test->TestTrue("Blocks in flight should not be handed out twice", &First != &Second);
+		Res &= Test->TestEqual("Both blocks should be in flight", Pool.GetStats().BlocksInFlight, 2);
+		First.Release();
+		Second.Release();
+		Res &= Test->TestFalse("Released blocks should not count as in flight", Pool.HasBlocksInFlight());
+
+		// Steady state: the same uploads every frame reuse the released blocks
+		const int32 AllocationsBefore = Pool.GetStats().NumAllocations;
+		for (int32 Frame = 0; Frame < 10; ++Frame)
+		{
+			FWorldLayerStagingBlock& Small = Pool.Acquire(1024);
+			FWorldLayerStagingBlock& Large = Pool.Acquire(4096);
+			Res &= Test->TestTrue("The smallest block that fits should be picked", &Small == &Second && &Large == &First);
+			Small.Release();
+			Large.Release();
+		}
+		Res &= Test->TestEqual("Steady-state uploads should not allocate", Pool.GetStats().NumAllocations, AllocationsBefore);
+		Res &= Test->TestEqual("No blocks should be added in steady state", Pool.GetStats().NumBlocks, 2);
+
+		// A larger upload grows a released block rather than adding one
+		FWorldLayerStagingBlock& Grown = Pool.Acquire(8192);
+		Res &= Test->TestEqual("The grown block should hold the request", Grown.GetSize(), (int64)8192);
+		Res &= Test->TestEqual("Growing should reuse a released block", Pool.GetStats().NumBlocks, 2);
+		Grown.Release();
+		Pool.Reset();
+		Res &= Test->TestEqual("Reset should free every block", Pool.GetStats().ReservedBytes, (int64)0);
+
+		return Res;
+	}
+
+	bool TestUploadsReadSharedTilesInPlace() const
+	{
+		FDebugTestResult Res = true;
+		const uint8 Zero = 0;
+		const uint8 Before = 10;
+		const uint8 After = 20;
+
+		FWorldDataLayerTileStore Store;
+		Store.Initialize(FIntPoint(128, 128), 1, &Zero, false);
+		Store.SetPixel(3, 3, &Before);
+
+		// R8 goes to the GPU as stored, so the upload reads the tile where it lies and holds it while in flight
+		FWorldLayerStagingPool Pool;
+		const FIntRect Dirty(0, 0, 8, 8);
+		FWorldLayerStagingBlock& Block = Pool.Stage(Store, EDataFormat::R8, MakeArrayView(&Dirty, 1));
+		Res &= Test->TestEqual("Zero-copy uploads should not reserve staging memory", Pool.GetStats().ReservedBytes, (int64)0);
+		Res &= Test->TestTrue("The staged region should point into the layer's tile", Block.Regions.Num() == 1 && Block.Regions[0].Data == Store.GetPixel(0, 0));
+		if (Block.Regions.Num() != 1)
+		{
+			Block.Release();
+			return Res;
+		}
+		const uint8* Held = Block.Regions[0].Data + 3 * Block.Regions[0].Pitch + 3;
+		Res &= Test->TestTrue("The staged cell should be the layer's cell", Held == Store.GetPixel(3, 3));
+
+		// The game thread keeps writing; the upload still sees the cells it was handed
+		Store.SetPixel(3, 3, &After);
+		Res &= Test->TestTrue("Writing a tile held by an upload should clone it", Store.GetPixel(3, 3) != Held);
+		Res &= Test->TestEqual("The held tile should not change", (int32)*Held, (int32)Before);
+		Res &= Test->TestEqual("The layer should see the write", (int32)*Store.GetPixel(3, 3), (int32)After);
+		Block.Release();
+
+		// An upload of the new tile that has finished no longer holds it, so the next write goes in place
+		FWorldLayerStagingBlock& Next = Pool.Stage(Store, EDataFormat::R8, MakeArrayView(&Dirty, 1));
+		const uint8* Staged = Next.Regions[0].Data + 3 * Next.Regions[0].Pitch + 3;
+		Res &= Test->TestTrue("Staging should share the current tile", Staged == Store.GetPixel(3, 3));
+		Next.Release();
+		Store.SetPixel(3, 3, &Before);
+		Res &= Test->TestTrue("A tile whose upload was released should not be cloned", Store.GetPixel(3, 3) == Staged);
+		Res &= Test->TestEqual("The write should land in the released tile", (int32)*Staged, (int32)Before);
+
+		return Res;
+	}
+
+	bool TestSameSizedLayersShareTextureArray() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersGPUIntegrationTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		const auto MakeLayer = [](FName Name, FIntPoint Resolution, EDataFormat DataFormat)
+		{
+			UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+			LayerAsset->LayerName = Name;
+			LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+			LayerAsset->Resolution = Resolution;
+			LayerAsset->DataFormat = DataFormat;
+			LayerAsset->GPUConfiguration.bKeepUpdatedOnGPU = true;
+			LayerAsset->GPUConfiguration.TextureArrayName = FName("TerrainArray");
+			return LayerAsset;
+		};
+
+		UWorldDataLayerAsset* Moisture = MakeLayer(FName("ArrayMoisture"), FIntPoint(32, 32), EDataFormat::R8);
+		UWorldDataLayerAsset* Snow = MakeLayer(FName("ArraySnow"), FIntPoint(32, 32), EDataFormat::R8);
+		UWorldDataLayerAsset* Biomes = MakeLayer(FName("ArrayBiomes"), FIntPoint(64, 64), EDataFormat::R8);
+		Subsystem->RegisterDataLayer(Moisture);
+		Subsystem->RegisterDataLayer(Snow);
+		Subsystem->RegisterDataLayer(Biomes);
+
+		UTexture* MoistureTexture = Subsystem->GetLayerGpuTexture(Moisture->LayerName);
+		Res &= Test->TestTrue("Packed layers should share one texture array", MoistureTexture && MoistureTexture->IsA<UTexture2DArray>() && MoistureTexture == Subsystem->GetLayerGpuTexture(Snow->LayerName));
+
+		FName TextureArrayName;
+		int32 Slice = INDEX_NONE;
+		Res &= Test->TestTrue("The second layer should be found in the array", Subsystem->GetLayerTextureArraySlice(Snow->LayerName, TextureArrayName, Slice));
+		Res &= Test->TestEqual("Slices should follow registration order", Slice, 1);
+		Res &= Test->TestEqual("The lookup should name the array", TextureArrayName, FName("TerrainArray"));
+
+		// A layer of another resolution cannot join and keeps its own texture
+		Res &= Test->TestFalse("A mismatched layer should not be packed", Subsystem->GetLayerTextureArraySlice(Biomes->LayerName, TextureArrayName, Slice));
+		UTexture* BiomesTexture = Subsystem->GetLayerGpuTexture(Biomes->LayerName);
+		Res &= Test->TestTrue("A mismatched layer should keep a 2D texture", BiomesTexture && !BiomesTexture->IsA<UTexture2DArray>());
+
+		// Materials bake the texture and slices, so re-registering, leaving and joining must not move either
+		Subsystem->RegisterDataLayer(Snow);
+		Subsystem->GetLayerTextureArraySlice(Snow->LayerName, TextureArrayName, Slice);
+		Res &= Test->TestEqual("Re-registering should keep the slice", Slice, 1);
+		Moisture->GPUConfiguration.TextureArrayName = NAME_None;
+		Subsystem->RegisterDataLayer(Moisture);
+		Subsystem->GetLayerTextureArraySlice(Snow->LayerName, TextureArrayName, Slice);
+		Res &= Test->TestEqual("The remaining layer should keep its slice", Slice, 1);
+		Res &= Test->TestTrue("The array should keep its texture when a layer leaves", Subsystem->GetLayerGpuTexture(Snow->LayerName) == MoistureTexture);
+		Res &= Test->TestFalse("A layer that left should have its own texture", Subsystem->GetLayerGpuTexture(Moisture->LayerName)->IsA<UTexture2DArray>());
+
+		// The next layer to join fills the free slice
+		UWorldDataLayerAsset* Ice = MakeLayer(FName("ArrayIce"), FIntPoint(32, 32), EDataFormat::R8);
+		Subsystem->RegisterDataLayer(Ice);
+		Subsystem->GetLayerTextureArraySlice(Ice->LayerName, TextureArrayName, Slice);
+		Res &= Test->TestEqual("A joining layer should fill the free slice", Slice, 0);
+		Res &= Test->TestTrue("Filling a free slice should keep the texture", Subsystem->GetLayerGpuTexture(Ice->LayerName) == MoistureTexture);
+
+		// Growing the array reallocates the same texture object
+		Moisture->GPUConfiguration.TextureArrayName = FName("TerrainArray");
+		Subsystem->RegisterDataLayer(Moisture);
+		Subsystem->GetLayerTextureArraySlice(Moisture->LayerName, TextureArrayName, Slice);
+		Res &= Test->TestEqual("A layer joining a full array should get a new slice", Slice, 2);
+		Res &= Test->TestTrue("Growing should keep the texture", Subsystem->GetLayerGpuTexture(Moisture->LayerName) == MoistureTexture);
+		const UTexture2DArray* ArrayTexture = Cast<UTexture2DArray>(MoistureTexture);
+		Res &= Test->TestTrue("The texture should hold every slice", ArrayTexture && ArrayTexture->GetArraySize() == 3);
+
+		return Res;
+	}
+
+	bool TestWorldLayerSampleCompilesForTextureArrays() const
+	{
+		FDebugTestResult Res = true;
+
+		// A packed layer binds the array its asset names
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = FName("MaterialArrayLayer");
+		LayerAsset->GPUConfiguration.bKeepUpdatedOnGPU = true;
+		LayerAsset->GPUConfiguration.TextureArrayName = FName("MaterialArray");
+
+		UMaterial* Material = NewObject<UMaterial>(GetTransientPackage(), NAME_None, RF_Transient);
+		UMaterialExpressionWorldLayerSample* Sample = NewObject<UMaterialExpressionWorldLayerSample>(Material);
+		Sample->Material = Material;
+		Sample->LayerAsset = LayerAsset;
+		Material->GetExpressionCollection().AddExpression(Sample);
+		Material->GetEditorOnlyData()->BaseColor.Connect(0, Sample);
+
+		FString Message;
+		Res &= Test->TestTrue("The parameter should accept a texture array", Sample->TextureIsValid(UTexture2DArray::CreateTransient(4, 4, 2, PF_G8), Message));
+		Res &= Test->TestTrue("The parameter should accept a 2D texture", Sample->TextureIsValid(UTexture2D::CreateTransient(4, 4, PF_G8), Message));
+		Res &= Test->TestFalse("The parameter should reject a missing texture", Sample->TextureIsValid(nullptr, Message));
+
+		// Translating the graph needs a shader platform, which NullRHI runs do not have
+		if (!FApp::CanEverRender())
+		{
+			Test->AddInfo(TEXT("Skipping the material compile: this run cannot render."));
+			return Res;
+		}
+
+		Material->PreEditChange(nullptr);
+		Material->PostEditChange();
+		FMaterialResource* Resource = Material->GetMaterialResource(GMaxRHIFeatureLevel);
+		Res &= Test->TestNotNull("The material should have a resource for the current feature level", Resource);
+		if (Resource)
+		{
+			Resource->FinishCompilation();
+			for (const FString& Error : Resource->GetCompileErrors())
+			{
+				Test->AddInfo(FString::Printf(TEXT("Material compile error: %s"), *Error));
+			}
+			Res &= Test->TestEqual("A material sampling a packed layer should compile", Resource->GetCompileErrors().Num(), 0);
+		}
+		Res &= Test->TestTrue("The node should bind the array", Sample->Texture && Sample->Texture->IsA<UTexture2DArray>());
+
+		return Res;
+	}
 };
 
 bool FRancWorldLayersGPUIntegrationTest::RunTest(const FString& Parameters)
@@ -110,6 +578,14 @@ bool FRancWorldLayersGPUIntegrationTest::RunTest(const FString& Parameters)
 	bool bResult = true;
 
 	bResult &= Scenarios.TestCPUGPUSyncAndReadback();
+	bResult &= Scenarios.TestDirtyRegionsCoverOnlyChangedCells();
+	bResult &= Scenarios.TestReadbackConvertsEveryFormat();
+	bResult &= Scenarios.TestUploadSchedulerSplitsByBudgetAndPriority();
+	bResult &= Scenarios.TestUploadSchedulerDoesNotStarveLowPriority();
+	bResult &= Scenarios.TestStagingPoolRecyclesReleasedBlocks();
+	bResult &= Scenarios.TestUploadsReadSharedTilesInPlace();
+	bResult &= Scenarios.TestSameSizedLayersShareTextureArray();
+	bResult &= Scenarios.TestWorldLayerSampleCompilesForTextureArrays();
 
 	return bResult;
 }
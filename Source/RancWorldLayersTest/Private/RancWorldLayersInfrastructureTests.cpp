@@ -82,6 +82,44 @@ public:
 
 		return Res;
 	}
+
+	/** Verifies the bulk conversion path: a G8 texture resampled into a sparse half-float layer. */
+	bool TestGrayscaleTextureResampledIntoHalfLayer() const
+	{
+		FDebugTestResult Res = true;
+
+		FRancWorldLayersTestFixture Fixture(FName("TextureResampleTest"));
+		UWorldLayersSubsystem* Subsystem = Fixture.GetSubsystem();
+
+		// 2x2 grayscale texture, every texel covers one 64x64 storage tile of the 128x128 layer
+		UTexture2D* GrayTexture = UTexture2D::CreateTransient(2, 2, PF_G8);
+		uint8* MipData = (uint8*)GrayTexture->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
+		MipData[0] = 0;
+		MipData[1] = 51;
+		MipData[2] = 102;
+		MipData[3] = 255;
+		GrayTexture->GetPlatformData()->Mips[0].BulkData.Unlock();
+		GrayTexture->UpdateResource();
+
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = FName("ResampledLayer");
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(128, 128);
+		LayerAsset->DataFormat = EDataFormat::R16F;
+		LayerAsset->DefaultValue = FLinearColor::Black;
+		LayerAsset->bUseSparseStorage = true;
+		LayerAsset->InitialDataTexture = GrayTexture;
+		Subsystem->RegisterDataLayer(LayerAsset);
+
+		const UWorldDataLayer* DataLayer = Subsystem->GetDataLayer(LayerAsset->LayerName);
+		Res &= Test->TestEqual("Top-left texel", DataLayer->GetValueAtPixel(FIntPoint(10, 10)).R, 0.0f);
+		Res &= Test->TestEqual("Top-right texel", DataLayer->GetValueAtPixel(FIntPoint(100, 10)).R, (float)FFloat16(51 / 255.0f));
+		Res &= Test->TestEqual("Bottom-left texel", DataLayer->GetValueAtPixel(FIntPoint(10, 100)).R, (float)FFloat16(102 / 255.0f));
+		Res &= Test->TestEqual("Bottom-right texel", DataLayer->GetValueAtPixel(FIntPoint(127, 127)).R, 1.0f);
+		Res &= Test->TestEqual("The tile matching the default value should stay implicit", DataLayer->GetNumImplicitTiles(), 1);
+
+		return Res;
+	}
 };
 
 bool FRancWorldLayersInfrastructureTest::RunTest(const FString& Parameters)
@@ -91,6 +129,7 @@ bool FRancWorldLayersInfrastructureTest::RunTest(const FString& Parameters)
 	bool bResult = true;
 	bResult &= Scenarios.TestSubsystemInEditorWorld();
 	bResult &= Scenarios.TestTextureInitialization();
+	bResult &= Scenarios.TestGrayscaleTextureResampledIntoHalfLayer();
 
 	return bResult;
 }
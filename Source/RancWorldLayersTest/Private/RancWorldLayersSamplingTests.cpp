@@ -97,6 +97,66 @@ public:
 		return Res;
 	}
 
+	bool TestBatchedSamplingMatchesSingleQueries() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersSamplingTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = FName("BatchSamplingLayer");
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(10, 10);
+		LayerAsset->DataFormat = EDataFormat::RGBA16F;
+		LayerAsset->DefaultValue = FLinearColor(0.1f, 0.2f, 0.3f, 0.4f);
+		Subsystem->RegisterDataLayer(LayerAsset);
+
+		UWorldDataLayer* DataLayer = const_cast<UWorldDataLayer*>(Subsystem->GetDataLayer(LayerAsset->LayerName));
+		for (int32 Y = 0; Y < 10; ++Y)
+		{
+			for (int32 X = 0; X < 10; ++X)
+			{
+				DataLayer->SetValueAtPixel(FIntPoint(X, Y), FLinearColor(X / 10.0f, Y / 10.0f, (X + Y) / 20.0f, 1.0f));
+			}
+		}
+
+		// An odd count exercises the scalar tail, and the set includes cell borders and out-of-bounds points
+		TArray<FVector2D> Locations;
+		for (int32 Index = 0; Index < 37; ++Index)
+		{
+			Locations.Add(FVector2D(-60.0f + Index * 3.4f, 55.0f - Index * 2.9f));
+		}
+		Locations.Add(FVector2D(0.0f, 0.0f));
+		Locations.Add(FVector2D(-50.0f, -50.0f));
+		Locations.Add(FVector2D(50.0f, 50.0f));
+
+		TArray<FLinearColor> Values;
+		TArray<FLinearColor> InterpolatedValues;
+		TArray<float> FloatValues;
+		Values.SetNum(Locations.Num());
+		InterpolatedValues.SetNum(Locations.Num());
+		FloatValues.SetNum(Locations.Num());
+
+		Res &= Test->TestTrue("Batched sampling should succeed", Subsystem->GetValuesAtLocations(LayerAsset->LayerName, Locations, Values));
+		Res &= Test->TestTrue("Batched interpolated sampling should succeed", Subsystem->GetValuesAtLocationsInterpolated(LayerAsset->LayerName, Locations, InterpolatedValues));
+		Res &= Test->TestTrue("Batched float sampling should succeed", Subsystem->GetFloatValuesAtLocations(LayerAsset->LayerName, Locations, FloatValues));
+
+		for (int32 Index = 0; Index < Locations.Num(); ++Index)
+		{
+			FLinearColor Expected;
+			Subsystem->GetValueAtLocation(LayerAsset->LayerName, Locations[Index], Expected);
+			Res &= Test->TestTrue(FString::Printf(TEXT("Batched value %d should match the single query"), Index), Values[Index].Equals(Expected, 0.0f));
+			Res &= Test->TestEqual(FString::Printf(TEXT("Batched float %d should match the single query"), Index), FloatValues[Index], Subsystem->GetFloatValueAtLocation(LayerAsset->LayerName, Locations[Index]));
+
+			Subsystem->GetValueAtLocationInterpolated(LayerAsset->LayerName, Locations[Index], Expected);
+			Res &= Test->TestTrue(FString::Printf(TEXT("Batched interpolated value %d should match the single query"), Index), InterpolatedValues[Index].Equals(Expected, 0.0f));
+		}
+
+		Res &= Test->TestFalse("Batched sampling of a missing layer should fail", Subsystem->GetValuesAtLocations(FName("MissingLayer"), Locations, Values));
+
+		return Res;
+	}
+
 	bool TestDominant3Unpacking() const
 	{
 		FDebugTestResult Res = true;
@@ -151,6 +211,9 @@ bool FRancWorldLayersSamplingTest::RunTest(const FString& Parameters)
 	AddInfo("Running Test: Dominant3Unpacking");
 	bResult &= Scenarios.TestDominant3Unpacking();
 
+	AddInfo("Running Test: BatchedSamplingMatchesSingleQueries");
+	bResult &= Scenarios.TestBatchedSamplingMatchesSingleQueries();
+
 	return bResult;
 }
 
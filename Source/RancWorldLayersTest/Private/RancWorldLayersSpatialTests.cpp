@@ -101,6 +101,448 @@ public:
 		Res &= Test->TestFalse("Should not find a point outside MaxSearchRadius", bFound);
 		return Res;
 	}
+
+	bool TestFindNearestMatchesBruteForce(EWorldDataLayerStructureType StructureType) const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersSpatialTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = FName("SpatialBruteForceLayer");
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(100, 100);
+		LayerAsset->DataFormat = EDataFormat::R8;
+		LayerAsset->SpatialOptimization.bBuildAccelerationStructure = true;
+		LayerAsset->SpatialOptimization.StructureType = StructureType;
+		LayerAsset->SpatialOptimization.ValuesToTrack.Add(FLinearColor(1.0f, 0.0f, 0.0f, 0.0f));
+		Subsystem->RegisterDataLayer(LayerAsset);
+		const UWorldDataLayer* DataLayer = Subsystem->GetDataLayer(LayerAsset->LayerName);
+
+		// Scatter points, then clear a third of them again so leaves split and drain
+		FRandomStream Random(1234);
+		TSet<FIntPoint> Tracked;
+		for (int32 Index = 0; Index < 400; ++Index)
+		{
+			const FIntPoint Pixel(Random.RandRange(0, 99), Random.RandRange(0, 99));
+			Subsystem->SetValueAtLocation(LayerAsset->LayerName, Subsystem->PixelToWorldLocation(Pixel, DataLayer), FLinearColor::Red);
+			Tracked.Add(Pixel);
+		}
+		TArray<FIntPoint> TrackedArray = Tracked.Array();
+		for (int32 Index = 0; Index < TrackedArray.Num(); Index += 3)
+		{
+			Subsystem->SetValueAtLocation(LayerAsset->LayerName, Subsystem->PixelToWorldLocation(TrackedArray[Index], DataLayer), FLinearColor::Black);
+			Tracked.Remove(TrackedArray[Index]);
+		}
+
+		const float SearchRadius = 12.0f;
+		int32 NumMismatches = 0;
+		for (int32 Query = 0; Query < 200; ++Query)
+		{
+			const FIntPoint SearchPixel(Random.RandRange(0, 99), Random.RandRange(0, 99));
+
+			int64 BestDistSq = MAX_int64;
+			for (const FIntPoint& Point : Tracked)
+			{
+				BestDistSq = FMath::Min(BestDistSq, (int64)(Point - SearchPixel).SizeSquared());
+			}
+			const bool bExpectFound = BestDistSq < SearchRadius * SearchRadius;
+
+			FVector2D FoundLocation;
+			const bool bFound = Subsystem->FindNearestPointWithValue(LayerAsset->LayerName, Subsystem->PixelToWorldLocation(SearchPixel, DataLayer), SearchRadius, FLinearColor(1.0f, 0.0f, 0.0f, 0.0f), FoundLocation);
+			if (bFound != bExpectFound)
+			{
+				++NumMismatches;
+			}
+			else if (bFound)
+			{
+				// Ties may resolve to any of the equally close points, so compare distances
+				const FIntPoint FoundPixel = Subsystem->WorldLocationToPixel(FoundLocation, DataLayer);
+				NumMismatches += Tracked.Contains(FoundPixel) && (FoundPixel - SearchPixel).SizeSquared() == BestDistSq ? 0 : 1;
+			}
+		}
+		Res &= Test->TestEqual("Quadtree nearest queries should match a brute-force scan", NumMismatches, 0);
+
+		return Res;
+	}
+
+	bool TestRadiusAndKNearestMatchBruteForce(EWorldDataLayerStructureType StructureType) const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersSpatialTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = FName("SpatialRadiusLayer");
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(100, 100);
+		LayerAsset->DataFormat = EDataFormat::R8;
+		LayerAsset->SpatialOptimization.bBuildAccelerationStructure = true;
+		LayerAsset->SpatialOptimization.StructureType = StructureType;
+		LayerAsset->SpatialOptimization.ValuesToTrack.Add(FLinearColor(1.0f, 0.0f, 0.0f, 0.0f));
+		Subsystem->RegisterDataLayer(LayerAsset);
+		const UWorldDataLayer* DataLayer = Subsystem->GetDataLayer(LayerAsset->LayerName);
+		const FWorldLayerHandle Handle = Subsystem->GetLayerHandle(LayerAsset->LayerName);
+		const FLinearColor Tracked(1.0f, 0.0f, 0.0f, 0.0f);
+
+		// A dense block makes whole leaves and words fall inside the radius, scattered points make partial ones
+		FRandomStream Random(4321);
+		TSet<FIntPoint> Points;
+		for (int32 Y = 20; Y < 44; ++Y)
+		{
+			for (int32 X = 30; X < 54; ++X)
+			{
+				Points.Add(FIntPoint(X, Y));
+			}
+		}
+		for (int32 Index = 0; Index < 600; ++Index)
+		{
+			Points.Add(FIntPoint(Random.RandRange(0, 99), Random.RandRange(0, 99)));
+		}
+		for (const FIntPoint& Point : Points)
+		{
+			Subsystem->SetValueAtLocation(LayerAsset->LayerName, Subsystem->PixelToWorldLocation(Point, DataLayer), Tracked);
+		}
+
+		constexpr int32 K = 8;
+		constexpr int32 NumOrigins = 50;
+		const float Radius = 15.0f;
+		TArray<FVector2D> Origins;
+		TArray<FIntPoint> OriginPixels;
+		for (int32 Query = 0; Query < NumOrigins; ++Query)
+		{
+			OriginPixels.Add(FIntPoint(Random.RandRange(0, 99), Random.RandRange(0, 99)));
+			Origins.Add(Subsystem->PixelToWorldLocation(OriginPixels.Last(), DataLayer));
+		}
+
+		TArray<FVector2D> BatchLocations;
+		BatchLocations.SetNumZeroed(NumOrigins * K);
+		TArray<int32> BatchKCounts;
+		BatchKCounts.SetNumZeroed(NumOrigins);
+		TArray<int32> BatchRadiusCounts;
+		BatchRadiusCounts.SetNumZeroed(NumOrigins);
+		Subsystem->FindKNearestPointsWithValueBatch(Handle, Origins, Radius, Tracked, BatchLocations, BatchKCounts);
+		Subsystem->CountPointsWithValueInRadiusBatch(Handle, Origins, Radius, Tracked, BatchRadiusCounts);
+
+		int32 NumCountMismatches = 0;
+		int32 NumEnumerationMismatches = 0;
+		int32 NumKNearestMismatches = 0;
+		for (int32 Query = 0; Query < NumOrigins; ++Query)
+		{
+			const FIntPoint& Origin = OriginPixels[Query];
+
+			TArray<int64> InRadiusDistSq;
+			for (const FIntPoint& Point : Points)
+			{
+				const int64 DistSq = (Point - Origin).SizeSquared();
+				if (DistSq < Radius * Radius)
+				{
+					InRadiusDistSq.Add(DistSq);
+				}
+			}
+			InRadiusDistSq.Sort();
+
+			const int32 Count = Subsystem->CountPointsWithValueInRadius(LayerAsset->LayerName, Origins[Query], Radius, Tracked);
+			NumCountMismatches += Count == InRadiusDistSq.Num() && BatchRadiusCounts[Query] == Count ? 0 : 1;
+
+			TArray<FVector2D> Found;
+			Subsystem->FindPointsWithValueInRadius(LayerAsset->LayerName, Origins[Query], Radius, Tracked, Found);
+			TSet<FIntPoint> FoundPixels;
+			for (const FVector2D& Location : Found)
+			{
+				const FIntPoint Pixel = Subsystem->WorldLocationToPixel(Location, DataLayer);
+				NumEnumerationMismatches += Points.Contains(Pixel) && (Pixel - Origin).SizeSquared() < Radius * Radius ? 0 : 1;
+				FoundPixels.Add(Pixel);
+			}
+			NumEnumerationMismatches += FoundPixels.Num() == InRadiusDistSq.Num() ? 0 : 1;
+
+			// Ties may resolve to any of the equally close points, so compare the sorted distances
+			FVector2D Nearest[K];
+			const int32 NumNearest = Subsystem->FindKNearestPointsWithValue(Handle, Origins[Query], Radius, Tracked, Nearest);
+			const int32 ExpectedNum = FMath::Min(K, InRadiusDistSq.Num());
+			NumKNearestMismatches += NumNearest == ExpectedNum && BatchKCounts[Query] == ExpectedNum ? 0 : 1;
+			for (int32 Index = 0; Index < FMath::Min(NumNearest, ExpectedNum); ++Index)
+			{
+				const int64 DistSq = (Subsystem->WorldLocationToPixel(Nearest[Index], DataLayer) - Origin).SizeSquared();
+				const int64 BatchDistSq = (Subsystem->WorldLocationToPixel(BatchLocations[Query * K + Index], DataLayer) - Origin).SizeSquared();
+				NumKNearestMismatches += DistSq == InRadiusDistSq[Index] && BatchDistSq == DistSq ? 0 : 1;
+			}
+		}
+		Res &= Test->TestEqual("Radius counts should match a brute-force scan", NumCountMismatches, 0);
+		Res &= Test->TestEqual("Radius enumeration should match a brute-force scan", NumEnumerationMismatches, 0);
+		Res &= Test->TestEqual("K-nearest results should match a brute-force scan, nearest first", NumKNearestMismatches, 0);
+
+		return Res;
+	}
+
+	bool TestRemovalReclaimsIndexMemory(EWorldDataLayerStructureType StructureType) const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersSpatialTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = FName("SpatialReclaimLayer");
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(100, 100);
+		LayerAsset->DataFormat = EDataFormat::R8;
+		LayerAsset->SpatialOptimization.bBuildAccelerationStructure = true;
+		LayerAsset->SpatialOptimization.StructureType = StructureType;
+		LayerAsset->SpatialOptimization.ValuesToTrack.Add(FLinearColor(1.0f, 0.0f, 0.0f, 0.0f));
+		Subsystem->RegisterDataLayer(LayerAsset);
+		const UWorldDataLayer* DataLayer = Subsystem->GetDataLayer(LayerAsset->LayerName);
+		const FWorldLayerSpatialIndexStats EmptyStats = DataLayer->GetSpatialIndexStats();
+
+		FRandomStream Random(99);
+		TArray<FIntPoint> Points;
+		for (int32 Index = 0; Index < 1500; ++Index)
+		{
+			Points.AddUnique(FIntPoint(Random.RandRange(0, 99), Random.RandRange(0, 99)));
+		}
+
+		// Fire spreads and burns out: fill, clear, then fill again in the same order
+		auto WriteAll = [&](const FLinearColor& Value)
+		{
+			for (const FIntPoint& Point : Points)
+			{
+				Subsystem->SetValueAtLocation(LayerAsset->LayerName, Subsystem->PixelToWorldLocation(Point, DataLayer), Value);
+			}
+		};
+
+		WriteAll(FLinearColor::Red);
+		const FWorldLayerSpatialIndexStats FilledStats = DataLayer->GetSpatialIndexStats();
+		Res &= Test->TestEqual("Every written cell should be indexed", FilledStats.NumPoints, Points.Num());
+		Res &= Test->TestTrue("Filling should grow the index", FilledStats.NumNodes > EmptyStats.NumNodes);
+
+		WriteAll(FLinearColor::Black);
+		const FWorldLayerSpatialIndexStats ClearedStats = DataLayer->GetSpatialIndexStats();
+		Res &= Test->TestEqual("Clearing should empty the index", ClearedStats.NumPoints, 0);
+		Res &= Test->TestEqual("Clearing should collapse the index back to its empty shape", ClearedStats.NumNodes, EmptyStats.NumNodes);
+		Res &= Test->TestTrue("Freed nodes should be pooled", ClearedStats.NumFreeNodes > 0);
+
+		FVector2D FoundLocation;
+		Res &= Test->TestFalse("A cleared index should find nothing", Subsystem->FindNearestPointWithValue(LayerAsset->LayerName, FVector2D::ZeroVector, 200.0f, FLinearColor(1.0f, 0.0f, 0.0f, 0.0f), FoundLocation));
+
+		WriteAll(FLinearColor::Red);
+		const FWorldLayerSpatialIndexStats RefilledStats = DataLayer->GetSpatialIndexStats();
+		Res &= Test->TestEqual("Refilling should index every cell again", RefilledStats.NumPoints, Points.Num());
+		Res &= Test->TestEqual("Refilling should reach the same shape", RefilledStats.NumNodes, FilledStats.NumNodes);
+		Res &= Test->TestEqual("Refilling should reuse pooled nodes instead of allocating new ones", RefilledStats.NumNodes + RefilledStats.NumFreeNodes, FilledStats.NumNodes + FilledStats.NumFreeNodes);
+
+		return Res;
+	}
+
+	bool TestBulkBuiltIndexTracksDefaultValue(EWorldDataLayerStructureType StructureType) const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersSpatialTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		// Tracking the default value puts every cell into the index built during initialization
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = FName("SpatialBulkBuildLayer");
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(100, 100);
+		LayerAsset->DataFormat = EDataFormat::R8;
+		LayerAsset->DefaultValue = FLinearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		LayerAsset->SpatialOptimization.bBuildAccelerationStructure = true;
+		LayerAsset->SpatialOptimization.StructureType = StructureType;
+		LayerAsset->SpatialOptimization.ValuesToTrack.Add(FLinearColor(0.0f, 0.0f, 0.0f, 0.0f));
+		LayerAsset->SpatialOptimization.ValuesToTrack.Add(FLinearColor(1.0f, 0.0f, 0.0f, 0.0f));
+		Subsystem->RegisterDataLayer(LayerAsset);
+		const UWorldDataLayer* DataLayer = Subsystem->GetDataLayer(LayerAsset->LayerName);
+
+		FVector2D FoundLocation;
+		const FVector2D Corner = Subsystem->PixelToWorldLocation(FIntPoint(99, 0), DataLayer);
+		Res &= Test->TestTrue("Every default cell should be indexed", Subsystem->FindNearestPointWithValue(LayerAsset->LayerName, Corner, 1.0f, FLinearColor(0.0f, 0.0f, 0.0f, 0.0f), FoundLocation));
+		Res &= Test->TestTrue("A cell should be its own nearest match", FoundLocation.Equals(Corner, 0.01f));
+		Res &= Test->TestFalse("No cell holds the second tracked value yet", Subsystem->FindNearestPointWithValue(LayerAsset->LayerName, Corner, 200.0f, FLinearColor(1.0f, 0.0f, 0.0f, 0.0f), FoundLocation));
+
+		// Writes move cells between the bulk-built indices
+		for (int32 Y = 40; Y < 60; ++Y)
+		{
+			for (int32 X = 40; X < 60; ++X)
+			{
+				Subsystem->SetValueAtLocation(LayerAsset->LayerName, Subsystem->PixelToWorldLocation(FIntPoint(X, Y), DataLayer), FLinearColor::Red);
+			}
+		}
+		const FVector2D Center = Subsystem->PixelToWorldLocation(FIntPoint(45, 50), DataLayer);
+		Res &= Test->TestTrue("The nearest default cell should be outside the written block", Subsystem->FindNearestPointWithValue(LayerAsset->LayerName, Center, 20.0f, FLinearColor(0.0f, 0.0f, 0.0f, 0.0f), FoundLocation));
+		Res &= Test->TestTrue("The nearest default cell should be just left of the block", Subsystem->WorldLocationToPixel(FoundLocation, DataLayer) == FIntPoint(39, 50));
+		Res &= Test->TestFalse("Written cells should have left the default index", Subsystem->FindNearestPointWithValue(LayerAsset->LayerName, Center, 5.0f, FLinearColor(0.0f, 0.0f, 0.0f, 0.0f), FoundLocation));
+
+		return Res;
+	}
+
+	bool TestFindNearestPointInRange() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersSpatialTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		FWorldDataLayerTrackedRange HighDanger;
+		HighDanger.RangeName = FName("HighDanger");
+		HighDanger.Min = 0.7f;
+		HighDanger.Max = 65504.0f;
+		HighDanger.bIncludeMax = true;
+
+		FWorldDataLayerTrackedRange Moderate;
+		Moderate.RangeName = FName("Moderate");
+		Moderate.Min = 0.2f;
+		Moderate.Max = 0.375f; // Exact in 16-bit float, so a write of the bound stores the bound
+
+		// Covers the default value, so every untouched cell starts in this range
+		FWorldDataLayerTrackedRange Calm;
+		Calm.RangeName = FName("Calm");
+		Calm.Min = 0.0f;
+		Calm.Max = 0.1f;
+
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = FName("SpatialRangeLayer");
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(100, 100);
+		LayerAsset->DataFormat = EDataFormat::R16F;
+		LayerAsset->DefaultValue = FLinearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		LayerAsset->SpatialOptimization.bBuildAccelerationStructure = true;
+		LayerAsset->SpatialOptimization.RangesToTrack = {HighDanger, Moderate, Calm};
+		Subsystem->RegisterDataLayer(LayerAsset);
+		const UWorldDataLayer* DataLayer = Subsystem->GetDataLayer(LayerAsset->LayerName);
+		const FName LayerName = LayerAsset->LayerName;
+
+		auto SetPixel = [&](const FIntPoint& Pixel, float Value)
+		{
+			Subsystem->SetValueAtLocation(LayerName, Subsystem->PixelToWorldLocation(Pixel, DataLayer), FLinearColor(Value, 0.0f, 0.0f, 0.0f));
+		};
+		auto FindPixel = [&](FName RangeName, const FIntPoint& Origin, float Radius, FIntPoint& OutPixel)
+		{
+			FVector2D Found;
+			const bool bFound = Subsystem->FindNearestPointInRange(LayerName, RangeName, Subsystem->PixelToWorldLocation(Origin, DataLayer), Radius, Found);
+			OutPixel = bFound ? Subsystem->WorldLocationToPixel(Found, DataLayer) : FIntPoint(-1, -1);
+			return bFound;
+		};
+
+		FIntPoint Found;
+		Res &= Test->TestTrue("Default cells should start in the range covering the default", FindPixel(Calm.RangeName, FIntPoint(10, 10), 1.0f, Found) && Found == FIntPoint(10, 10));
+		Res &= Test->TestFalse("No cell is dangerous yet", FindPixel(HighDanger.RangeName, FIntPoint(50, 50), 200.0f, Found));
+
+		SetPixel(FIntPoint(20, 20), 0.9f);
+		SetPixel(FIntPoint(60, 60), 3.5f);
+		SetPixel(FIntPoint(30, 30), 0.3f);
+		SetPixel(FIntPoint(45, 45), 0.375f);
+
+		Res &= Test->TestTrue("Nearest dangerous cell from the center should be the far one", FindPixel(HighDanger.RangeName, FIntPoint(50, 50), 200.0f, Found) && Found == FIntPoint(60, 60));
+		Res &= Test->TestTrue("Values above 1 should be in an open-ended range", FindPixel(HighDanger.RangeName, FIntPoint(65, 65), 10.0f, Found) && Found == FIntPoint(60, 60));
+		Res &= Test->TestTrue("Moderate cells should be found", FindPixel(Moderate.RangeName, FIntPoint(44, 44), 200.0f, Found) && Found == FIntPoint(30, 30));
+		Res &= Test->TestFalse("The upper bound of a half-open range should be excluded", FindPixel(Moderate.RangeName, FIntPoint(45, 45), 5.0f, Found));
+		Res &= Test->TestFalse("Written cells should leave the default range", FindPixel(Calm.RangeName, FIntPoint(20, 20), 1.0f, Found));
+
+		// Cooling a cell moves it from one range to another
+		SetPixel(FIntPoint(60, 60), 0.25f);
+		Res &= Test->TestTrue("A cooled cell should leave the danger range", FindPixel(HighDanger.RangeName, FIntPoint(60, 60), 200.0f, Found) && Found == FIntPoint(20, 20));
+		Res &= Test->TestTrue("A cooled cell should join the moderate range", FindPixel(Moderate.RangeName, FIntPoint(60, 60), 5.0f, Found) && Found == FIntPoint(60, 60));
+		Res &= Test->TestFalse("An unknown range should find nothing", FindPixel(FName("Unknown"), FIntPoint(60, 60), 200.0f, Found));
+
+		return Res;
+	}
+
+	bool TestRectWritesUpdateIndices() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersSpatialTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		FWorldDataLayerTrackedRange High;
+		High.RangeName = FName("High");
+		High.Min = 0.5f;
+		High.Max = 1.0f;
+		High.bIncludeMax = true;
+
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = FName("SpatialRectWriteLayer");
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(100, 100);
+		LayerAsset->DataFormat = EDataFormat::R8;
+		LayerAsset->SpatialOptimization.bBuildAccelerationStructure = true;
+		LayerAsset->SpatialOptimization.ValuesToTrack.Add(FLinearColor(1.0f, 0.0f, 0.0f, 0.0f));
+		LayerAsset->SpatialOptimization.RangesToTrack = {High};
+		Subsystem->RegisterDataLayer(LayerAsset);
+		UWorldDataLayer* DataLayer = const_cast<UWorldDataLayer*>(Subsystem->GetDataLayer(LayerAsset->LayerName));
+		const FName LayerName = LayerAsset->LayerName;
+
+		auto FindPixel = [&](FName RangeName, const FIntPoint& Origin, FIntPoint& OutPixel)
+		{
+			FVector2D Found;
+			const FVector2D WorldOrigin = Subsystem->PixelToWorldLocation(Origin, DataLayer);
+			const bool bFound = RangeName.IsNone()
+				? Subsystem->FindNearestPointWithValue(LayerName, WorldOrigin, 10.0f, FLinearColor(1.0f, 0.0f, 0.0f, 0.0f), Found)
+				: Subsystem->FindNearestPointInRange(LayerName, RangeName, WorldOrigin, 10.0f, Found);
+			OutPixel = bFound ? Subsystem->WorldLocationToPixel(Found, DataLayer) : FIntPoint(-1, -1);
+			return bFound;
+		};
+
+		// A 4x4 block of tracked cells written as one rect
+		TArray<uint8> Cells;
+		Cells.Init(255, 16);
+		DataLayer->WriteEncodedRect(FIntRect(40, 40, 44, 44), Cells.GetData(), 4);
+
+		FIntPoint Found;
+		Res &= Test->TestTrue("Rect writes should add cells to the value index", FindPixel(NAME_None, FIntPoint(38, 41), Found) && Found == FIntPoint(40, 41));
+		Res &= Test->TestTrue("Rect writes should add cells to the range index", FindPixel(High.RangeName, FIntPoint(38, 41), Found) && Found == FIntPoint(40, 41));
+
+		// Clearing the left half moves only those cells out of the indices
+		FMemory::Memzero(Cells.GetData(), Cells.Num());
+		DataLayer->WriteEncodedRect(FIntRect(40, 40, 42, 44), Cells.GetData(), 2);
+		Res &= Test->TestTrue("Overwritten cells should leave the value index", FindPixel(NAME_None, FIntPoint(38, 41), Found) && Found == FIntPoint(42, 41));
+		Res &= Test->TestTrue("Overwritten cells should leave the range index", FindPixel(High.RangeName, FIntPoint(38, 41), Found) && Found == FIntPoint(42, 41));
+
+		return Res;
+	}
+
+	bool TestTrackedValuesMatchAfterQuantization() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersSpatialTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		// Neither value is exactly representable in 8 bits; both must still match their own writes
+		const FLinearColor HalfGray(0.5f, 0.0f, 0.0f, 0.0f);
+		const FLinearColor Mixed(0.3f, 0.6f, 0.2f, 1.0f);
+
+		UWorldDataLayerAsset* R8Asset = NewObject<UWorldDataLayerAsset>();
+		R8Asset->LayerName = FName("SpatialQuantizedR8");
+		R8Asset->ResolutionMode = EResolutionMode::Absolute;
+		R8Asset->Resolution = FIntPoint(100, 100);
+		R8Asset->DataFormat = EDataFormat::R8;
+		R8Asset->SpatialOptimization.bBuildAccelerationStructure = true;
+		R8Asset->SpatialOptimization.ValuesToTrack.Add(HalfGray);
+		Subsystem->RegisterDataLayer(R8Asset);
+
+		UWorldDataLayerAsset* RGBA8Asset = NewObject<UWorldDataLayerAsset>();
+		RGBA8Asset->LayerName = FName("SpatialQuantizedRGBA8");
+		RGBA8Asset->ResolutionMode = EResolutionMode::Absolute;
+		RGBA8Asset->Resolution = FIntPoint(100, 100);
+		RGBA8Asset->DataFormat = EDataFormat::RGBA8;
+		RGBA8Asset->SpatialOptimization.bBuildAccelerationStructure = true;
+		RGBA8Asset->SpatialOptimization.ValuesToTrack.Add(Mixed);
+		Subsystem->RegisterDataLayer(RGBA8Asset);
+
+		const FVector2D Location(10.5f, 10.5f);
+		Subsystem->SetValueAtLocation(R8Asset->LayerName, Location, HalfGray);
+		Subsystem->SetValueAtLocation(RGBA8Asset->LayerName, Location, Mixed);
+
+		FVector2D FoundLocation;
+		Res &= Test->TestTrue("R8 tracked value should match its quantized write", Subsystem->FindNearestPointWithValue(R8Asset->LayerName, Location, 5.0f, HalfGray, FoundLocation));
+		Res &= Test->TestTrue("RGBA8 tracked value should match its quantized write", Subsystem->FindNearestPointWithValue(RGBA8Asset->LayerName, Location, 5.0f, Mixed, FoundLocation));
+
+		// A value that quantizes to different bytes is a different key
+		Res &= Test->TestFalse("A neighbouring 8-bit value should not match", Subsystem->FindNearestPointWithValue(RGBA8Asset->LayerName, Location, 5.0f, FLinearColor(0.3f, 0.6f, 0.21f, 1.0f), FoundLocation));
+
+		// Overwriting the cell removes it from the index
+		Subsystem->SetValueAtLocation(R8Asset->LayerName, Location, FLinearColor(0.0f, 0.0f, 0.0f, 0.0f));
+		Res &= Test->TestFalse("Overwritten cell should leave the index", Subsystem->FindNearestPointWithValue(R8Asset->LayerName, Location, 5.0f, HalfGray, FoundLocation));
+
+		return Res;
+	}
 };
 
 bool FRancWorldLayersSpatialTest::RunTest(const FString& Parameters)
@@ -110,6 +552,17 @@ bool FRancWorldLayersSpatialTest::RunTest(const FString& Parameters)
 	bool bResult = true;
 
 	bResult &= Scenarios.TestFindNearestPointWithValue();
+	bResult &= Scenarios.TestFindNearestMatchesBruteForce(EWorldDataLayerStructureType::Quadtree);
+	bResult &= Scenarios.TestFindNearestMatchesBruteForce(EWorldDataLayerStructureType::OccupancyPyramid);
+	bResult &= Scenarios.TestRadiusAndKNearestMatchBruteForce(EWorldDataLayerStructureType::Quadtree);
+	bResult &= Scenarios.TestRadiusAndKNearestMatchBruteForce(EWorldDataLayerStructureType::OccupancyPyramid);
+	bResult &= Scenarios.TestRemovalReclaimsIndexMemory(EWorldDataLayerStructureType::Quadtree);
+	bResult &= Scenarios.TestRemovalReclaimsIndexMemory(EWorldDataLayerStructureType::OccupancyPyramid);
+	bResult &= Scenarios.TestBulkBuiltIndexTracksDefaultValue(EWorldDataLayerStructureType::Quadtree);
+	bResult &= Scenarios.TestBulkBuiltIndexTracksDefaultValue(EWorldDataLayerStructureType::OccupancyPyramid);
+	bResult &= Scenarios.TestTrackedValuesMatchAfterQuantization();
+	bResult &= Scenarios.TestFindNearestPointInRange();
+	bResult &= Scenarios.TestRectWritesUpdateIndices();
 
 	return bResult;
 }
@@ -0,0 +1,206 @@
+// Copyright Rancorous Games, 2026
+
+#include "RancWorldLayersTestSetup.cpp"
+#include "Framework/DebugTestResult.h"
+#include "WorldDataLayerAsset.h"
+#include "WorldLayerAccessor.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#define TestName_Storage "GameTests.RancWorldLayers.Storage"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancWorldLayersStorageTest, TestName_Storage,
+								 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Context class for setting up the test environment
+class WorldDataLayersStorageTestContext
+{
+public:
+	WorldDataLayersStorageTestContext(FRancWorldLayersStorageTest* InTest)
+		: Test(InTest),
+		  TestFixture(FName(*FString(TestName_Storage)))
+	{
+		Subsystem = TestFixture.GetSubsystem();
+		Test->TestNotNull("Subsystem should not be null", Subsystem);
+	}
+
+	UWorldLayersSubsystem* GetSubsystem() const { return Subsystem; }
+	UWorld* GetWorld() const { return TestFixture.GetWorld(); }
+
+private:
+	FRancWorldLayersStorageTest* Test;
+	FRancWorldLayersTestFixture TestFixture;
+	UWorldLayersSubsystem* Subsystem;
+};
+
+// Class containing individual test scenarios
+class FWorldDataLayersStorageTestScenarios
+{
+public:
+	FRancWorldLayersStorageTest* Test;
+
+	FWorldDataLayersStorageTestScenarios(FRancWorldLayersStorageTest* InTest)
+		: Test(InTest)
+	{
+	}
+
+	static UWorldDataLayerAsset* CreateLayerAsset(FName LayerName, EDataFormat Format, bool bSparse)
+	{
+		UWorldDataLayerAsset* LayerAsset = NewObject<UWorldDataLayerAsset>();
+		LayerAsset->LayerName = LayerName;
+		LayerAsset->ResolutionMode = EResolutionMode::Absolute;
+		LayerAsset->Resolution = FIntPoint(256, 256); // 4x4 tiles of 64x64
+		LayerAsset->DataFormat = Format;
+		LayerAsset->DefaultValue = FLinearColor(0.25f, 0.5f, 0.75f, 1.0f);
+		LayerAsset->bUseSparseStorage = bSparse;
+		return LayerAsset;
+	}
+
+	bool TestSparseLayerOnlyAllocatesWrittenTiles() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersStorageTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		UWorldDataLayerAsset* LayerAsset = CreateLayerAsset(FName("SparseStorage"), EDataFormat::RGBA16F, true);
+		Subsystem->RegisterDataLayer(LayerAsset);
+
+		int32 Allocated = 0;
+		int32 Implicit = 0;
+		Res &= Test->TestTrue("Tile counts should be available", Subsystem->GetLayerTileCounts(LayerAsset->LayerName, Allocated, Implicit));
+		Res &= Test->TestEqual("A fresh sparse layer should not allocate tiles", Allocated, 0);
+		Res &= Test->TestEqual("All 16 tiles should be implicit", Implicit, 16);
+
+		// Reading from an implicit tile returns the default value
+		FLinearColor OutValue;
+		Subsystem->GetValueAtLocation(LayerAsset->LayerName, FVector2D(-4000.0f, 3000.0f), OutValue);
+		Res &= Test->TestTrue("Implicit tiles should read as the default value", OutValue.Equals(LayerAsset->DefaultValue, 0.001f));
+
+		// Writing the default value must not allocate
+		Subsystem->SetValueAtLocation(LayerAsset->LayerName, FVector2D(0.0f, 0.0f), LayerAsset->DefaultValue);
+		Subsystem->GetLayerTileCounts(LayerAsset->LayerName, Allocated, Implicit);
+		Res &= Test->TestEqual("Writing the default value should not allocate a tile", Allocated, 0);
+
+		// Writing a different value allocates exactly one tile
+		const FLinearColor NewValue(1.0f, 0.0f, 0.0f, 1.0f);
+		Subsystem->SetValueAtLocation(LayerAsset->LayerName, FVector2D(0.0f, 0.0f), NewValue);
+		Subsystem->GetLayerTileCounts(LayerAsset->LayerName, Allocated, Implicit);
+		Res &= Test->TestEqual("Writing a new value should allocate one tile", Allocated, 1);
+		Res &= Test->TestEqual("The other tiles should stay implicit", Implicit, 15);
+
+		Subsystem->GetValueAtLocation(LayerAsset->LayerName, FVector2D(0.0f, 0.0f), OutValue);
+		Res &= Test->TestTrue("Written value should be read back", OutValue.Equals(NewValue, 0.001f));
+
+		// Restoring the default value lets compaction release the tile again
+		Subsystem->SetValueAtLocation(LayerAsset->LayerName, FVector2D(0.0f, 0.0f), LayerAsset->DefaultValue);
+		UWorldDataLayer* DataLayer = const_cast<UWorldDataLayer*>(Subsystem->GetDataLayer(LayerAsset->LayerName));
+		Res &= Test->TestEqual("Compaction should release the restored tile", DataLayer->Storage.Compact(), 1);
+		Res &= Test->TestEqual("No tiles should remain allocated", DataLayer->GetNumAllocatedTiles(), 0);
+
+		return Res;
+	}
+
+	bool TestDenseLayerAllocatesAllTiles() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersStorageTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		UWorldDataLayerAsset* LayerAsset = CreateLayerAsset(FName("DenseStorage"), EDataFormat::RGBA8, false);
+		Subsystem->RegisterDataLayer(LayerAsset);
+
+		int32 Allocated = 0;
+		int32 Implicit = 0;
+		Subsystem->GetLayerTileCounts(LayerAsset->LayerName, Allocated, Implicit);
+		Res &= Test->TestEqual("A dense layer should allocate every tile", Allocated, 16);
+		Res &= Test->TestEqual("A dense layer should have no implicit tiles", Implicit, 0);
+
+		FLinearColor OutValue;
+		Subsystem->GetValueAtLocation(LayerAsset->LayerName, FVector2D(4900.0f, 4900.0f), OutValue);
+		Res &= Test->TestEqual("Dense tiles should be filled with the default value", OutValue.B, FMath::RoundToFloat(0.75f * 255.0f) / 255.0f, KINDA_SMALL_NUMBER);
+
+		return Res;
+	}
+
+	bool TestSparsePNGRoundtrip() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersStorageTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		UWorldDataLayerAsset* SourceAsset = CreateLayerAsset(FName("SparsePngSource"), EDataFormat::RGBA8, true);
+		Subsystem->RegisterDataLayer(SourceAsset);
+		Subsystem->SetValueAtLocation(SourceAsset->LayerName, FVector2D(100.0f, 100.0f), FLinearColor::Red);
+
+		const FString TempFilePath = FPaths::ProjectSavedDir() / TEXT("TestOutput") / TEXT("SparseRoundtrip.png");
+		Subsystem->ExportLayerToPNG(SourceAsset, TempFilePath);
+
+		UWorldDataLayerAsset* DestAsset = CreateLayerAsset(FName("SparsePngDest"), EDataFormat::RGBA8, true);
+		Subsystem->RegisterDataLayer(DestAsset);
+		Subsystem->ImportLayerFromPNG(DestAsset, TempFilePath);
+
+		FLinearColor OutValue;
+		Subsystem->GetValueAtLocation(DestAsset->LayerName, FVector2D(100.0f, 100.0f), OutValue);
+		Res &= Test->TestEqual("Imported cell should keep its red channel", OutValue.R, 1.0f, 0.01f);
+
+		IFileManager::Get().Delete(*TempFilePath);
+		return Res;
+	}
+
+	bool TestTypedAccessorMatchesGenericPath() const
+	{
+		FDebugTestResult Res = true;
+		WorldDataLayersStorageTestContext Context(Test);
+		UWorldLayersSubsystem* Subsystem = Context.GetSubsystem();
+
+		const EDataFormat Formats[] = { EDataFormat::R8, EDataFormat::R16F, EDataFormat::RGBA8, EDataFormat::RGBA16F };
+		for (const EDataFormat Format : Formats)
+		{
+			const FName LayerName(*FString::Printf(TEXT("AccessorFormat_%d"), (int32)Format));
+			UWorldDataLayerAsset* LayerAsset = CreateLayerAsset(LayerName, Format, true);
+			Subsystem->RegisterDataLayer(LayerAsset);
+			Subsystem->SetValueAtLocation(LayerName, FVector2D(0.0f, 0.0f), FLinearColor(0.1f, 0.2f, 0.3f, 0.4f));
+			Subsystem->SetValueAtLocation(LayerName, FVector2D(-4990.0f, -4990.0f), FLinearColor(0.9f, 0.8f, 0.7f, 0.6f));
+
+			const UWorldDataLayer* DataLayer = Subsystem->GetDataLayer(LayerName);
+			VisitWorldLayerAccessor(*DataLayer, [&](const auto& Accessor)
+			{
+				const FIntPoint Probes[] = { FIntPoint(0, 0), FIntPoint(128, 128), FIntPoint(63, 64), FIntPoint(255, 255), FIntPoint(-1, 3), FIntPoint(256, 0) };
+				for (const FIntPoint& Probe : Probes)
+				{
+					const FLinearColor Expected = DataLayer->GetValueAtPixel(Probe);
+					const FLinearColor Actual = Accessor.Get(Probe.X, Probe.Y);
+					Res &= Test->TestTrue(FString::Printf(TEXT("Accessor for format %d should match GetValueAtPixel at %s"), (int32)Format, *Probe.ToString()), Actual.Equals(Expected, 0.0f));
+					Res &= Test->TestEqual(TEXT("GetR should match the red channel"), Accessor.GetR(Probe.X, Probe.Y), Expected.R);
+				}
+			});
+		}
+
+		return Res;
+	}
+};
+
+bool FRancWorldLayersStorageTest::RunTest(const FString& Parameters)
+{
+	FWorldDataLayersStorageTestScenarios Scenarios(this);
+
+	bool bResult = true;
+
+	AddInfo("Running Test: SparseLayerOnlyAllocatesWrittenTiles");
+	bResult &= Scenarios.TestSparseLayerOnlyAllocatesWrittenTiles();
+
+	AddInfo("Running Test: DenseLayerAllocatesAllTiles");
+	bResult &= Scenarios.TestDenseLayerAllocatesAllTiles();
+
+	AddInfo("Running Test: SparsePNGRoundtrip");
+	bResult &= Scenarios.TestSparsePNGRoundtrip();
+
+	AddInfo("Running Test: TypedAccessorMatchesGenericPath");
+	bResult &= Scenarios.TestTypedAccessorMatchesGenericPath();
+
+	return bResult;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS